@@ -8,7 +8,15 @@
         'src/odbc_statement.cpp',
         'src/odbc_result.cpp',
         'src/dynodbc.cpp',
-        'src/chunked_buffer.cpp'
+        'src/rowset.cpp',
+        'src/row_batch.cpp',
+        'src/record_shape.cpp',
+        'src/metadata_cache.cpp',
+        'src/statement_cache.cpp',
+        'src/handle_lock.cpp',
+        'src/odbc_pool.cpp',
+        'src/executor.cpp',
+        'src/buffer_pool.cpp'
       ],
       'cflags': ['-Wall', '-Wextra', '-Wno-unused-parameter'],
       'include_dirs': [
@@ -0,0 +1,89 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+var Readable = require('stream').Readable;
+var inherits = require('util').inherits;
+
+//Largest part of a value read per getData call
+var CHUNK_SIZE_MAX = 1048576;
+
+module.exports = ColumnStream;
+
+//Readable stream of the long data column that ends the row last fetched from
+//an ODBCResult. The first part of the value is read with the row, the rest
+//is read with getData as the stream is consumed. The stream must be consumed
+//before the result is fetched from again.
+function ColumnStream(result, column, chunk, more, encoding, fetchCount) {
+  var self = this;
+
+  self.result = result;
+  self.column = column;
+  self.fetchCount = fetchCount;
+  self.chunkSize = Math.min(result.valueChunkSize, CHUNK_SIZE_MAX);
+  self.more = more;
+  self.reading = false;
+
+  Readable.call(self, { highWaterMark: self.chunkSize });
+
+  if (encoding) {
+    self.setEncoding(encoding);
+  }
+
+  if (chunk.length) {
+    self.push(chunk);
+  }
+
+  if (!more) {
+    self.push(null);
+  }
+}
+
+inherits(ColumnStream, Readable);
+
+ColumnStream.prototype._read = function () {
+  var self = this;
+
+  //only one read may be outstanding on the column
+  if (self.reading || !self.more) {
+    return;
+  }
+
+  self.reading = true;
+
+  //reads share the queue of fetch so they never run alongside one
+  self.result.queue.push(function (next) {
+    self.result.getData(self.column, self.fetchCount, self.chunkSize, function (err, data) {
+      self.reading = false;
+      next();
+
+      if (err) {
+        self.more = false;
+        return self.emit('error', err);
+      }
+
+      if (data === null) {
+        self.more = false;
+        return self.push(null);
+      }
+
+      if (self.push(data)) {
+        self._read();
+      }
+    });
+  });
+};
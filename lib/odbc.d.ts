@@ -8,6 +8,23 @@ declare namespace odbc {
     export const SQL_DESTROY: number;
     export const FETCH_ARRAY: number;
     export const FETCH_OBJECT: number;
+    export const FETCH_COLUMNAR: number;
+    export const FETCH_FLAT: number;
+    export const BIGINT_STRING: number;
+    export const BIGINT_NUMBER: number;
+    export const BIGINT_BIGINT: number;
+    export const DECIMAL_STRING: number;
+    export const DECIMAL_NUMBER: number;
+    export const DECIMAL_SCALED: number;
+    export const DATE_STRING: number;
+    export const DATE_UTC: number;
+    export const DATE_LOCAL: number;
+    export const LOB_VALUE: number;
+    export const LOB_STREAM: number;
+    export const THREADING_NONE: number;
+    export const THREADING_CONNECTION: number;
+    export const THREADING_ENVIRONMENT: number;
+    export const THREADING_PROCESS: number;
 
     export let debug: boolean;
 
@@ -16,8 +33,31 @@ declare namespace odbc {
     }
 
     export interface DatabaseOptions {
+        threading?: number;
         connectTimeout?: number;
         loginTimeout?: number;
+        metadataCacheSize?: number;
+        statementCacheSize?: number;
+        statementFreeListSize?: number;
+        asyncExecution?: boolean;
+        rowsetSize?: number;
+        batchSize?: number;
+        maxBatchBytes?: number;
+        bigintMode?: number;
+        decimalMode?: number;
+        dateMode?: number;
+        dateFraction?: boolean;
+        lobMode?: number;
+    }
+
+    export interface PoolOptions extends DatabaseOptions {
+        minSize?: number;
+        maxSize?: number;
+        maxWaiters?: number;
+        acquireTimeout?: number;
+        idleTimeout?: number;
+        warmConcurrency?: number;
+        prepare?: string[];
     }
 
     export interface DescribeOptions {
@@ -63,18 +103,60 @@ declare namespace odbc {
         IS_NULLABLE: string;
     }
 
+    export interface MetadataCacheStats {
+        size: number;
+        capacity: number;
+        hits: number;
+        misses: number;
+    }
+
+    export interface StatementCacheStats {
+        size: number;
+        capacity: number;
+        hits: number;
+        misses: number;
+        evictions: number;
+        freeHandles: number;
+        freeListSize: number;
+        recycled: number;
+    }
+
+    export interface PoolStats {
+        size: number;
+        inUse: number;
+        idle: number;
+        pending: number;
+        waiters: number;
+        minSize: number;
+        maxSize: number;
+        created: number;
+        destroyed: number;
+        acquired: number;
+        timeouts: number;
+        rejected: number;
+        failedResets: number;
+        waitTimeP50: number;
+        waitTimeP90: number;
+        waitTimeP99: number;
+        waitTimeMax: number;
+    }
+
     export interface ODBCConnection {
         connected: boolean;
         connectTimeout: number;
         loginTimeout: number;
+        metadataCacheSize: number;
+        statementCacheSize: number;
+        statementFreeListSize: number;
+        asyncExecution: boolean;
         open(connctionString: string | ConnctionInfo, cb: (err: any, result: any) => void): void;
         openSync(connctionString: string | ConnctionInfo): void;
         close(cb: (err: any) => void): void;
         closeSync(): void;
         createStatement(cb: (err: any, stmt: ODBCStatement) => void): void;
         createStatementSync(): ODBCStatement;
-        query(sql: string, cb: (err: any, rows: ResultRow[], moreResultSets: any) => void): void;
-        query(sql: string, bindingParameters: any[], cb: (err: any, rows: ResultRow[], moreResultSets: any) => void): void;
+        query(sql: string, cb: (err: any, rows: ResultRow[], moreResultSets: any) => void): number;
+        query(sql: string, bindingParameters: any[], cb: (err: any, rows: ResultRow[], moreResultSets: any) => void): number;
         querySync(sql: string, bindingParameters?: any[]): ResultRow[];
         beginTransaction(cb: (err: any) => void): void;
         beginTransactionSync(): void;
@@ -82,6 +164,11 @@ declare namespace odbc {
         endTransactionSync(rollback: boolean): void;
         tables(catalog: string | null, schema: string | null, table: string | null, type: string | null, cb: (err: any, result: ODBCResult) => void): void;
         columns(catalog: string | null, schema: string | null, table: string | null, column: string | null, cb: (err: any, result: ODBCResult) => void): void;
+        getMetadataCacheStatsSync(): MetadataCacheStats;
+        clearMetadataCacheSync(): void;
+        getStatementCacheStatsSync(): StatementCacheStats;
+        clearStatementCacheSync(): void;
+        cancelSync(queryId: number): boolean;
     }
 
     export interface ResultRow {
@@ -90,14 +177,66 @@ declare namespace odbc {
 
     export interface ODBCResult {
         fetchMode: number;
+        rowsetSize: number;
+        batchSize: number;
+        maxBatchBytes: number;
+        bigintMode: number;
+        decimalMode: number;
+        dateMode: number;
+        dateFraction: boolean;
+        lobMode: number;
         fetchAll(cb: (err: any, data: ResultRow[]) => void): void;
         fetchAllSync(): ResultRow[];
+        fetchMany(count: number, cb: (err: any, data: ResultRow[]) => void): void;
+        fetchManySync(count: number): ResultRow[];
+        stream(options?: ResultStreamOptions): NodeJS.ReadableStream;
         fetch(cb: (err: any, data: ResultRow) => void): void;
-        fetchSync(): ResultRow;
+        fetch(options: FetchOptions, cb: (err: any, data: ResultRow) => void): void;
+        fetchSync(options?: FetchOptions): ResultRow;
+        getData(column: number, fetchCount: number, size: number, cb: (err: any, data: Buffer | null) => void): void;
         closeSync(): void;
         moreResultsSync(): any;
         getColumnNamesSync(): string[];
         getColumnMetadataSync(): ODBCColumnMetadata[];
+        cancelSync(): boolean;
+    }
+
+    export interface QuerySignal {
+        aborted: boolean;
+        addEventListener(type: 'abort', listener: () => void): void;
+        removeEventListener(type: 'abort', listener: () => void): void;
+    }
+
+    export interface QueryOptions {
+        sql: string;
+        params?: any[];
+        noResults?: boolean;
+        timeout?: number;
+        signal?: QuerySignal;
+    }
+
+    export interface ResultStreamOptions {
+        batchSize?: number;
+        highWaterMark?: number;
+        fetchMode?: number;
+        maxValueSize?: number;
+        valueChunkSize?: number;
+        maxBatchBytes?: number;
+        bigintMode?: number;
+        decimalMode?: number;
+        dateMode?: number;
+        dateFraction?: boolean;
+    }
+
+    export interface FetchOptions {
+        fetchMode?: number;
+        maxValueSize?: number;
+        valueChunkSize?: number;
+        bigintMode?: number;
+        decimalMode?: number;
+        dateMode?: number;
+        dateFraction?: boolean;
+        lobMode?: number;
     }
 
     export interface ODBCColumnMetadata {
@@ -109,6 +248,15 @@ declare namespace odbc {
 
     export interface ODBCStatement {
         queue: SimpleQueue;
+        rowsetSize: number;
+        bigintMode: number;
+        decimalMode: number;
+        dateMode: number;
+        dateFraction: boolean;
+        lobMode: number;
+        metadataCacheSize: number;
+        asyncExecution: boolean;
+        queryTimeout: number;
         execute(cb: (err: any, result: ODBCResult) => void): void;
         execute(bindingParameters: any[], cb: (err: any, result: ODBCResult) => void): void;
         executeSync(bindingParameters?: any[]): ODBCResult;
@@ -123,6 +271,9 @@ declare namespace odbc {
         bind(bindingParameters: any[], cb: (err: any) => void): void;
         bindSync(bindingParameters: any[]): void;
         closeSync(): void;
+        getMetadataCacheStatsSync(): MetadataCacheStats;
+        clearMetadataCacheSync(): void;
+        cancelSync(): boolean;
     }
 
     export class Database {
@@ -132,6 +283,18 @@ declare namespace odbc {
         connected: boolean;
         connectTimeout: number;
         loginTimeout: number;
+        metadataCacheSize?: number;
+        statementCacheSize?: number;
+        statementFreeListSize?: number;
+        asyncExecution?: boolean;
+        rowsetSize?: number;
+        batchSize?: number;
+        maxBatchBytes?: number;
+        bigintMode?: number;
+        decimalMode?: number;
+        dateMode?: number;
+        dateFraction?: boolean;
+        lobMode?: number;
         SQL_CLOSE: number;
         SQL_DROP: number;
         SQL_UNBIND: number;
@@ -139,15 +302,34 @@ declare namespace odbc {
         SQL_DESTROY: number;
         FETCH_ARRAY: number;
         FETCH_OBJECT: number;
+        FETCH_COLUMNAR: number;
+        FETCH_FLAT: number;
+        BIGINT_STRING: number;
+        BIGINT_NUMBER: number;
+        BIGINT_BIGINT: number;
+        DECIMAL_STRING: number;
+        DECIMAL_NUMBER: number;
+        DECIMAL_SCALED: number;
+        DATE_STRING: number;
+        DATE_UTC: number;
+        DATE_LOCAL: number;
+        LOB_VALUE: number;
+        LOB_STREAM: number;
+        THREADING_NONE: number;
+        THREADING_CONNECTION: number;
+        THREADING_ENVIRONMENT: number;
+        THREADING_PROCESS: number;
         open(connctionString: string | ConnctionInfo, cb: (err: any, result: any) => void): void;
         openSync(connctionString: string | ConnctionInfo): void;
         close(cb: (err: any) => void): void;
         closeSync(): void;
         query(sql: string, cb: (err: any, rows: ResultRow[], moreResultSets: any) => void): void;
         query(sql: string, bindingParameters: any[], cb: (err: any, rows: ResultRow[], moreResultSets: any) => void): void;
+        query(options: QueryOptions, cb: (err: any, rows: ResultRow[], moreResultSets: any) => void): void;
         querySync(sql: string, bindingParameters?: any[]): ResultRow[];
         queryResult(sql: string, cb: (err: any, result: ODBCResult) => void): void;
         queryResult(sql: string, bindingParameters: any[], cb: (err: any, result: ODBCResult) => void): void;
+        queryResult(options: QueryOptions, cb: (err: any, result: ODBCResult) => void): void;
         queryResultSync(sql: string, bindingParameters?: any[]): ODBCResult;
         prepare(sql: string, cb: (err: any, statement: ODBCStatement) => void): void;
         prepareSync(sql: string): ODBCStatement;
@@ -162,14 +344,59 @@ declare namespace odbc {
         tables(catalog: string | null, schema: string | null, table: string | null, type: string | null, cb: (err: any, result: ODBCTable[]) => void): void;
         columns(catalog: string | null, schema: string | null, table: string | null, column: string | null, cb: (err: any, result: ODBCColumn[]) => void): void;
         describe(options: DescribeOptions, cb: (err: any, result: (ODBCTable & ODBCColumn)[]) => void): void;
+        getMetadataCacheStatsSync(): MetadataCacheStats;
+        clearMetadataCacheSync(): Database;
+        getStatementCacheStatsSync(): StatementCacheStats;
+        clearStatementCacheSync(): Database;
     }
 
     export class Pool {
-        constructor(options?: DatabaseOptions);
-        open(connctionString: string, cb: (err: any, db: Database) => void): void;
+        constructor(options?: PoolOptions);
+        open(connctionString: string | ConnctionInfo, cb: (err: any, db: Database) => void): void;
+        warm(connctionString: string | ConnctionInfo, count: number, cb: (err: any) => void): void;
+        getStatsSync(connctionString: string): PoolStats | null;
         close(cb: (err: any) => void): void;
     }
 
+    export class PooledDatabase {
+        constructor(options?: PoolOptions);
+        connected: boolean;
+        open(connctionString: string | ConnctionInfo, cb: (err: any) => void): void;
+        close(cb?: (err: any) => void): void;
+        query(sql: string, cb: (err: any, rows: ResultRow[], moreResultSets: any) => void): void;
+        query(sql: string, bindingParameters: any[], cb: (err: any, rows: ResultRow[], moreResultSets: any) => void): void;
+        query(options: QueryOptions, cb: (err: any, rows: ResultRow[], moreResultSets: any) => void): void;
+        queryResult(sql: string, cb: (err: any, result: ODBCResult) => void): void;
+        queryResult(sql: string, bindingParameters: any[], cb: (err: any, result: ODBCResult) => void): void;
+        queryResult(options: QueryOptions, cb: (err: any, result: ODBCResult) => void): void;
+        prepare(sql: string, cb: (err: any, statement: ODBCStatement) => void): void;
+        beginTransaction(cb: (err: any) => void): PooledDatabase;
+        endTransaction(rollback: boolean, cb: (err: any) => void): PooledDatabase;
+        commitTransaction(cb: (err: any) => void): PooledDatabase;
+        rollbackTransaction(cb: (err: any) => void): PooledDatabase;
+        tables(catalog: string | null, schema: string | null, table: string | null, type: string | null, cb: (err: any, result: ODBCTable[]) => void): void;
+        columns(catalog: string | null, schema: string | null, table: string | null, column: string | null, cb: (err: any, result: ODBCColumn[]) => void): void;
+        describe(options: DescribeOptions, cb: (err: any, result: (ODBCTable & ODBCColumn)[]) => void): void;
+        getStatsSync(): PoolStats | null;
+    }
+
+    export interface ExecutorOptions {
+        threads?: number;
+        affinity?: boolean;
+    }
+
+    export interface ExecutorStats {
+        threads: number;
+        affinity: boolean;
+        pending: number;
+        submitted: number;
+        completed: number;
+        wakeups: number;
+    }
+
+    export function configureExecutor(options: ExecutorOptions): void;
+    export function getExecutorStatsSync(): ExecutorStats;
+
     export function open(connctionString: string | ConnctionInfo, cb: (err: any, result: any) => void): void;
 }
 
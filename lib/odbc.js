@@ -24,8 +24,15 @@ var odbc = require('bindings')({
 });
 
 var SimpleQueue = require('./simple-queue');
+var QueryCancel = require('./query-cancel');
+var ResultStream = require('./result-stream');
+var ColumnStream = require('./column-stream');
 var util = require('./util.js');
 
+//Options applied from a Database to the results and statements it creates
+var resultOptions = ['fetchMode', 'includeMetadata', 'maxValueSize', 'valueChunkSize', 'rowsetSize', 'batchSize', 'maxBatchBytes', 'bigintMode', 'decimalMode', 'dateMode', 'dateFraction', 'lobMode'];
+var statementOptions = ['rowsetSize', 'bigintMode', 'decimalMode', 'dateMode', 'dateFraction', 'lobMode', 'metadataCacheSize', 'asyncExecution'];
+
 module.exports = function (options) {
   return new Database(options);
 }
@@ -38,6 +45,8 @@ module.exports.ODBCConnection = odbc.ODBCConnection;
 module.exports.ODBCStatement = odbc.ODBCStatement;
 module.exports.ODBCResult = odbc.ODBCResult;
 module.exports.loadODBCLibrary = odbc.loadODBCLibrary;
+module.exports.configureExecutor = odbc.configureExecutor;
+module.exports.getExecutorStatsSync = odbc.getExecutorStatsSync;
 
 module.exports.open = function (connectionString, options, cb) {
   var db;
@@ -71,7 +80,8 @@ function Database(options) {
     }
   }
 
-  self.odbc = (options.odbc) ? options.odbc : new odbc.ODBC();
+  //the threading level only applies to an environment created here
+  self.odbc = (options.odbc) ? options.odbc : new odbc.ODBC(options.threading);
   self.odbc.domain = process.domain;
   self.queue = new SimpleQueue();
 
@@ -82,8 +92,20 @@ function Database(options) {
   self.loginTimeout = (options.hasOwnProperty('loginTimeout'))
     ? options.loginTimeout
     : null;
-
-  util.applyPropertiesIfSet(self, options, ['fetchMode', 'includeMetadata', 'maxValueSize', 'valueChunkSize']);
+  self.metadataCacheSize = (options.hasOwnProperty('metadataCacheSize'))
+    ? options.metadataCacheSize
+    : undefined;
+  self.statementCacheSize = (options.hasOwnProperty('statementCacheSize'))
+    ? options.statementCacheSize
+    : undefined;
+  self.statementFreeListSize = (options.hasOwnProperty('statementFreeListSize'))
+    ? options.statementFreeListSize
+    : undefined;
+  self.asyncExecution = (options.hasOwnProperty('asyncExecution'))
+    ? options.asyncExecution
+    : undefined;
+
+  util.applyPropertiesIfSet(self, options, resultOptions);
 }
 
 //Expose constants
@@ -123,6 +145,22 @@ Database.prototype.open = function (connectionString, cb) {
       self.conn.loginTimeout = self.loginTimeout;
     }
 
+    if (self.metadataCacheSize || self.metadataCacheSize === 0) {
+      self.conn.metadataCacheSize = self.metadataCacheSize;
+    }
+
+    if (self.statementCacheSize || self.statementCacheSize === 0) {
+      self.conn.statementCacheSize = self.statementCacheSize;
+    }
+
+    if (self.statementFreeListSize || self.statementFreeListSize === 0) {
+      self.conn.statementFreeListSize = self.statementFreeListSize;
+    }
+
+    if (typeof self.asyncExecution === 'boolean') {
+      self.conn.asyncExecution = self.asyncExecution;
+    }
+
     self.conn.open(connectionString, function (err, result) {
       if (err) return cb(err);
 
@@ -146,6 +184,22 @@ Database.prototype.openSync = function (connectionString) {
     self.conn.loginTimeout = self.loginTimeout;
   }
 
+  if (self.metadataCacheSize || self.metadataCacheSize === 0) {
+    self.conn.metadataCacheSize = self.metadataCacheSize;
+  }
+
+  if (self.statementCacheSize || self.statementCacheSize === 0) {
+    self.conn.statementCacheSize = self.statementCacheSize;
+  }
+
+  if (self.statementFreeListSize || self.statementFreeListSize === 0) {
+    self.conn.statementFreeListSize = self.statementFreeListSize;
+  }
+
+  if (typeof self.asyncExecution === 'boolean') {
+    self.conn.asyncExecution = self.asyncExecution;
+  }
+
   if (typeof (connectionString) === 'object') {
     var obj = connectionString;
     connectionString = '';
@@ -208,64 +262,105 @@ Database.prototype.query = function (sql, params, cb) {
   }
 
   self.queue.push(function (next) {
+    if (QueryCancel.isAborted(sql)) {
+      cb(QueryCancel.abortedError(), [], false);
+      return next();
+    }
+
+    var cancel = (typeof sql === 'object' && (sql.signal || sql.timeout))
+      ? new QueryCancel(self.conn, sql)
+      : null;
+
     function cbQuery(initialErr, result) {
-      util.applyPropertiesIfSet(result, self, ['fetchMode', 'includeMetadata', 'maxValueSize', 'valueChunkSize']);
+      util.applyPropertiesIfSet(result, self, resultOptions);
 
       if (typeof sql === 'object') {
-        util.applyPropertiesIfSet(result, sql, ['fetchMode', 'includeMetadata', 'maxValueSize', 'valueChunkSize']);
+        util.applyPropertiesIfSet(result, sql, resultOptions);
+      }
+
+      if (cancel) {
+        cancel.setResult(result);
       }
 
       fetchMore();
 
       function fetchMore() {
-        result.fetchAll(function (err, data) {
-          var moreResults, moreResultsError = null;
+        //rows are not fetched for a query cancelled before they are read
+        if (cancel && cancel.code) {
+          return fetched(QueryCancel.abortedError(), []);
+        }
+
+        result.fetchAll(fetched);
+      }
 
+      function fetched(err, data) {
+        var moreResults, moreResultsError = null;
+
+        if (cancel) {
+          err = cancel.error(err);
+          initialErr = cancel.error(initialErr);
+        }
+
+        try {
+          moreResults = result.moreResultsSync();
+        }
+        catch (e) {
+          moreResultsError = e;
+          //force to check for more results
+          moreResults = true;
+        }
+
+        //a cancelled query has no more results to wait for
+        if (cancel && cancel.code) {
+          moreResults = false;
+          moreResultsError = null;
+        }
+
+        //close the result before calling back
+        //if there are not more result sets
+        if (!moreResults) {
+          result.closeSync();
+        }
+
+        cb(err || initialErr, data, moreResults);
+        initialErr = null;
+
+        while (moreResultsError) {
           try {
             moreResults = result.moreResultsSync();
-          }
-          catch (e) {
+            cb(moreResultsError, [], moreResults); // No errors left - still need to report the
+            // last one, though
+            moreResultsError = null;
+          } catch (e) {
+            cb(moreResultsError, [], moreResults);
             moreResultsError = e;
-            //force to check for more results
-            moreResults = true;
-          }
-
-          //close the result before calling back
-          //if there are not more result sets
-          if (!moreResults) {
-            result.closeSync();
           }
+        }
 
-          cb(err || initialErr, data, moreResults);
-          initialErr = null;
-
-          while (moreResultsError) {
-            try {
-              moreResults = result.moreResultsSync();
-              cb(moreResultsError, [], moreResults); // No errors left - still need to report the
-              // last one, though
-              moreResultsError = null;
-            } catch (e) {
-              cb(moreResultsError, [], moreResults);
-              moreResultsError = e;
-            }
+        if (moreResults) {
+          return fetchMore();
+        }
+        else {
+          if (cancel) {
+            cancel.stop();
           }
 
-          if (moreResults) {
-            return fetchMore();
-          }
-          else {
-            return next();
-          }
-        });
+          return next();
+        }
       }
     }
 
+    var queryId;
+
     if (params) {
-      self.conn.query(sql, params, cbQuery);
+      queryId = self.conn.query(sql, params, cbQuery);
     }
     else {
-      self.conn.query(sql, cbQuery);
+      queryId = self.conn.query(sql, cbQuery);
+    }
+
+    if (cancel) {
+      cancel.setQuery(queryId);
     }
   });
 };
@@ -283,15 +378,36 @@ Database.prototype.queryResult = function (sql, params, cb) {
   }
 
   self.queue.push(function (next) {
+    if (QueryCancel.isAborted(sql)) {
+      cb(QueryCancel.abortedError(), null);
+      return next();
+    }
+
+    //the result is the caller's to cancel once it has been returned
+    var cancel = (typeof sql === 'object' && (sql.signal || sql.timeout))
+      ? new QueryCancel(self.conn, sql)
+      : null;
+
+    var queryId;
+
     //ODBCConnection.query() is the fastest-path querying mechanism.
     if (params) {
-      self.conn.query(sql, params, cbQuery);
+      queryId = self.conn.query(sql, params, cbQuery);
     }
     else {
-      self.conn.query(sql, cbQuery);
+      queryId = self.conn.query(sql, cbQuery);
+    }
+
+    if (cancel) {
+      cancel.setQuery(queryId);
     }
 
     function cbQuery(err, result) {
+      if (cancel) {
+        cancel.stop();
+        err = cancel.error(err);
+      }
+
       if (err) {
         result.closeSync();
         cb(err, null);
@@ -299,10 +415,10 @@ Database.prototype.queryResult = function (sql, params, cb) {
         return next();
       }
 
-      util.applyPropertiesIfSet(result, self, ['fetchMode', 'includeMetadata', 'maxValueSize', 'valueChunkSize']);
+      util.applyPropertiesIfSet(result, self, resultOptions);
 
       if (typeof sql === 'object') {
-        util.applyPropertiesIfSet(result, sql, ['fetchMode', 'includeMetadata', 'maxValueSize', 'valueChunkSize']);
+        util.applyPropertiesIfSet(result, sql, resultOptions);
       }
 
       cb(err, result);
@@ -326,10 +442,10 @@ Database.prototype.queryResultSync = function (sql, params) {
     result = self.conn.querySync(sql);
   }
 
-  util.applyPropertiesIfSet(result, self, ['fetchMode', 'includeMetadata', 'maxValueSize', 'valueChunkSize']);
+  util.applyPropertiesIfSet(result, self, resultOptions);
 
   if (typeof sql === 'object') {
-    util.applyPropertiesIfSet(result, sql, ['fetchMode', 'includeMetadata', 'maxValueSize', 'valueChunkSize']);
+    util.applyPropertiesIfSet(result, sql, resultOptions);
   }
 
   return result;
@@ -349,10 +465,10 @@ Database.prototype.querySync = function (sql, params) {
     result = self.conn.querySync(sql);
   }
 
-  util.applyPropertiesIfSet(result, self, ['fetchMode', 'includeMetadata', 'maxValueSize', 'valueChunkSize']);
+  util.applyPropertiesIfSet(result, self, resultOptions);
 
   if (typeof sql === 'object') {
-    util.applyPropertiesIfSet(result, sql, ['fetchMode', 'includeMetadata', 'maxValueSize', 'valueChunkSize']);
+    util.applyPropertiesIfSet(result, sql, resultOptions);
   }
 
   var data = result.fetchAllSync();
@@ -426,6 +542,34 @@ Database.prototype.rollbackTransactionSync = function () {
   return self;
 };
 
+Database.prototype.getMetadataCacheStatsSync = function () {
+  var self = this;
+
+  return self.conn.getMetadataCacheStatsSync();
+};
+
+Database.prototype.clearMetadataCacheSync = function () {
+  var self = this;
+
+  self.conn.clearMetadataCacheSync();
+
+  return self;
+};
+
+Database.prototype.getStatementCacheStatsSync = function () {
+  var self = this;
+
+  return self.conn.getStatementCacheStatsSync();
+};
+
+Database.prototype.clearStatementCacheSync = function () {
+  var self = this;
+
+  self.conn.clearStatementCacheSync();
+
+  return self;
+};
+
 Database.prototype.columns = function (catalog, schema, table, column, callback) {
   var self = this;
   if (!self.queue) self.queue = [];
@@ -434,7 +578,11 @@ Database.prototype.columns = function (catalog, schema, table, column, callback)
 
   self.queue.push(function (next) {
     self.conn.columns(catalog, schema, table, column, function (err, result) {
-      if (err) return callback(err, [], false);
+      if (err) {
+        callback(err, [], false);
+
+        return next();
+      }
 
       result.fetchAll(function (err, data) {
         result.closeSync();
@@ -455,7 +603,11 @@ Database.prototype.tables = function (catalog, schema, table, type, callback) {
 
   self.queue.push(function (next) {
     self.conn.tables(catalog, schema, table, type, function (err, result) {
-      if (err) return callback(err, [], false);
+      if (err) {
+        callback(err, [], false);
+
+        return next();
+      }
 
       result.fetchAll(function (err, data) {
         result.closeSync();
@@ -522,6 +674,8 @@ Database.prototype.prepare = function (sql, cb) {
 
     stmt.queue = new SimpleQueue();
 
+    util.applyPropertiesIfSet(stmt, self, statementOptions);
+
     stmt.prepare(sql, function (err) {
       if (err) return cb(err);
 
@@ -537,6 +691,8 @@ Database.prototype.prepareSync = function (sql, cb) {
 
   stmt.queue = new SimpleQueue();
 
+  util.applyPropertiesIfSet(stmt, self, statementOptions);
+
   stmt.prepareSync(sql);
 
   return stmt;
@@ -683,149 +839,492 @@ odbc.ODBCStatement.prototype.bind = function (ary, cb) {
 //proxy the ODBCResult fetch function so that it is queued
 odbc.ODBCResult.prototype._fetch = odbc.ODBCResult.prototype.fetch;
 
-odbc.ODBCResult.prototype.fetch = function (cb) {
+odbc.ODBCResult.prototype.fetch = function (options, cb) {
   var self = this;
 
+  if (typeof options === 'function') {
+    cb = options;
+    options = null;
+  }
+
   self.queue = self.queue || new SimpleQueue();
 
   self.queue.push(function (next) {
-    self._fetch(function (err, data) {
+    function done(err, data) {
       if (cb) cb(err, data);
 
       return next();
-    });
+    }
+
+    if (options) {
+      self._fetch(options, done);
+    }
+    else {
+      self._fetch(done);
+    }
   });
 };
 
+odbc.ODBCResult.prototype._createColumnStream = function (column, chunk, more, encoding, fetchCount) {
+  this.queue = this.queue || new SimpleQueue();
+
+  return new ColumnStream(this, column, chunk, more, encoding, fetchCount);
+};
+
+odbc.ODBCResult.prototype.stream = function (options) {
+  var fetchMode = (options && options.fetchMode) || this.fetchMode;
+
+  //columnar and flat fetches do not return one element per row
+  if (fetchMode === odbc.ODBC.FETCH_COLUMNAR || fetchMode === odbc.ODBC.FETCH_FLAT) {
+    throw new TypeError('ODBCResult.stream(): fetchMode must be FETCH_OBJECT or FETCH_ARRAY.');
+  }
+
+  return new ResultStream(this, options);
+};
+
+if (typeof Symbol === 'function' && Symbol.asyncIterator) {
+  odbc.ODBCResult.prototype[Symbol.asyncIterator] = function () {
+    return this.stream()[Symbol.asyncIterator]();
+  };
+}
+
 module.exports.Pool = Pool;
+module.exports.PooledDatabase = PooledDatabase;
 
 Pool.count = 0;
 
+//Options applied from a Pool to its native pools
+var poolOptions = ['minSize', 'maxSize', 'maxWaiters', 'acquireTimeout', 'idleTimeout', 'connectTimeout', 'loginTimeout', 'warmConcurrency', 'prepare'];
+//Options applied from a Database to pooled connections
+var connectionOptions = ['metadataCacheSize', 'statementCacheSize', 'statementFreeListSize', 'asyncExecution'];
+
 function Pool(options) {
   var self = this;
   self.index = Pool.count++;
-  self.availablePool = {};
-  self.usedPool = {};
-  self.odbc = new odbc.ODBC();
+  //native pools by connection string
+  self.pools = {};
   self.options = options || {}
+  self.odbc = new odbc.ODBC(self.options.threading);
   self.options.odbc = self.odbc;
 }
 
-Pool.prototype.open = function (connectionString, callback) {
+Pool.prototype.getPool = function (connectionString) {
   var self = this
-    , db;
+    , pool = self.pools[connectionString];
 
-  //check to see if we already have a connection for this connection string
-  if (self.availablePool[connectionString] && self.availablePool[connectionString].length) {
-    db = self.availablePool[connectionString].shift()
-    self.usedPool[connectionString].push(db)
+  if (!pool) {
+    pool = self.pools[connectionString] = self.odbc.createPoolSync(connectionString);
+    util.applyPropertiesIfSet(pool, self.options, poolOptions);
 
-    callback(null, db);
+    //connect the minimum in the background instead of on first use
+    if (self.options.minSize) {
+      pool.warm(self.options.minSize, function (err) {
+        exports.debug && console.log('odbc.js : pool[%s] : pool.warm callback()', self.index, err);
+      });
+    }
   }
-  else {
-    db = new Database(self.options);
-    db.realClose = db.close;
-
-    db.close = function (cb) {
-      //call back early, we can do the rest of this stuff after the client thinks
-      //that the connection is closed.
-      cb(null);
-
-
-      //close the connection for real
-      //this will kill any temp tables or anything that might be a security issue.
-      db.realClose(function () {
-        //remove this db from the usedPool
-        self.usedPool[connectionString].splice(self.usedPool[connectionString].indexOf(db), 1);
-
-        //re-open the connection using the connection string
-        db.open(connectionString, function (error) {
-          if (error) {
-            console.error(error);
-            return;
-          }
 
-          //add this clean connection to the connection pool
-          self.availablePool[connectionString] = self.availablePool[connectionString] || [];
-          self.availablePool[connectionString].push(db);
-          exports.debug && console.dir(self);
-        });
-      });
-    };
+  return pool;
+};
 
-    db.open(connectionString, function (error) {
-      exports.debug && console.log('odbc.js : pool[%s] : pool.db.open callback()', self.index);
+function toConnectionString(connectionString) {
+  if (typeof (connectionString) === 'object') {
+    var obj = connectionString;
+    connectionString = '';
 
-      self.usedPool[connectionString] = self.usedPool[connectionString] || [];
-      self.usedPool[connectionString].push(db);
+    Object.keys(obj).forEach(function (key) {
+      connectionString += key + '=' + obj[key] + ';';
+    });
+  }
+
+  return connectionString;
+}
+
+Pool.prototype.open = function (connectionString, callback) {
+  var self = this;
+
+  connectionString = toConnectionString(connectionString);
+
+  try {
+    //closing the database returns the connection to the pool
+    self.getPool(connectionString).acquire(function (err, conn) {
+      exports.debug && console.log('odbc.js : pool[%s] : pool.acquire callback()', self.index);
+
+      if (err) return callback(err);
+
+      var db = new Database(self.options);
 
-      callback(error, db);
+      db.conn = conn;
+      db.conn.domain = process.domain;
+      db.connected = true;
+
+      util.applyPropertiesIfSet(db.conn, db, connectionOptions);
+
+      callback(null, db);
+    });
+  }
+  catch (err) {
+    process.nextTick(function () {
+      callback(err);
     });
   }
 };
 
+//Connects until there are count connections to connectionString, all at
+//once. The callback is called when they are ready to be handed out.
+Pool.prototype.warm = function (connectionString, count, callback) {
+  var self = this;
+
+  connectionString = toConnectionString(connectionString);
+
+  try {
+    self.getPool(connectionString).warm(count, function (err) {
+      exports.debug && console.log('odbc.js : pool[%s] : pool.warm callback()', self.index);
+
+      callback(err || null);
+    });
+  }
+  catch (err) {
+    process.nextTick(function () {
+      callback(err);
+    });
+  }
+};
+
+Pool.prototype.getStatsSync = function (connectionString) {
+  var self = this
+    , pool = self.pools[connectionString];
+
+  return pool ? pool.getStatsSync() : null;
+};
+
+//Disconnects idle connections. Connections in use are disconnected when
+//they are closed.
 Pool.prototype.close = function (callback) {
   var self = this
-    , required = 0
-    , received = 0
-    , connections
-    , key
-    , x;
+    , keys = Object.keys(self.pools)
+    , received = 0;
 
   exports.debug && console.log('odbc.js : pool[%s] : pool.close()', self.index);
-  //we set a timeout because a previous db.close() may
-  //have caused the a behind the scenes db.open() to prepare
-  //a new connection
-  setTimeout(function () {
-    //merge the available pool and the usedPool
-    var pools = {};
-
-    for (key in self.availablePool) {
-      pools[key] = (pools[key] || []).concat(self.availablePool[key]);
-    }
 
-    for (key in self.usedPool) {
-      pools[key] = (pools[key] || []).concat(self.usedPool[key]);
-    }
+  if (keys.length === 0) {
+    return process.nextTick(callback);
+  }
+
+  keys.forEach(function (key) {
+    self.pools[key].close(function () {
+      if (++received === keys.length) {
+        return callback();
+      }
+    });
+  });
 
-    exports.debug && console.log('odbc.js : pool[%s] : pool.close() - setTimeout() callback', self.index);
-    exports.debug && console.dir(pools);
+  self.pools = {};
+};
+
+//A Database that runs each operation on any idle connection from a Pool
+//instead of queueing everything on one connection. Operations between
+//beginTransaction() and the end of the transaction all run on the
+//connection the transaction began on. Results from queryResult() and
+//statements from prepare() keep their connection until they are closed.
+function PooledDatabase(options) {
+  var self = this;
 
-    if (Object.keys(pools).length === 0) {
-      return callback();
+  self.options = options || {};
+  self.pool = new Pool(self.options);
+  self.connectionString = null;
+  self.connected = false;
+  //{ db, waiting } while a transaction is pinned to a connection
+  self.transaction = null;
+}
+
+//Expose constants
+Object.keys(odbc.ODBC).forEach(function (key) {
+  if (typeof odbc.ODBC[key] !== 'function') {
+    PooledDatabase.prototype[key] = odbc.ODBC[key];
+  }
+});
+
+PooledDatabase.prototype.open = function (connectionString, cb) {
+  var self = this;
+
+  self.connectionString = toConnectionString(connectionString);
+
+  //the first connection checks the connection string
+  self.pool.open(self.connectionString, function (err, db) {
+    if (err) return cb(err);
+
+    self.connected = true;
+    db.close();
+
+    return cb(null);
+  });
+};
+
+PooledDatabase.prototype.close = function (cb) {
+  var self = this;
+
+  self.connected = false;
+
+  //an unfinished transaction is rolled back when its connection returns
+  if (self.transaction && self.transaction.db) {
+    self.transaction.db.close();
+  }
+
+  self.transaction = null;
+  self.pool.close(cb || function () {});
+};
+
+//Calls back with the connection of the current transaction, or any idle
+//connection from the pool
+PooledDatabase.prototype.acquire = function (cb) {
+  var self = this;
+
+  if (self.transaction) {
+    if (self.transaction.db) {
+      return cb(null, self.transaction.db);
     }
 
-    for (key in pools) {
-      connections = pools[key];
-      required += connections.length;
+    return self.transaction.waiting.push(cb);
+  }
 
-      exports.debug && console.log('odbc.js : pool[%s] : pool.close() - processing pools %s - connections: %s', self.index, key, connections.length);
+  self.pool.open(self.connectionString, cb);
+};
 
-      for (x = 0; x < connections.length; x++) {
-        (function (x) {
-          //call the realClose method to avoid
-          //automatically re-opening the connection
-          exports.debug && console.log('odbc.js : pool[%s] : pool.close() - calling realClose() for connection #%s', self.index, x);
+//Returns a connection to the pool once the operations queued on it are done
+PooledDatabase.prototype.release = function (db) {
+  var self = this;
 
-          connections[x].realClose(function () {
-            exports.debug && console.log('odbc.js : pool[%s] : pool.close() - realClose() callback for connection #%s', self.index, x);
-            received += 1;
+  if (self.transaction && self.transaction.db === db) {
+    return;
+  }
 
-            if (received === required) {
-              callback();
+  db.close();
+};
 
-              //prevent mem leaks
-              self = null;
-              connections = null;
-              required = null;
-              received = null;
-              key = null;
+//Releases the connection of a result or statement when it is closed
+PooledDatabase.prototype.releaseOnClose = function (obj, db) {
+  var self = this
+    , closeSync = obj.closeSync;
+
+  obj.closeSync = function () {
+    obj.closeSync = closeSync;
+
+    var result = closeSync.apply(obj, arguments);
+
+    self.release(db);
+
+    return result;
+  };
+};
+
+PooledDatabase.prototype.query = function (sql, params, cb) {
+  var self = this;
+
+  if (typeof (params) === 'function') {
+    cb = params;
+    params = null;
+  }
+
+  if (!self.connected) {
+    return cb({ message: 'Connection not open.' }, [], false);
+  }
+
+  self.acquire(function (err, db) {
+    if (err) return cb(err, [], false);
+
+    db.query(sql, params, cb);
+    self.release(db);
+  });
+};
+
+PooledDatabase.prototype.queryResult = function (sql, params, cb) {
+  var self = this;
+
+  if (typeof (params) === 'function') {
+    cb = params;
+    params = null;
+  }
+
+  if (!self.connected) {
+    return cb({ message: 'Connection not open.' }, null);
+  }
+
+  self.acquire(function (err, db) {
+    if (err) return cb(err, null);
+
+    db.queryResult(sql, params, function (err, result) {
+      if (err) {
+        self.release(db);
+
+        return cb(err, null);
+      }
+
+      self.releaseOnClose(result, db);
+
+      cb(null, result);
+    });
+  });
+};
+
+PooledDatabase.prototype.prepare = function (sql, cb) {
+  var self = this;
+
+  if (!self.connected) {
+    return cb({ message: 'Connection not open.' });
+  }
+
+  self.acquire(function (err, db) {
+    if (err) return cb(err);
+
+    db.prepare(sql, function (err, stmt) {
+      if (err) {
+        self.release(db);
 
-              return;
-            }
-          });
-        })(x);
+        return cb(err);
       }
+
+      self.releaseOnClose(stmt, db);
+
+      cb(null, stmt);
+    });
+  });
+};
+
+PooledDatabase.prototype.columns = function (catalog, schema, table, column, callback) {
+  var self = this;
+
+  callback = callback || arguments[arguments.length - 1];
+
+  self.acquire(function (err, db) {
+    if (err) return callback(err, [], false);
+
+    db.columns(catalog, schema, table, column, callback);
+    self.release(db);
+  });
+};
+
+PooledDatabase.prototype.tables = function (catalog, schema, table, type, callback) {
+  var self = this;
+
+  callback = callback || arguments[arguments.length - 1];
+
+  self.acquire(function (err, db) {
+    if (err) return callback(err, [], false);
+
+    db.tables(catalog, schema, table, type, callback);
+    self.release(db);
+  });
+};
+
+PooledDatabase.prototype.describe = Database.prototype.describe;
+
+PooledDatabase.prototype.beginTransaction = function (cb) {
+  var self = this;
+
+  if (!self.connected) {
+    process.nextTick(function () {
+      cb({ message: 'Connection not open.' });
+    });
+
+    return self;
+  }
+
+  //already pinned
+  if (self.transaction) {
+    self.acquire(function (err, db) {
+      if (err) return cb(err);
+
+      db.beginTransaction(cb);
+    });
+
+    return self;
+  }
+
+  var transaction = self.transaction = { db: null, waiting: [] };
+
+  //operations issued until the transaction has begun wait for it
+  function finish(err) {
+    var waiting = transaction.waiting;
+
+    transaction.waiting = [];
+
+    cb(err || null);
+
+    waiting.forEach(function (fn) {
+      if (err) return fn(err);
+
+      self.acquire(fn);
+    });
+  }
+
+  self.pool.open(self.connectionString, function (err, db) {
+    if (err) {
+      self.transaction = null;
+
+      return finish(err);
     }
-  }, 2000);
+
+    db.beginTransaction(function (err) {
+      if (err) {
+        self.transaction = null;
+        db.close();
+
+        return finish(err);
+      }
+
+      transaction.db = db;
+
+      finish(null);
+    });
+  });
+
+  return self;
+};
+
+PooledDatabase.prototype.endTransaction = function (rollback, cb) {
+  var self = this
+    , transaction = self.transaction;
+
+  if (!transaction) {
+    process.nextTick(function () {
+      cb({ message: 'No transaction in progress.' });
+    });
+
+    return self;
+  }
+
+  self.acquire(function (err, db) {
+    if (err) return cb(err);
+
+    //after the operations already queued in the transaction
+    db.queue.push(function (next) {
+      db.conn.endTransaction(rollback, function (err) {
+        if (!err && self.transaction === transaction) {
+          self.transaction = null;
+          db.close();
+        }
+
+        cb(err);
+
+        return next();
+      });
+    });
+  });
+
+  return self;
+};
+
+PooledDatabase.prototype.commitTransaction = function (cb) {
+  return this.endTransaction(false, cb); //don't rollback
+};
+
+PooledDatabase.prototype.rollbackTransaction = function (cb) {
+  return this.endTransaction(true, cb); //rollback
+};
+
+PooledDatabase.prototype.getStatsSync = function () {
+  var self = this;
+
+  return self.pool.getStatsSync(self.connectionString);
 };
@@ -0,0 +1,118 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+module.exports = QueryCancel;
+
+//Cancels the query running on a connection, and the result it is fetching,
+//when options.signal is aborted or options.timeout seconds have passed. The
+//timeout is also set on the statement by the driver, this only backs it up.
+function QueryCancel(conn, options) {
+  var self = this;
+
+  self.conn = conn;
+  self.queryId = null;
+  self.result = null;
+  self.code = null;
+  self.signal = options.signal || null;
+  self.timer = null;
+
+  self.onAbort = function () {
+    self.cancel('ECANCELED');
+  };
+
+  if (self.signal) {
+    self.signal.addEventListener('abort', self.onAbort);
+  }
+
+  if (options.timeout > 0) {
+    self.timer = setTimeout(function () {
+      self.cancel('ETIMEDOUT');
+    }, options.timeout * 1000);
+  }
+}
+
+//Whether the query should not be started at all
+QueryCancel.isAborted = function (options) {
+  return typeof options === 'object' && !!options.signal && !!options.signal.aborted;
+};
+
+QueryCancel.abortedError = function () {
+  return { message: 'Query was cancelled.', code: 'ECANCELED' };
+};
+
+//Only the query with the id conn.query returned is cancelled, not the
+//others running on the connection
+QueryCancel.prototype.setQuery = function (queryId) {
+  var self = this;
+
+  self.queryId = queryId;
+};
+
+//The result is cancelled along with the query while it is fetching
+QueryCancel.prototype.setResult = function (result) {
+  var self = this;
+
+  self.result = result;
+};
+
+QueryCancel.prototype.cancel = function (code) {
+  var self = this;
+
+  if (self.code) {
+    return;
+  }
+
+  self.code = code;
+
+  if (self.queryId) {
+    self.conn.cancelSync(self.queryId);
+  }
+
+  if (self.result) {
+    self.result.cancelSync();
+  }
+};
+
+//Reports errors after a cancel with the code of what cancelled them, and
+//cancellations or timeouts reported by the driver with their reason
+QueryCancel.prototype.error = function (err) {
+  var self = this;
+
+  if (err && self.code) {
+    err.code = self.code;
+  }
+  else if (err && err.reason) {
+    err.code = err.reason;
+  }
+
+  return err;
+};
+
+QueryCancel.prototype.stop = function () {
+  var self = this;
+
+  if (self.timer) {
+    clearTimeout(self.timer);
+    self.timer = null;
+  }
+
+  if (self.signal) {
+    self.signal.removeEventListener('abort', self.onAbort);
+    self.signal = null;
+  }
+};
@@ -0,0 +1,84 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+var Readable = require('stream').Readable;
+var inherits = require('util').inherits;
+var util = require('./util.js');
+
+//Options passed through to fetchMany. fetchMode is checked by
+//ODBCResult.stream, since only modes that return rows can be streamed.
+var streamFetchOptions = ['fetchMode', 'maxValueSize', 'valueChunkSize', 'maxBatchBytes', 'bigintMode', 'decimalMode', 'dateMode', 'dateFraction'];
+
+module.exports = ResultStream;
+
+//Readable stream of the rows of an ODBCResult. Rows are fetched batchSize at
+//a time with fetchMany, and no more rows are fetched while the buffered rows
+//are at or above highWaterMark.
+function ResultStream(result, options) {
+  var self = this;
+
+  options = options || {};
+
+  self.result = result;
+  self.batchSize = options.batchSize || result.batchSize;
+  self.fetchOptions = { batchSize: self.batchSize };
+  self.fetching = false;
+
+  util.applyPropertiesIfSet(self.fetchOptions, options, streamFetchOptions);
+
+  Readable.call(self, {
+    objectMode: true,
+    highWaterMark: options.highWaterMark || self.batchSize
+  });
+}
+
+inherits(ResultStream, Readable);
+
+ResultStream.prototype._read = function () {
+  var self = this;
+
+  //only one fetch may be outstanding on the result
+  if (self.fetching) {
+    return;
+  }
+
+  self.fetching = true;
+
+  self.result.fetchMany(self.batchSize, self.fetchOptions, function (err, rows) {
+    self.fetching = false;
+
+    if (err) {
+      //destroy lets pipe and the async iterator clean up
+      if (typeof self.destroy === 'function') {
+        return self.destroy(err);
+      }
+
+      return self.emit('error', err);
+    }
+
+    for (var i = 0; i < rows.length; i++) {
+      self.push(rows[i]);
+    }
+
+    //fetchMany returns fewer rows than requested at the end of the result set.
+    //Otherwise Readable calls _read again while it is below highWaterMark.
+    if (rows.length < self.batchSize) {
+      self.push(null);
+    }
+  });
+};
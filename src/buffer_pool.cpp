@@ -0,0 +1,152 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "odbc.h"
+#include "buffer_pool.h"
+
+uv_mutex_t BufferPool::g_poolMutex;
+uint8_t** BufferPool::g_freeBuffers[BUFFER_POOL_CLASS_COUNT];
+size_t BufferPool::g_freeCount[BUFFER_POOL_CLASS_COUNT];
+
+void BufferPool::Init() {
+  static bool initialized = false;
+
+  if (initialized) {
+    return;
+  }
+
+  uv_mutex_init(&BufferPool::g_poolMutex);
+
+  for (int i = 0; i < BUFFER_POOL_CLASS_COUNT; i++) {
+    size_t capacity = BUFFER_POOL_CLASS_BYTES / ((size_t) BUFFER_POOL_MIN_SIZE << i);
+
+    g_freeBuffers[i] = (uint8_t**) malloc(capacity * sizeof(uint8_t*));
+    g_freeCount[i] = 0;
+  }
+
+  initialized = true;
+}
+
+/*
+ * GetBufferSize
+ *
+ * Sizes the scratch buffer to hold the largest value reported by the
+ * columns in a single SQLGetData call, with room for a wide terminator.
+ * Long data and columns of unknown length get the largest buffer and are
+ * read in chunks of that size.
+ */
+
+size_t BufferPool::GetBufferSize(Column* columns, short colCount) {
+  size_t size = BUFFER_POOL_MIN_SIZE;
+
+  for (short i = 0; i < colCount; i++) {
+    SQLLEN octetLength = columns[i].octetLength;
+    SQLLEN length = columns[i].length;
+
+    if (octetLength <= 0 || octetLength > LONG_DATA_THRESHOLD) {
+      return BUFFER_POOL_MAX_SIZE;
+    }
+
+    // Character data may be converted to SQL_C_WCHAR
+    size_t columnSize = (size_t) octetLength;
+    if (length > 0 && (size_t) length * sizeof(uint16_t) > columnSize) {
+      columnSize = (size_t) length * sizeof(uint16_t);
+    }
+    columnSize += sizeof(uint16_t);
+
+    if (columnSize > size) {
+      size = columnSize;
+    }
+  }
+
+  return size < BUFFER_POOL_MAX_SIZE ? size : BUFFER_POOL_MAX_SIZE;
+}
+
+/*
+ * GetSizeClass
+ */
+
+int BufferPool::GetSizeClass(size_t size) {
+  int sizeClass = 0;
+
+  while (sizeClass < BUFFER_POOL_CLASS_COUNT - 1 && ((size_t) BUFFER_POOL_MIN_SIZE << sizeClass) < size) {
+    sizeClass++;
+  }
+
+  return sizeClass;
+}
+
+/*
+ * Acquire
+ */
+
+uint8_t* BufferPool::Acquire(size_t size, size_t* bufferSize) {
+  int sizeClass = BufferPool::GetSizeClass(size);
+  uint8_t* buffer = NULL;
+
+  uv_mutex_lock(&BufferPool::g_poolMutex);
+
+  if (g_freeCount[sizeClass] > 0) {
+    buffer = g_freeBuffers[sizeClass][--g_freeCount[sizeClass]];
+  }
+
+  uv_mutex_unlock(&BufferPool::g_poolMutex);
+
+  *bufferSize = (size_t) BUFFER_POOL_MIN_SIZE << sizeClass;
+
+  if (!buffer) {
+    buffer = (uint8_t*) malloc(*bufferSize);
+
+    if (!buffer) {
+      *bufferSize = 0;
+    }
+  }
+
+  DEBUG_PRINTF("BufferPool::Acquire - size=%zu bufferSize=%zu\n", size, *bufferSize);
+
+  return buffer;
+}
+
+/*
+ * Release
+ *
+ * Returns the buffer to its size class, or frees it if the class is full.
+ */
+
+void BufferPool::Release(uint8_t* buffer, size_t bufferSize) {
+  if (!buffer) {
+    return;
+  }
+
+  int sizeClass = BufferPool::GetSizeClass(bufferSize);
+  size_t capacity = BUFFER_POOL_CLASS_BYTES / ((size_t) BUFFER_POOL_MIN_SIZE << sizeClass);
+  bool pooled = false;
+
+  uv_mutex_lock(&BufferPool::g_poolMutex);
+
+  if (g_freeBuffers[sizeClass] && g_freeCount[sizeClass] < capacity) {
+    g_freeBuffers[sizeClass][g_freeCount[sizeClass]++] = buffer;
+    pooled = true;
+  }
+
+  uv_mutex_unlock(&BufferPool::g_poolMutex);
+
+  if (!pooled) {
+    free(buffer);
+  }
+}
@@ -0,0 +1,56 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SRC_BUFFER_POOL_H
+#define _SRC_BUFFER_POOL_H
+
+#include "odbc.h"
+
+// Smallest and largest buffers handed out by the pool. Requests are rounded
+// up to the next power of two within this range.
+#define BUFFER_POOL_MIN_SIZE 4096
+#define BUFFER_POOL_MAX_SIZE FIXED_BUFFER_SIZE
+#define BUFFER_POOL_CLASS_COUNT 9
+
+// Upper bound on the bytes kept idle in each size class
+#define BUFFER_POOL_CLASS_BYTES 1048576
+
+// Process-wide pool of scratch buffers used for SQLGetData. Released buffers
+// are kept per size class for reuse up to BUFFER_POOL_CLASS_BYTES and freed
+// beyond that. Acquire and Release are safe to call from the thread pool.
+class BufferPool {
+public:
+  static void Init();
+
+  // Returns the buffer size that Acquire would return for the columns
+  static size_t GetBufferSize(Column* columns, short colCount);
+
+  // Returns a buffer of at least size bytes, and its actual size in
+  // *bufferSize, or NULL if the allocation failed
+  static uint8_t* Acquire(size_t size, size_t* bufferSize);
+  static void Release(uint8_t* buffer, size_t bufferSize);
+
+private:
+  static int GetSizeClass(size_t size);
+
+  static uv_mutex_t g_poolMutex;
+  static uint8_t** g_freeBuffers[BUFFER_POOL_CLASS_COUNT];
+  static size_t g_freeCount[BUFFER_POOL_CLASS_COUNT];
+};
+
+#endif
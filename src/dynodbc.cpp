@@ -97,6 +97,7 @@ pfnSQLFreeHandle        pSQLFreeHandle;
 pfnSQLFetchScroll       pSQLFetchScroll;
 pfnSQLColAttribute      pSQLColAttribute;
 pfnSQLSetConnectAttr    pSQLSetConnectAttr;
+pfnSQLGetConnectAttr    pSQLGetConnectAttr;
 pfnSQLDriverConnect     pSQLDriverConnect;
 pfnSQLAllocHandle       pSQLAllocHandle;
 pfnSQLRowCount          pSQLRowCount;
@@ -170,7 +171,7 @@ BOOL DynLoadODBC( char* odbcModuleName )
   //Unused-> if (LOAD_ENTRY( hMod, SQLBindCol        )  )
   //Unused-> if (LOAD_ENTRY( hMod, SQLCancel         )  )
   //Unused-> if (LOAD_ENTRY( hMod, SQLConnect       )  )
-  //Unused-> if (LOAD_ENTRY( hMod, SQLDescribeCol    )  )
+  if (LOAD_ENTRY( hMod, SQLDescribeCol    )  )
   if (LOAD_ENTRY( hMod, SQLDisconnect     )  )
   if (LOAD_ENTRY( hMod, SQLExecDirect     )  )
   if (LOAD_ENTRY( hMod, SQLExecute        )  )
@@ -181,6 +182,7 @@ BOOL DynLoadODBC( char* odbcModuleName )
   //Unused-> if (LOAD_ENTRY( hMod, SQLFetchScroll    )  )
   if (LOAD_ENTRY( hMod, SQLColAttribute   )  )
   if (LOAD_ENTRY( hMod, SQLSetConnectAttr )  )
+  if (LOAD_ENTRY( hMod, SQLGetConnectAttr )  )
   if (LOAD_ENTRY( hMod, SQLDriverConnect  )  )
   if (LOAD_ENTRY( hMod, SQLAllocHandle    )  )
   if (LOAD_ENTRY( hMod, SQLRowCount       )  )
@@ -83,6 +83,11 @@ typedef RETCODE (SQL_API * pfnSQLSetConnectAttr)(
   SQLINTEGER Attribute, SQLPOINTER Value,
   SQLINTEGER StringLength);
 
+typedef RETCODE (SQL_API * pfnSQLGetConnectAttr)(
+  SQLHDBC ConnectionHandle,
+  SQLINTEGER Attribute, SQLPOINTER Value,
+  SQLINTEGER BufferLength, SQLINTEGER *StringLength);
+
 typedef RETCODE (SQL_API * pfnSQLDriverConnect)(    
   SQLHDBC            hdbc,
   SQLHWND            hwnd,
@@ -336,6 +341,7 @@ extern pfnSQLFetchScroll        pSQLFetchScroll;
 extern pfnSQLFetchScroll        pSQLFetchScroll;
 extern pfnSQLColAttribute       pSQLColAttribute; 
 extern pfnSQLSetConnectAttr     pSQLSetConnectAttr;
+extern pfnSQLGetConnectAttr     pSQLGetConnectAttr;
 extern pfnSQLDriverConnect      pSQLDriverConnect;
 extern pfnSQLAllocHandle        pSQLAllocHandle;
 extern pfnSQLRowCount           pSQLRowCount;
@@ -389,7 +395,9 @@ BOOL DynLoadODBC( char* odbcModuleName );
 #define SQLDisconnect pSQLDisconnect
 #define SQLRowCount pSQLRowCount
 #define SQLNumResultCols pSQLNumResultCols
+#define SQLDescribeCol pSQLDescribeCol
 #define SQLSetConnectAttr pSQLSetConnectAttr
+#define SQLGetConnectAttr pSQLGetConnectAttr
 #define SQLEndTran pSQLEndTran
 #define SQLExecDirect pSQLExecDirect
 #define SQLTables pSQLTables
@@ -0,0 +1,394 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "odbc.h"
+#include "executor.h"
+
+size_t Executor::g_threadCount = EXECUTOR_THREADS_DEFAULT;
+bool Executor::g_affinity = false;
+ExecutorWorker* Executor::g_workers = NULL;
+uv_async_t* Executor::g_async = NULL;
+ExecutorQueue Executor::g_completions;
+
+size_t Executor::g_pending = 0;
+size_t Executor::g_submitted = 0;
+size_t Executor::g_completed = 0;
+size_t Executor::g_wakeups = 0;
+
+/*
+ * ExecutorQueue
+ *
+ * Dmitry Vyukov's intrusive MPSC queue. Producers swap themselves in at the
+ * head and then link the previous head to themselves. The consumer walks
+ * from the tail, with a stub node standing in when the queue is empty.
+ */
+
+ExecutorQueue::ExecutorQueue() {
+  this->_stub.next = NULL;
+  this->_head = &this->_stub;
+  this->_tail = &this->_stub;
+}
+
+void ExecutorQueue::push(ExecutorTask* task) {
+  task->next.store(NULL, std::memory_order_relaxed);
+
+  ExecutorTask* prev = this->_head.exchange(task, std::memory_order_acq_rel);
+
+  prev->next.store(task, std::memory_order_release);
+}
+
+ExecutorTask* ExecutorQueue::pop() {
+  ExecutorTask* tail = this->_tail;
+  ExecutorTask* next = tail->next.load(std::memory_order_acquire);
+
+  if (tail == &this->_stub) {
+    if (!next) {
+      return NULL;
+    }
+
+    this->_tail = next;
+    tail = next;
+    next = next->next.load(std::memory_order_acquire);
+  }
+
+  if (next) {
+    this->_tail = next;
+    return tail;
+  }
+
+  //a producer has swapped in a new head but not linked it yet
+  if (tail != this->_head.load(std::memory_order_acquire)) {
+    return NULL;
+  }
+
+  this->push(&this->_stub);
+
+  next = tail->next.load(std::memory_order_acquire);
+
+  if (next) {
+    this->_tail = next;
+    return tail;
+  }
+
+  return NULL;
+}
+
+/*
+ * QueueWork
+ */
+
+int Executor::QueueWork(uv_loop_t* loop, uv_work_t* req, uv_work_cb work, uv_after_work_cb after, HandleLock* affinity) {
+  if (!g_threadCount || !Start(loop)) {
+    return uv_queue_work(loop, req, work, after);
+  }
+
+  ExecutorTask* task = new ExecutorTask();
+  task->req = req;
+  task->work = work;
+  task->poll = NULL;
+  task->after = after;
+
+  Submit(task, affinity);
+
+  return 0;
+}
+
+int Executor::QueuePoll(uv_loop_t* loop, uv_work_t* req, executor_poll_cb poll, uv_after_work_cb after, HandleLock* affinity) {
+  ExecutorTask* task = new ExecutorTask();
+  task->req = req;
+  task->work = NULL;
+  task->poll = poll;
+  task->after = after;
+
+  if (!g_threadCount || !Start(loop)) {
+    //poll on a thread pool thread until done
+    task->fallback.data = task;
+
+    return uv_queue_work(loop, &task->fallback, UV_Poll, UV_AfterPoll);
+  }
+
+  Submit(task, affinity);
+
+  return 0;
+}
+
+void Executor::Submit(ExecutorTask* task, HandleLock* affinity) {
+  task->worker = PickWorker(affinity);
+
+  //the loop stays alive while work is out
+  if (g_pending++ == 0) {
+    uv_ref((uv_handle_t *) g_async);
+  }
+
+  g_submitted++;
+
+  task->worker->pending++;
+  task->worker->queue.push(task);
+
+  uv_sem_post(&task->worker->sem);
+}
+
+bool Executor::Start(uv_loop_t* loop) {
+  if (g_workers) {
+    return true;
+  }
+
+  DEBUG_PRINTF("Executor::Start %i threads\n", (int) g_threadCount);
+
+  g_async = (uv_async_t *) calloc(1, sizeof(uv_async_t));
+  uv_async_init(loop, g_async, AsyncCallback);
+  uv_unref((uv_handle_t *) g_async);
+
+  g_workers = new ExecutorWorker[g_threadCount];
+
+  size_t started = 0;
+
+  for (size_t i = 0; i < g_threadCount; i++) {
+    ExecutorWorker* worker = &g_workers[started];
+
+    worker->pending = 0;
+    uv_sem_init(&worker->sem, 0);
+
+    if (uv_thread_create(&worker->thread, WorkerThread, worker) != 0) {
+      uv_sem_destroy(&worker->sem);
+      break;
+    }
+
+    started++;
+  }
+
+  //run with the threads we got, or fall back to the thread pool
+  g_threadCount = started;
+
+  return started > 0;
+}
+
+/*
+ * PickWorker
+ *
+ * With affinity, connections are spread over the workers by the address of
+ * their lock. Otherwise the worker with the least work queued is picked, the
+ * first one on a tie.
+ */
+
+ExecutorWorker* Executor::PickWorker(HandleLock* affinity) {
+  if (g_affinity && affinity) {
+    uintptr_t key = (uintptr_t) affinity;
+
+    //locks are heap allocated, so the low bits carry little
+    return &g_workers[(key >> 4) % g_threadCount];
+  }
+
+  ExecutorWorker* worker = &g_workers[0];
+  size_t pending = worker->pending;
+
+  for (size_t i = 1; i < g_threadCount && pending; i++) {
+    size_t workerPending = g_workers[i].pending;
+
+    if (workerPending < pending) {
+      worker = &g_workers[i];
+      pending = workerPending;
+    }
+  }
+
+  return worker;
+}
+
+void Executor::Complete(ExecutorTask* task) {
+  task->worker->pending--;
+
+  g_completions.push(task);
+  uv_async_send(g_async);
+}
+
+/*
+ * WorkerThread
+ *
+ * Runs new work as it arrives. Polled work that is not done is kept aside
+ * and polled again whenever no new work is waiting, sleeping a little
+ * longer each time a round makes no progress.
+ */
+
+void Executor::WorkerThread(void* arg) {
+  ExecutorWorker* worker = (ExecutorWorker *) arg;
+  std::vector<ExecutorTask*> polling;
+  unsigned int sleep = EXECUTOR_POLL_MIN_SLEEP;
+
+  for (;;) {
+    if (polling.empty()) {
+      uv_sem_wait(&worker->sem);
+    }
+    else if (uv_sem_trywait(&worker->sem) != 0) {
+      size_t count = polling.size();
+
+      for (size_t i = 0; i < polling.size();) {
+        if (polling[i]->poll(polling[i]->req)) {
+          Complete(polling[i]);
+
+          polling[i] = polling.back();
+          polling.pop_back();
+        }
+        else {
+          i++;
+        }
+      }
+
+      if (polling.size() < count) {
+        sleep = EXECUTOR_POLL_MIN_SLEEP;
+      }
+      else {
+        std::this_thread::sleep_for(std::chrono::microseconds(sleep));
+
+        sleep = std::min(sleep * 2, (unsigned int) EXECUTOR_POLL_MAX_SLEEP);
+      }
+
+      continue;
+    }
+
+    ExecutorTask* task;
+
+    //the push this post was for may not be linked yet
+    while (!(task = worker->queue.pop())) {
+      std::this_thread::yield();
+    }
+
+    if (task->poll) {
+      if (!task->poll(task->req)) {
+        polling.push_back(task);
+        continue;
+      }
+    }
+    else {
+      task->work(task->req);
+    }
+
+    Complete(task);
+  }
+}
+
+void Executor::UV_Poll(uv_work_t* req) {
+  ExecutorTask* task = (ExecutorTask *) req->data;
+  unsigned int sleep = EXECUTOR_POLL_MIN_SLEEP;
+
+  while (!task->poll(task->req)) {
+    std::this_thread::sleep_for(std::chrono::microseconds(sleep));
+
+    sleep = std::min(sleep * 2, (unsigned int) EXECUTOR_POLL_MAX_SLEEP);
+  }
+}
+
+void Executor::UV_AfterPoll(uv_work_t* req, int status) {
+  ExecutorTask* task = (ExecutorTask *) req->data;
+
+  task->after(task->req, status);
+
+  delete task;
+}
+
+/*
+ * AsyncCallback
+ *
+ * Runs the after callbacks of everything that finished since the last
+ * wakeup. A push that is not linked yet is picked up on the wakeup its
+ * producer sends after linking it.
+ */
+
+void Executor::AsyncCallback(uv_async_t* handle) {
+  g_wakeups++;
+
+  ExecutorTask* task;
+
+  while ((task = g_completions.pop())) {
+    g_pending--;
+    g_completed++;
+
+    //may queue more work
+    task->after(task->req, 0);
+
+    delete task;
+  }
+
+  if (!g_pending) {
+    uv_unref((uv_handle_t *) g_async);
+  }
+}
+
+/*
+ * Configure
+ *
+ * Takes { threads, affinity }. The thread count can only change before the
+ * first work is queued.
+ */
+
+NAN_METHOD(Executor::Configure) {
+  DEBUG_PRINTF("Executor::Configure\n");
+  Nan::HandleScope scope;
+
+  REQ_OBJ_ARG(0, options);
+
+  Local<Value> threads = options->Get(Nan::New("threads").ToLocalChecked());
+  Local<Value> affinity = options->Get(Nan::New("affinity").ToLocalChecked());
+
+  if (threads->IsNumber()) {
+    size_t threadCount = threads->Uint32Value();
+
+    if (threadCount > EXECUTOR_THREADS_MAX) {
+      threadCount = EXECUTOR_THREADS_MAX;
+    }
+
+    if (g_workers && threadCount != g_threadCount) {
+      return Nan::ThrowError("Executor threads cannot be changed once work has been queued");
+    }
+
+    if (!g_workers) {
+      g_threadCount = threadCount;
+    }
+  }
+
+  if (affinity->IsBoolean()) {
+    g_affinity = affinity->BooleanValue();
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+/*
+ * GetStatsSync
+ */
+
+NAN_METHOD(Executor::GetStatsSync) {
+  DEBUG_PRINTF("Executor::GetStatsSync\n");
+  Nan::HandleScope scope;
+
+  Local<Object> stats = Nan::New<Object>();
+
+  stats->Set(Nan::New("threads").ToLocalChecked(), Nan::New<Number>(g_threadCount));
+  stats->Set(Nan::New("affinity").ToLocalChecked(), Nan::New<Boolean>(g_affinity));
+  stats->Set(Nan::New("pending").ToLocalChecked(), Nan::New<Number>(g_pending));
+  stats->Set(Nan::New("submitted").ToLocalChecked(), Nan::New<Number>(g_submitted));
+  stats->Set(Nan::New("completed").ToLocalChecked(), Nan::New<Number>(g_completed));
+  stats->Set(Nan::New("wakeups").ToLocalChecked(), Nan::New<Number>(g_wakeups));
+
+  info.GetReturnValue().Set(stats);
+}
@@ -0,0 +1,127 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SRC_EXECUTOR_H
+#define _SRC_EXECUTOR_H
+
+#include <atomic>
+
+#include "odbc.h"
+#include "handle_lock.h"
+
+// Number of executor threads, 0 to run work on the libuv thread pool
+#define EXECUTOR_THREADS_DEFAULT 4
+#define EXECUTOR_THREADS_MAX 128
+// Bounds in microseconds of the sleep between polls that made no progress
+#define EXECUTOR_POLL_MIN_SLEEP 100
+#define EXECUTOR_POLL_MAX_SLEEP 2000
+
+// Called until it returns true
+typedef bool (*executor_poll_cb)(uv_work_t* req);
+
+struct ExecutorWorker;
+
+// Work submitted to the executor, queued on a worker and then on the
+// completion queue
+struct ExecutorTask {
+  std::atomic<ExecutorTask*> next;
+  uv_work_t* req;
+  uv_work_cb work;
+  executor_poll_cb poll;
+  uv_after_work_cb after;
+  ExecutorWorker* worker;
+  // Runs polled work on the libuv thread pool when there are no threads
+  uv_work_t fallback;
+};
+
+// Lock-free queue with any number of producers and a single consumer. The
+// queue is intrusive, so pushing never allocates. pop() may return NULL
+// while a push is halfway done, so the consumer must be told about every
+// push some other way and retry.
+class ExecutorQueue {
+public:
+  ExecutorQueue();
+
+  void push(ExecutorTask* task);
+  ExecutorTask* pop();
+
+private:
+  std::atomic<ExecutorTask*> _head;
+  ExecutorTask* _tail;
+  ExecutorTask _stub;
+};
+
+struct ExecutorWorker {
+  uv_thread_t thread;
+  ExecutorQueue queue;
+  // Posted once per task pushed
+  uv_sem_t sem;
+  // Tasks queued or running, read to pick the least busy worker
+  std::atomic<size_t> pending;
+};
+
+// Threads dedicated to blocking ODBC calls. Long queries then never take
+// the libuv thread pool away from fs, dns and crypto work.
+//
+// Work is submitted from the event loop to the queue of one worker: the
+// least busy one, or with affinity the one picked by the lock of the
+// connection, so all calls on a connection run on the same thread.
+// Finished work is pushed to a single completion queue, and the event loop
+// is woken with one uv_async_t, so a burst of completions costs one wakeup.
+//
+// Polled work, such as an ODBC call executing asynchronously, is called
+// again until it is done. A worker keeps the work it is polling aside and
+// goes around all of it between new work, so a few threads can keep many
+// statements executing at once.
+//
+// Threads are started on first use. With no threads, work goes to
+// uv_queue_work as before.
+class Executor {
+public:
+  // Same contract as uv_queue_work. affinity is the lock of the connection
+  // the work runs on, or NULL.
+  static int QueueWork(uv_loop_t* loop, uv_work_t* req, uv_work_cb work, uv_after_work_cb after, HandleLock* affinity);
+  static int QueuePoll(uv_loop_t* loop, uv_work_t* req, executor_poll_cb poll, uv_after_work_cb after, HandleLock* affinity);
+
+  static NAN_METHOD(Configure);
+  static NAN_METHOD(GetStatsSync);
+
+private:
+  static bool Start(uv_loop_t* loop);
+  static void Submit(ExecutorTask* task, HandleLock* affinity);
+  static ExecutorWorker* PickWorker(HandleLock* affinity);
+  static void Complete(ExecutorTask* task);
+  static void WorkerThread(void* arg);
+  static void UV_Poll(uv_work_t* req);
+  static void UV_AfterPoll(uv_work_t* req, int status);
+  static void AsyncCallback(uv_async_t* handle);
+
+  static size_t g_threadCount;
+  static bool g_affinity;
+  static ExecutorWorker* g_workers;
+  static uv_async_t* g_async;
+  static ExecutorQueue g_completions;
+
+  // Event loop only
+  static size_t g_pending;
+  static size_t g_submitted;
+  static size_t g_completed;
+  static size_t g_wakeups;
+};
+
+#endif
@@ -0,0 +1,104 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "odbc.h"
+#include "handle_lock.h"
+
+HandleLock::HandleLock(int threading, HandleLock* parent) : _threading(threading), _refCount(0) {
+  uv_mutex_init(&this->_mutex);
+
+  this->_parent = parent;
+
+  if (parent) {
+    parent->ref();
+  }
+}
+
+HandleLock::~HandleLock() {
+  uv_mutex_destroy(&this->_mutex);
+
+  if (this->_parent) {
+    this->_parent->unref();
+  }
+}
+
+void HandleLock::ref() {
+  this->_refCount++;
+}
+
+void HandleLock::unref() {
+  if (--this->_refCount <= 0) {
+    delete this;
+  }
+}
+
+int HandleLock::threading() {
+  return this->_threading;
+}
+
+HandleLock* HandleLock::parent() {
+  return this->_parent ? this->_parent : this;
+}
+
+/*
+ * levelMutex
+ *
+ * Returns the mutex for the threading level, or NULL if nothing is locked.
+ * An environment lock is its own parent.
+ */
+
+uv_mutex_t* HandleLock::levelMutex() {
+  switch (this->_threading) {
+    case THREADING_NONE:
+      return NULL;
+    case THREADING_ENVIRONMENT:
+      return this->_parent ? &this->_parent->_mutex : &this->_mutex;
+    case THREADING_PROCESS:
+      return &ODBC::g_odbcMutex;
+    default:
+      return &this->_mutex;
+  }
+}
+
+void HandleLock::lock() {
+  uv_mutex_t* mutex = this->levelMutex();
+
+  if (mutex) {
+    uv_mutex_lock(mutex);
+  }
+}
+
+void HandleLock::unlock() {
+  uv_mutex_t* mutex = this->levelMutex();
+
+  if (mutex) {
+    uv_mutex_unlock(mutex);
+  }
+}
+
+void HandleLock::lockHandle() {
+  if (this->_threading != THREADING_NONE) {
+    uv_mutex_lock(&this->_mutex);
+  }
+}
+
+void HandleLock::unlockHandle() {
+  if (this->_threading != THREADING_NONE) {
+    uv_mutex_unlock(&this->_mutex);
+  }
+}
@@ -0,0 +1,67 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SRC_HANDLE_LOCK_H
+#define _SRC_HANDLE_LOCK_H
+
+#include <atomic>
+
+#include "odbc.h"
+
+// Lock taken around ODBC calls that the driver or driver manager may not
+// run concurrently. An environment has a lock, each connection has a lock
+// whose parent is the environment lock, and statements and results share
+// the lock of their connection.
+//
+// lock() serializes handle allocation, frees and resets at the threading
+// level: not at all, per connection, per environment or across the
+// process. lockHandle() serializes calls on the handle itself, such as
+// connecting, and never blocks other connections.
+//
+// The threading level is fixed when the lock is created. Objects holding a
+// lock may outlive the connection or environment they were created from, so
+// locks are reference counted. The count is atomic since handles are freed
+// on either thread.
+class HandleLock {
+public:
+  HandleLock(int threading, HandleLock* parent);
+
+  void ref();
+  void unref();
+
+  int threading();
+  // Environment lock of a connection lock, or the lock itself
+  HandleLock* parent();
+
+  void lock();
+  void unlock();
+  void lockHandle();
+  void unlockHandle();
+
+private:
+  ~HandleLock();
+
+  uv_mutex_t* levelMutex();
+
+  uv_mutex_t _mutex;
+  HandleLock* _parent;
+  const int _threading;
+  std::atomic<int> _refCount;
+};
+
+#endif
@@ -0,0 +1,287 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <vector>
+
+#include "odbc.h"
+#include "metadata_cache.h"
+
+/*
+ * ResultShape
+ */
+
+ResultShape::ResultShape(Column* columns, short colCount) : _isValid(true) {
+  this->_columns = columns;
+  this->_colCount = colCount;
+  this->_refCount = 0;
+}
+
+ResultShape::~ResultShape() {
+  ODBC::FreeColumns(this->_columns, &this->_colCount);
+}
+
+ResultShape* ResultShape::Describe(SQLHSTMT hStmt, ResultShape* cached) {
+  if (cached && cached->matches(hStmt)) {
+    return cached;
+  }
+
+  short colCount = 0;
+  Column* columns = ODBC::GetColumns(hStmt, &colCount);
+
+  if (colCount == 0) {
+    ODBC::FreeColumns(columns, &colCount);
+    return NULL;
+  }
+
+  return new ResultShape(columns, colCount);
+}
+
+void ResultShape::ref() {
+  this->_refCount++;
+}
+
+void ResultShape::unref() {
+  if (--this->_refCount <= 0) {
+    delete this;
+  }
+}
+
+Column* ResultShape::columns() {
+  return this->_columns;
+}
+
+short ResultShape::columnCount() {
+  return this->_colCount;
+}
+
+RecordShape* ResultShape::recordShape() {
+  if (this->_recordShape.isEmpty()) {
+    this->_recordShape.build(this->_columns, this->_colCount);
+  }
+
+  return &this->_recordShape;
+}
+
+void ResultShape::invalidate() {
+  this->_isValid = false;
+}
+
+bool ResultShape::isValid() {
+  return this->_isValid;
+}
+
+// Length in bytes of a column name read by ODBC::GetColumns
+static size_t GetNameSize(const uint8_t* name) {
+  const SQLTCHAR* chars = (const SQLTCHAR*) name;
+  size_t length = 0;
+
+  while (chars[length]) {
+    length++;
+  }
+
+  return length * sizeof(SQLTCHAR);
+}
+
+/*
+ * matches
+ *
+ * The same SQL text can return other columns after a table is altered, or
+ * when it runs against another catalog or schema, often without an error.
+ * Each column is described again and compared by type, size, digits and
+ * name, which is still much cheaper than reading every attribute as
+ * ODBC::GetColumns does.
+ */
+
+bool ResultShape::matches(SQLHSTMT hStmt) {
+  SQLSMALLINT colCount = 0;
+
+  if (!this->isValid()) { return false; }
+
+  SQLRETURN ret = SQLNumResultCols(hStmt, &colCount);
+
+  if (!SQL_SUCCEEDED(ret) || colCount != this->_colCount) { return false; }
+
+  std::vector<uint8_t> name;
+
+  for (int i = 0; i < this->_colCount; i++) {
+    Column& column = this->_columns[i];
+    SQLSMALLINT type = 0;
+    SQLULEN size = 0;
+    SQLSMALLINT digits = 0;
+    SQLSMALLINT nullable = 0;
+
+    ret = SQLDescribeCol(hStmt, column.index, NULL, 0, NULL, &type, &size, &digits, &nullable);
+
+    if (!SQL_SUCCEEDED(ret) || type != column.type || (SQLLEN) size != column.length || digits != column.scale) {
+      return false;
+    }
+
+    //room for one more character tells a longer name apart
+    size_t nameSize = GetNameSize(column.name);
+    SQLSMALLINT length = 0;
+
+    name.resize(nameSize + 2 * sizeof(SQLTCHAR));
+
+    ret = SQLColAttribute(hStmt, column.index, COLUMN_NAME_FIELD, &name[0], (SQLSMALLINT) name.size(), &length, NULL);
+
+    if (!SQL_SUCCEEDED(ret) || (size_t) length != nameSize || memcmp(&name[0], column.name, nameSize) != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+ * MetadataCache
+ */
+
+MetadataCache::MetadataCache() {
+  this->_capacity = 0;
+  this->_hits = 0;
+  this->_misses = 0;
+}
+
+MetadataCache::~MetadataCache() {
+  this->clear();
+}
+
+std::string MetadataCache::GetKey(const void* sql, int length) {
+  if (sql == NULL || length <= 0) { return std::string(); }
+  return std::string((const char*) sql, length * sizeof(SQLTCHAR));
+}
+
+size_t MetadataCache::capacity() {
+  return this->_capacity;
+}
+
+void MetadataCache::setCapacity(size_t capacity) {
+  this->_capacity = capacity;
+  this->trim();
+}
+
+size_t MetadataCache::size() {
+  return this->_entries.size();
+}
+
+size_t MetadataCache::hits() {
+  return this->_hits;
+}
+
+size_t MetadataCache::misses() {
+  return this->_misses;
+}
+
+ResultShape* MetadataCache::get(const std::string& key) {
+  if (this->_capacity == 0 || key.empty()) { return NULL; }
+
+  std::unordered_map<std::string, EntryList::iterator>::iterator it = this->_index.find(key);
+
+  if (it == this->_index.end()) {
+    this->_misses++;
+    return NULL;
+  }
+
+  ResultShape* shape = it->second->second;
+
+  if (!shape->isValid()) {
+    this->remove(key);
+    this->_misses++;
+    return NULL;
+  }
+
+  // Move to the front as the most recently used
+  this->_entries.splice(this->_entries.begin(), this->_entries, it->second);
+  this->_hits++;
+
+  shape->ref();
+  return shape;
+}
+
+void MetadataCache::update(const std::string& key, ResultShape* cached, ResultShape* described, bool failed) {
+  // A shape that no longer matched counts as a miss
+  if (cached && described != cached && !failed) {
+    this->_hits--;
+    this->_misses++;
+  }
+
+  if (failed) {
+    this->remove(key);
+  } else if (described && described != cached && this->_capacity > 0 && !key.empty()) {
+    this->put(key, described);
+  }
+
+  if (cached) {
+    cached->unref();
+  }
+}
+
+void MetadataCache::put(const std::string& key, ResultShape* shape) {
+  this->remove(key);
+
+  shape->ref();
+  this->_entries.push_front(std::make_pair(key, shape));
+  this->_index[key] = this->_entries.begin();
+
+  this->trim();
+}
+
+void MetadataCache::remove(const std::string& key) {
+  std::unordered_map<std::string, EntryList::iterator>::iterator it = this->_index.find(key);
+
+  if (it == this->_index.end()) { return; }
+
+  ResultShape* shape = it->second->second;
+
+  this->_entries.erase(it->second);
+  this->_index.erase(it);
+
+  shape->unref();
+}
+
+void MetadataCache::trim() {
+  while (this->_entries.size() > this->_capacity) {
+    this->remove(this->_entries.back().first);
+  }
+}
+
+void MetadataCache::clear() {
+  for (EntryList::iterator it = this->_entries.begin(); it != this->_entries.end(); it++) {
+    it->second->unref();
+  }
+
+  this->_entries.clear();
+  this->_index.clear();
+}
+
+/*
+ * getStats
+ */
+
+Local<Object> MetadataCache::getStats() {
+  Nan::EscapableHandleScope scope;
+
+  Local<Object> stats = Nan::New<Object>();
+
+  stats->Set(Nan::New("size").ToLocalChecked(), Nan::New<Number>((double) this->_entries.size()));
+  stats->Set(Nan::New("capacity").ToLocalChecked(), Nan::New<Number>((double) this->_capacity));
+  stats->Set(Nan::New("hits").ToLocalChecked(), Nan::New<Number>((double) this->_hits));
+  stats->Set(Nan::New("misses").ToLocalChecked(), Nan::New<Number>((double) this->_misses));
+
+  return scope.Escape(stats);
+}
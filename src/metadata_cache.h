@@ -0,0 +1,103 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SRC_METADATA_CACHE_H
+#define _SRC_METADATA_CACHE_H
+
+#include <atomic>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "odbc.h"
+#include "record_shape.h"
+
+// Described columns of a result set and the record shape built from them,
+// shared by the results of a cached statement. Describe and matches can run
+// on the thread pool. Everything else, including the reference count, is
+// event loop only, since the record shape holds V8 handles.
+class ResultShape {
+public:
+  ResultShape(Column* columns, short colCount);
+  ~ResultShape();
+
+  // Returns the cached shape if the statement still has the same columns,
+  // otherwise describes the result set again. Returns NULL if there is no
+  // result set.
+  static ResultShape* Describe(SQLHSTMT hStmt, ResultShape* cached);
+
+  void ref();
+  void unref();
+
+  Column* columns();
+  short columnCount();
+  RecordShape* recordShape();
+
+  // Marks the shape so that the cache drops it on the next lookup
+  void invalidate();
+  bool isValid();
+  bool matches(SQLHSTMT hStmt);
+
+private:
+  Column* _columns;
+  short _colCount;
+  RecordShape _recordShape;
+  int _refCount;
+  std::atomic<bool> _isValid;
+};
+
+// Least recently used cache of result shapes keyed by SQL text. A capacity
+// of 0 disables caching. Event loop only.
+class MetadataCache {
+public:
+  MetadataCache();
+  ~MetadataCache();
+
+  // Key for SQL text of length characters
+  static std::string GetKey(const void* sql, int length);
+
+  size_t capacity();
+  void setCapacity(size_t capacity);
+  size_t size();
+  size_t hits();
+  size_t misses();
+
+  // Returns a referenced shape, or NULL on a miss
+  ResultShape* get(const std::string& key);
+  // Stores the shape described for an execution that started with cached,
+  // or drops the entry if the execution failed. Releases cached.
+  void update(const std::string& key, ResultShape* cached, ResultShape* described, bool failed);
+  void remove(const std::string& key);
+  void clear();
+
+  Local<Object> getStats();
+
+private:
+  typedef std::list<std::pair<std::string, ResultShape*> > EntryList;
+
+  void put(const std::string& key, ResultShape* shape);
+  void trim();
+
+  EntryList _entries;
+  std::unordered_map<std::string, EntryList::iterator> _index;
+  size_t _capacity;
+  size_t _hits;
+  size_t _misses;
+};
+
+#endif
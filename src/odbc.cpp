@@ -19,6 +19,8 @@
 */
 
 #include <string.h>
+#include <limits.h>
+#include <vector>
 #include <v8.h>
 #include <node.h>
 #include <node_version.h>
@@ -29,9 +31,14 @@
 #include "odbc_connection.h"
 #include "odbc_result.h"
 #include "odbc_statement.h"
+#include "odbc_pool.h"
 
 #include "util.h"
-#include "chunked_buffer.h"
+#include "row_batch.h"
+#include "record_shape.h"
+#include "buffer_pool.h"
+#include "handle_lock.h"
+#include "executor.h"
 
 #ifdef dynodbc
 #include "dynodbc.h"
@@ -75,12 +82,33 @@ void ODBC::Init(v8::Handle<Object> exports) {
   constructor_template->Set(Nan::New<String>("SQL_DESTROY").ToLocalChecked(), Nan::New<Number>(SQL_DESTROY), constant_attributes);
   constructor_template->Set(Nan::New<String>("FETCH_ARRAY").ToLocalChecked(), Nan::New<Number>(FETCH_ARRAY), constant_attributes);
   NODE_ODBC_DEFINE_CONSTANT(constructor_template, FETCH_OBJECT);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, FETCH_COLUMNAR);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, FETCH_FLAT);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, BIGINT_STRING);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, BIGINT_NUMBER);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, BIGINT_BIGINT);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, DECIMAL_STRING);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, DECIMAL_NUMBER);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, DECIMAL_SCALED);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, DATE_STRING);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, DATE_UTC);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, DATE_LOCAL);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, LOB_VALUE);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, LOB_STREAM);
   NODE_ODBC_DEFINE_CONSTANT(constructor_template, MAX_VALUE_SIZE);
   NODE_ODBC_DEFINE_CONSTANT(constructor_template, MAX_VALUE_CHUNK_SIZE);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, THREADING_NONE);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, THREADING_CONNECTION);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, THREADING_ENVIRONMENT);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, THREADING_PROCESS);
+
+  // Properties
+  Nan::SetAccessor(instance_template, Nan::New("threading").ToLocalChecked(), ThreadingGetter);
 
   // Prototype Methods
   Nan::SetPrototypeMethod(constructor_template, "createConnection", CreateConnection);
   Nan::SetPrototypeMethod(constructor_template, "createConnectionSync", CreateConnectionSync);
+  Nan::SetPrototypeMethod(constructor_template, "createPoolSync", CreatePoolSync);
 
   // Attach the Database Constructor to the target object
   constructor.Reset(constructor_template->GetFunction());
@@ -89,11 +117,15 @@ void ODBC::Init(v8::Handle<Object> exports) {
   
   // Initialize the cross platform mutex provided by libuv
   uv_mutex_init(&ODBC::g_odbcMutex);
+
+  BufferPool::Init();
 }
 
 ODBC::~ODBC() {
   DEBUG_PRINTF("ODBC::~ODBC\n");
   this->Free();
+
+  m_lock->unref();
 }
 
 void ODBC::Free() {
@@ -118,7 +150,23 @@ NAN_METHOD(ODBC::New) {
   dbo->Wrap(info.Holder());
 
   dbo->m_hEnv = NULL;
+
+  //the threading level is fixed for the environment and its connections
+  int threading = THREADING_DEFAULT;
+
+  if (info.Length() > 0 && info[0]->IsInt32()) {
+    int value = info[0]->Int32Value();
+
+    if (value >= THREADING_NONE && value <= THREADING_PROCESS) {
+      threading = value;
+    }
+  }
+
+  dbo->m_lock = new HandleLock(threading, NULL);
+  dbo->m_lock->ref();
   
+  //the driver manager keeps global state for environments, so they are
+  //always allocated and freed under the process lock
   uv_mutex_lock(&ODBC::g_odbcMutex);
   
   // Initialize the Environment handle
@@ -140,6 +188,14 @@ NAN_METHOD(ODBC::New) {
   info.GetReturnValue().Set(info.Holder());
 }
 
+NAN_GETTER(ODBC::ThreadingGetter) {
+  Nan::HandleScope scope;
+
+  ODBC *obj = Nan::ObjectWrap::Unwrap<ODBC>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>(obj->m_lock->threading()));
+}
+
 //void ODBC::WatcherCallback(uv_async_t *w, int revents) {
 //  DEBUG_PRINTF("ODBC::WatcherCallback\n");
 //  //i don't know if we need to do anything here
@@ -171,7 +227,7 @@ NAN_METHOD(ODBC::CreateConnection) {
 
   work_req->data = data;
   
-  uv_queue_work(uv_default_loop(), work_req, UV_CreateConnection, (uv_after_work_cb)UV_AfterCreateConnection);
+  Executor::QueueWork(uv_default_loop(), work_req, UV_CreateConnection, (uv_after_work_cb)UV_AfterCreateConnection, NULL);
 
   dbo->Ref();
 
@@ -184,12 +240,12 @@ void ODBC::UV_CreateConnection(uv_work_t* req) {
   //get our work data
   create_connection_work_data* data = (create_connection_work_data *)(req->data);
   
-  uv_mutex_lock(&ODBC::g_odbcMutex);
+  data->dbo->m_lock->lock();
 
   //allocate a new connection handle
   data->result = SQLAllocHandle(SQL_HANDLE_DBC, data->dbo->m_hEnv, &data->hDBC);
   
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  data->dbo->m_lock->unlock();
 }
 
 void ODBC::UV_AfterCreateConnection(uv_work_t* req, int status) {
@@ -208,11 +264,12 @@ void ODBC::UV_AfterCreateConnection(uv_work_t* req, int status) {
     data->cb->Call(1, info);
   }
   else {
-    Local<Value> info[2];
+    Local<Value> info[3];
     info[0] = Nan::New<External>(data->dbo->m_hEnv);
     info[1] = Nan::New<External>(data->hDBC);
+    info[2] = Nan::New<External>(data->dbo->m_lock);
     
-    Local<Value> js_result = Nan::New<Function>(ODBCConnection::constructor)->NewInstance(2, info);
+    Local<Value> js_result = Nan::New<Function>(ODBCConnection::constructor)->NewInstance(3, info);
 
     info[0] = Nan::Null();
     info[1] = js_result;
@@ -244,7 +301,7 @@ NAN_METHOD(ODBC::CreateConnectionSync) {
    
   HDBC hDBC;
   
-  uv_mutex_lock(&ODBC::g_odbcMutex);
+  dbo->m_lock->lock();
   
   //allocate a new connection handle
   SQLRETURN ret = SQLAllocHandle(SQL_HANDLE_DBC, dbo->m_hEnv, &hDBC);
@@ -253,24 +310,111 @@ NAN_METHOD(ODBC::CreateConnectionSync) {
     //TODO: do something!
   }
   
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  dbo->m_lock->unlock();
 
-  Local<Value> params[2];
+  Local<Value> params[3];
   params[0] = Nan::New<External>(dbo->m_hEnv);
   params[1] = Nan::New<External>(hDBC);
+  params[2] = Nan::New<External>(dbo->m_lock);
 
-  Local<Object> js_result = Nan::New<Function>(ODBCConnection::constructor)->NewInstance(2, params);
+  Local<Object> js_result = Nan::New<Function>(ODBCConnection::constructor)->NewInstance(3, params);
+
+  info.GetReturnValue().Set(js_result);
+}
+
+/*
+ * CreatePoolSync
+ */
+
+NAN_METHOD(ODBC::CreatePoolSync) {
+  DEBUG_PRINTF("ODBC::CreatePoolSync\n");
+  Nan::HandleScope scope;
+
+  REQ_STRO_ARG(0, connection);
+
+  ODBC* dbo = Nan::ObjectWrap::Unwrap<ODBC>(info.Holder());
+
+  //connections are only made when the pool is used
+  Local<Value> params[4];
+  params[0] = Nan::New<External>(dbo->m_hEnv);
+  params[1] = Nan::New<External>(dbo->m_lock);
+  params[2] = connection;
+  params[3] = info.Holder();
+
+  Local<Object> js_result = Nan::New<Function>(ODBCPool::constructor)->NewInstance(4, params);
 
   info.GetReturnValue().Set(js_result);
 }
 
 /*
  * GetColumns
+ *
+ * Describes the columns of the current result set. Safe to call off the
+ * event loop. SQLDescribeCol provides the type, size and decimal digits, so
+ * only the octet length, the name strings and, for numeric types, the radix
+ * are read with SQLColAttribute. Names are stored after the columns in the
+ * same allocation, which is released with FreeColumns.
  */
 
+// Reads a string attribute into the end of the arena and returns its offset
+static size_t AppendColumnString(SQLHSTMT hStmt, SQLUSMALLINT index, SQLUSMALLINT field, std::vector<uint8_t>& arena) {
+  size_t offset = arena.size();
+  SQLSMALLINT size = COLUMN_STRING_SIZE;
+  SQLSMALLINT length = 0;
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    arena.resize(offset + size + sizeof(SQLTCHAR));
+
+    SQLRETURN ret = SQLColAttribute(hStmt, index, field, &arena[offset], size + sizeof(SQLTCHAR), &length, NULL);
+
+    if (!SQL_SUCCEEDED(ret) || length < 0) {
+      length = 0;
+      break;
+    }
+
+    // Retry once with the reported size if the string was truncated
+    if (length <= size || length > SHRT_MAX - (SQLSMALLINT) sizeof(SQLTCHAR)) { break; }
+    size = length;
+  }
+
+  length = length < size ? length : size;
+  length -= length % sizeof(SQLTCHAR);
+
+  arena.resize(offset + length + sizeof(SQLTCHAR));
+  memset(&arena[offset + length], 0, sizeof(SQLTCHAR));
+
+  return offset;
+}
+
+// Radix only applies to numeric types. It is also read for unknown types,
+// where it helps to decide how values are converted.
+static bool HasRadix(SQLSMALLINT type) {
+  switch (type) {
+    case SQL_CHAR:
+    case SQL_VARCHAR:
+    case SQL_LONGVARCHAR:
+    case SQL_WCHAR:
+    case SQL_WVARCHAR:
+    case SQL_WLONGVARCHAR:
+    case SQL_BINARY:
+    case SQL_VARBINARY:
+    case SQL_LONGVARBINARY:
+    case SQL_BIT:
+    case SQL_DATE:
+    case SQL_TIME:
+    case SQL_TIMESTAMP:
+    case SQL_TYPE_DATE:
+    case SQL_TYPE_TIME:
+    case SQL_TYPE_TIMESTAMP:
+    case SQL_GUID:
+      return false;
+    default:
+      return true;
+  }
+}
+
 Column* ODBC::GetColumns(SQLHSTMT hStmt, short* colCount) {
   SQLRETURN ret;
-  SQLSMALLINT buflen;
 
   //always reset colCount for the current result set to 0;
   *colCount = 0; 
@@ -278,115 +422,84 @@ Column* ODBC::GetColumns(SQLHSTMT hStmt, short* colCount) {
   //get the number of columns in the result set
   ret = SQLNumResultCols(hStmt, colCount);
   
-  if (!SQL_SUCCEEDED(ret)) {
-    return new Column[0];
+  if (!SQL_SUCCEEDED(ret) || *colCount <= 0) {
+    *colCount = 0;
+    return NULL;
   }
   
-  Column *columns = new Column[*colCount];
+  std::vector<Column> columns(*colCount);
+  std::vector<size_t> nameOffsets(*colCount);
+  std::vector<size_t> typeNameOffsets(*colCount);
+  std::vector<uint8_t> arena;
+
+  arena.reserve(*colCount * 2 * (COLUMN_STRING_SIZE + sizeof(SQLTCHAR)));
 
   for (int i = 0; i < *colCount; i++) {
+    Column& column = columns[i];
+    SQLSMALLINT type = 0;
+    SQLULEN size = 0;
+    SQLSMALLINT digits = 0;
+    SQLSMALLINT nullable = 0;
+
     //save the index number of this column
-    columns[i].index = i + 1;
+    column.index = i + 1;
 
-    //get the estimated size of column name
-    ret = SQLColAttribute( hStmt,
-                           columns[i].index,
-#ifdef STRICT_COLUMN_NAMES
-                           SQL_DESC_NAME,
-#else
-                           SQL_DESC_LABEL,
-#endif
-                           NULL,
-                           NULL,
-                           &buflen,
-                           NULL);
-
-    SQLSMALLINT estimatedSize = buflen + sizeof(SQLWCHAR);
-    columns[i].name = new uint8_t[estimatedSize];
-    memset(columns[i].name, NULL, sizeof(SQLWCHAR));
-
-    //get the column name
-    ret = SQLColAttribute( hStmt,
-                           columns[i].index,
-#ifdef STRICT_COLUMN_NAMES
-                           SQL_DESC_NAME,
-#else
-                           SQL_DESC_LABEL,
-#endif
-                           columns[i].name,
-                           estimatedSize,
-                           &buflen,
-                           NULL);
-
-    //get the estimated size of column type name
-    ret = SQLColAttribute( hStmt,
-                           columns[i].index,
-                           SQL_DESC_TYPE_NAME,
-                           NULL,
-                           NULL,
-                           &buflen,
-                           NULL);
-
-    estimatedSize = buflen + sizeof(SQLWCHAR);
-    columns[i].typeName = new uint8_t[estimatedSize];
-    memset(columns[i].typeName, NULL, sizeof(SQLWCHAR));
-
-    // get the column type name
-    ret = SQLColAttribute( hStmt,
-                           columns[i].index,
-                           SQL_DESC_TYPE_NAME,
-                           columns[i].typeName,
-                           estimatedSize,
-                           &buflen,
-                           NULL);
-
-    columns[i].type = 0;
-    ret = SQLColAttribute(hStmt,
-      columns[i].index,
-      SQL_DESC_CONCISE_TYPE,
-      NULL,
-      0,
-      NULL,
-      &columns[i].type);
+    ret = SQLDescribeCol(hStmt, column.index, NULL, 0, NULL, &type, &size, &digits, &nullable);
 
-    columns[i].length = 0;
-    ret = SQLColAttribute(hStmt,
-      columns[i].index,
-      SQL_DESC_LENGTH,
-      NULL,
-      0,
-      NULL,
-      &columns[i].length);
+    if (!SQL_SUCCEEDED(ret)) {
+      type = 0;
+      size = 0;
+      digits = 0;
+    }
+
+    column.type = type;
+    column.length = (SQLLEN) size;
+    column.scale = digits;
 
-    columns[i].octetLength = 0;
+    nameOffsets[i] = AppendColumnString(hStmt, column.index, COLUMN_NAME_FIELD, arena);
+
+    typeNameOffsets[i] = AppendColumnString(hStmt, column.index, SQL_DESC_TYPE_NAME, arena);
+
+    column.octetLength = 0;
     ret = SQLColAttribute(hStmt,
-      columns[i].index,
+      column.index,
       SQL_DESC_OCTET_LENGTH,
       NULL,
       0,
       NULL,
-      &columns[i].octetLength);
+      &column.octetLength);
 
-    columns[i].scale = 0;
-    ret = SQLColAttribute(hStmt,
-      columns[i].index,
-      SQL_DESC_SCALE,
-      NULL,
-      0,
-      NULL,
-      &columns[i].scale);
+    column.radix = 0;
+    if (HasRadix(type)) {
+      ret = SQLColAttribute(hStmt,
+        column.index,
+        SQL_DESC_NUM_PREC_RADIX,
+        NULL,
+        0,
+        NULL,
+        &column.radix);
+    }
+  }
 
-    columns[i].radix = 0;
-    ret = SQLColAttribute(hStmt,
-      columns[i].index,
-      SQL_DESC_NUM_PREC_RADIX,
-      NULL,
-      0,
-      NULL,
-      &columns[i].radix);
+  size_t columnsSize = *colCount * sizeof(Column);
+  uint8_t* data = (uint8_t*) malloc(columnsSize + arena.size());
+
+  if (data == NULL) {
+    *colCount = 0;
+    return NULL;
   }
-  
-  return columns;
+
+  memcpy(data, columns.data(), columnsSize);
+  memcpy(data + columnsSize, arena.data(), arena.size());
+
+  Column* result = (Column*) data;
+
+  for (int i = 0; i < *colCount; i++) {
+    result[i].name = data + columnsSize + nameOffsets[i];
+    result[i].typeName = data + columnsSize + typeNameOffsets[i];
+  }
+
+  return result;
 }
 
 /*
@@ -394,12 +507,7 @@ Column* ODBC::GetColumns(SQLHSTMT hStmt, short* colCount) {
  */
 
 void ODBC::FreeColumns(Column* columns, short* colCount) {
-  for(int i = 0; i < *colCount; i++) {
-      delete [] columns[i].name;
-      delete [] columns[i].typeName;
-  }
-
-  delete [] columns;
+  free(columns);
   
   *colCount = 0;
 }
@@ -457,349 +565,6 @@ Local<Array> ODBC::GetColumnMetadata(Column* columns, short* colCount) {
   return scope.Escape(columnMetadata);
 }
 
-/*
- * GetColumnValue
- */
-
-void FreeBufferCallback(char* data, void* hint) {
-  free(data);
-}
-
-Handle<Value> ODBC::GetColumnValue(SQLHSTMT hStmt, Column column,
-                                   uint8_t* buffer, int bufferLength,
-                                   size_t maxValueSize, size_t valueChunkSize) {
-  Nan::EscapableHandleScope scope;
-
-  const char* errHint = "[node-odbc] Error in ODBC::GetColumnValue";
-  Local<Value> objError;
-  bool hasError = false;
-
-  if (valueChunkSize > MAX_VALUE_CHUNK_SIZE) { valueChunkSize = MAX_VALUE_CHUNK_SIZE; }
-  if (valueChunkSize > maxValueSize) { valueChunkSize = maxValueSize; }
-
-  int ret;
-  SQLLEN len;
-  SQLLEN type = column.type;
-
-  switch (type) {
-    case SQL_INTEGER:
-    case SQL_SMALLINT:
-    case SQL_TINYINT:
-    case SQL_FLOAT:
-    case SQL_REAL:
-    case SQL_DOUBLE:
-    case SQL_BIT:
-    case SQL_BINARY:
-    case SQL_VARBINARY:
-    case SQL_LONGVARBINARY:
-    case SQL_NUMERIC:
-    case SQL_DECIMAL:
-    case SQL_BIGINT:
-    case SQL_DATE:
-    case SQL_TIME:
-    case SQL_TIMESTAMP:
-    case SQL_TYPE_DATE:
-    case SQL_TYPE_TIME:
-    case SQL_TYPE_TIMESTAMP:
-    case SQL_GUID:
-      break;
-    case SQL_CHAR:
-    case SQL_VARCHAR:
-    case SQL_LONGVARCHAR:
-    case SQL_WCHAR:
-    case SQL_WVARCHAR:
-    case SQL_WLONGVARCHAR:
-    {
-      if (column.octetLength == 0 || column.octetLength > LONG_DATA_THRESHOLD) {
-        type = SQL_BINARY;
-      }
-      break;
-    }
-    default:
-    {
-      // Determine how unknown type should be treated
-      type = SQL_CHAR;
-      if (column.radix != 0) { break; }
-
-      // (column.octetLength != column.length) suggests formatting, thus likely to be char data
-      if (column.octetLength == 0 || column.octetLength > LONG_DATA_THRESHOLD || column.octetLength == column.length) {
-        type = SQL_BINARY;
-      }
-    }
-  }
-
-  switch (type) {
-    case SQL_INTEGER:
-    case SQL_SMALLINT:
-    case SQL_TINYINT:
-    {
-      int32_t value;
-
-      ret = SQLGetData(
-        hStmt,
-        column.index,
-        SQL_C_SLONG,
-        &value,
-        sizeof(value),
-        &len);
-
-      DEBUG_PRINTF("ODBC::GetColumnValue - Integer: index=%u name=%s type=%zi len=%zi ret=%i\n",
-                   column.index, column.name, column.type, len, ret);
-
-      if (!SQL_SUCCEEDED(ret)) { break; }
-
-      if (len == SQL_NULL_DATA) {
-        return scope.Escape(Nan::Null());
-      }
-      return scope.Escape(Nan::New<Integer>(value));
-    }
-    case SQL_FLOAT:
-    case SQL_REAL:
-    case SQL_DOUBLE:
-    {
-      double value;
-
-      ret = SQLGetData(
-        hStmt,
-        column.index,
-        SQL_C_DOUBLE,
-        &value,
-        sizeof(value),
-        &len);
-
-      DEBUG_PRINTF("ODBC::GetColumnValue - Number: index=%u name=%s type=%zi len=%zi ret=%i\n",
-                   column.index, column.name, column.type, len, ret);
-
-      if (!SQL_SUCCEEDED(ret)) { break; }
-
-      if (len == SQL_NULL_DATA) {
-        return scope.Escape(Nan::Null());
-      }
-      return scope.Escape(Nan::New<Number>(value));
-    }
-    case SQL_BIT:
-    {
-      ret = SQLGetData(
-        hStmt,
-        column.index,
-        SQL_C_CHAR,
-        buffer,
-        bufferLength,
-        &len);
-
-      DEBUG_PRINTF("ODBC::GetColumnValue - Bit: index=%u name=%s type=%zi len=%zi ret=%i\n",
-                   column.index, column.name, column.type, len, ret);
-
-      if (!SQL_SUCCEEDED(ret)) { break; }
-
-      if (len == SQL_NULL_DATA) {
-        return scope.Escape(Nan::Null());
-      }
-      return scope.Escape(Nan::New<Boolean>((*buffer == '0') ? false : true));
-    }
-    case SQL_BINARY:
-    case SQL_VARBINARY:
-    case SQL_LONGVARBINARY:
-    {
-      ChunkedBuffer cbuffer(maxValueSize);
-      SQLLEN totalSize = 0;
-
-      do {
-        Chunk* chunk = cbuffer.createChunk(valueChunkSize);
-        if (!chunk) {
-          if (!cbuffer.isFull()) {
-            objError = GetError("[node-odbc] Failed to allocate buffer for column data", "ENOMEM", errHint);
-            hasError = true;
-          }
-          break;
-        }
-
-        ret = SQLGetData(
-          hStmt,
-          column.index,
-          SQL_C_BINARY,
-          chunk->buffer(),
-          chunk->bufferSize(),
-          &len);
-
-        DEBUG_PRINTF("ODBC::GetColumnValue - Long Data: index=%u name=%s type=%zi len=%zi ret=%i\n",
-                     column.index, column.name, column.type, len, ret);
-
-        if (!SQL_SUCCEEDED(ret)) { break; }
-        if (ret == SQL_NO_DATA) { break; }
-
-        if (len == SQL_NULL_DATA) {
-          return scope.Escape(Nan::Null());
-        }
-
-        if (totalSize == 0 && len > 0) { totalSize = len; };
-      } while (ret != SQL_SUCCESS);
-
-      if (hasError || !SQL_SUCCEEDED(ret)) { break; }
-
-      Local<Array> buffers = Nan::New<Array>();
-      std::list<Chunk*> chunks = cbuffer.getChunks();
-
-      size_t count = 0;
-      size_t currentSize = 0;
-      size_t size;
-      uint8_t* buf;
-
-      if (totalSize <= 0) { totalSize = cbuffer.bufferSize(); }
-
-      for (std::list<Chunk*>::iterator it = chunks.begin(); it != chunks.end(); it++) {
-        size = (*it)->bufferSize();
-
-        if (size > totalSize - currentSize) {
-          size = totalSize - currentSize;
-        }
-        if (size == 0) { continue; }
-
-        if (size == (*it)->bufferSize()) {
-          buf = (*it)->detach();
-        } else {
-          buf = (uint8_t*) malloc(size);
-          if (!buf) { break; }
-          (*it)->copy(buf, size);
-        }
-
-        (*it)->clear();
-
-        buffers->Set(Nan::New((uint32_t) count), Nan::NewBuffer((char*) buf, (size_t) size, FreeBufferCallback, NULL).ToLocalChecked());
-
-        currentSize += size;
-        count++;
-      }
-
-      return scope.Escape(buffers);
-    }
-    case SQL_WCHAR:
-    case SQL_WVARCHAR:
-    case SQL_WLONGVARCHAR:
-    {
-      ret = SQLGetData(
-        hStmt,
-        column.index,
-        SQL_C_WCHAR,
-        buffer,
-        bufferLength,
-        &len);
-
-      DEBUG_PRINTF("ODBC::GetColumnValue - Wide String: index=%u name=%s type=%zi len=%zi ret=%i\n",
-                   column.index, column.name, column.type, len, ret);
-
-      if (!SQL_SUCCEEDED(ret)) { break; }
-
-      if (len == SQL_NULL_DATA) {
-        return scope.Escape(Nan::Null());
-      }
-      return scope.Escape(Nan::New<String>((const uint16_t*)buffer).ToLocalChecked());
-    }
-    case SQL_CHAR:
-    case SQL_VARCHAR:
-    case SQL_LONGVARCHAR:
-    case SQL_NUMERIC:
-    case SQL_DECIMAL:
-    case SQL_BIGINT:
-    case SQL_DATE:
-    case SQL_TIME:
-    case SQL_TIMESTAMP:
-    case SQL_TYPE_DATE:
-    case SQL_TYPE_TIME:
-    case SQL_TYPE_TIMESTAMP:
-    case SQL_GUID:
-    default:
-    {
-      ret = SQLGetData(
-        hStmt,
-        column.index,
-        SQL_C_CHAR,
-        buffer,
-        bufferLength,
-        &len);
-
-      DEBUG_PRINTF("ODBC::GetColumnValue - String: index=%u name=%s type=%zi len=%zi ret=%i\n",
-                   column.index, column.name, column.type, len, ret);
-
-      if (!SQL_SUCCEEDED(ret)) { break; }
-
-      if (len == SQL_NULL_DATA) {
-        return scope.Escape(Nan::Null());
-      }
-      return scope.Escape(Nan::New<String>((const char*)buffer).ToLocalChecked());
-    }
-  }
-
-  //an error has occured
-
-  if (!hasError) {
-    //possible values for ret are SQL_ERROR (-1) and SQL_INVALID_HANDLE (-2)
-
-    //If we have an invalid handle, then stuff is way bad and we should abort
-    //immediately. Memory errors are bound to follow as we must be in an
-    //inconsisant state.
-    assert(ret != SQL_INVALID_HANDLE);
-
-    //Not sure if throwing here will work out well for us but we can try
-    //since we should have a valid handle and the error is something we
-    //can look into
-
-    objError = ODBC::GetSQLError(
-      SQL_HANDLE_STMT,
-      hStmt,
-      errHint
-    );
-  }
-
-  Nan::ThrowError(objError);
-  return scope.Escape(Nan::Undefined());
-}
-
-/*
- * GetRecordTuple
- */
-
-Local<Value> ODBC::GetRecordTuple (SQLHSTMT hStmt,
-                                   Column* columns, short* colCount,
-                                   uint8_t* buffer, int bufferLength,
-                                   size_t maxValueSize, size_t valueChunkSize) {
-  Nan::EscapableHandleScope scope;
-  
-  Local<Object> tuple = Nan::New<Object>();
-        
-  for(int i = 0; i < *colCount; i++) {
-#ifdef UNICODE
-    tuple->Set( Nan::New((const uint16_t *) columns[i].name).ToLocalChecked(),
-                GetColumnValue( hStmt, columns[i], buffer, bufferLength, maxValueSize, valueChunkSize));
-#else
-    tuple->Set( Nan::New((const char *) columns[i].name).ToLocalChecked(),
-                GetColumnValue( hStmt, columns[i], buffer, bufferLength, maxValueSize, valueChunkSize));
-#endif
-  }
-  
-  return scope.Escape(tuple);
-}
-
-/*
- * GetRecordArray
- */
-
-Local<Value> ODBC::GetRecordArray (SQLHSTMT hStmt,
-                                   Column* columns, short* colCount,
-                                   uint8_t* buffer, int bufferLength,
-                                   size_t maxValueSize, size_t valueChunkSize) {
-  Nan::EscapableHandleScope scope;
-  
-  Local<Array> array = Nan::New<Array>();
-        
-  for(int i = 0; i < *colCount; i++) {
-    array->Set( Nan::New(i),
-                GetColumnValue( hStmt, columns[i], buffer, bufferLength, maxValueSize, valueChunkSize));
-  }
-  
-  return scope.Escape(array);
-}
-
 /*
  * GetParametersFromObjectArray
  */
@@ -1149,6 +914,34 @@ Local<Value> ODBC::CallbackSQLError (SQLSMALLINT handleType,
   return scope.Escape(Nan::Undefined());
 }
 
+/*
+ * GetStateReason
+ *
+ * Reason for SQLSTATEs that callers tell apart from other errors, or NULL.
+ */
+
+static const char* GetStateReason(const SQLTCHAR* state) {
+  static const char* codes[][2] = {
+    { "HY008", "ECANCELED" },
+    { "HYT00", "ETIMEDOUT" },
+    { "HYT01", "ETIMEDOUT" }
+  };
+
+  for (size_t i = 0; i < sizeof(codes) / sizeof(codes[0]); i++) {
+    int j = 0;
+
+    while (j < 5 && state[j] == (SQLTCHAR) codes[i][0][j]) {
+      j++;
+    }
+
+    if (j == 5) {
+      return codes[i][1];
+    }
+  }
+
+  return NULL;
+}
+
 /*
  * GetSQLError
  */
@@ -1164,19 +957,30 @@ Local<Object> ODBC::GetSQLError (SQLSMALLINT handleType, SQLHANDLE handle) {
 
 Local<Object> ODBC::GetSQLError (SQLSMALLINT handleType, SQLHANDLE handle, const char* message) {
   Nan::EscapableHandleScope scope;
-  
-  DEBUG_PRINTF("ODBC::GetSQLError : handleType=%i, handle=%p\n", handleType, handle);
-  
-  Local<Object> objError = Nan::New<Object>();
 
-  int32_t i = 0;
-  SQLINTEGER native;
-  
+  SQLDiagnostics* diagnostics = ReadSQLDiagnostics(handleType, handle);
+  Local<Object> objError = GetSQLError(diagnostics, message);
+
+  FreeSQLDiagnostics(diagnostics);
+
+  return scope.Escape(objError);
+}
+
+/*
+ * ReadSQLDiagnostics
+ *
+ * Copies the diagnostic records of a handle, so that work on the thread pool
+ * can read them before resetting statement attributes clears them.
+ */
+
+SQLDiagnostics* ODBC::ReadSQLDiagnostics (SQLSMALLINT handleType, SQLHANDLE handle) {
+  DEBUG_PRINTF("ODBC::ReadSQLDiagnostics : handleType=%i, handle=%p\n", handleType, handle);
+
+  SQLDiagnostics* diagnostics = (SQLDiagnostics *) calloc(1, sizeof(SQLDiagnostics));
+
   SQLSMALLINT len;
-  SQLINTEGER statusRecCount;
+  SQLINTEGER statusRecCount = 0;
   SQLRETURN ret;
-  char errorSQLState[14];
-  char errorMessage[ERROR_MESSAGE_BUFFER_BYTES];
 
   ret = SQLGetDiagField(
     handleType,
@@ -1188,62 +992,95 @@ Local<Object> ODBC::GetSQLError (SQLSMALLINT handleType, SQLHANDLE handle, const
     &len);
 
   // Windows seems to define SQLINTEGER as long int, unixodbc as just int... %i should cover both
-  DEBUG_PRINTF("ODBC::GetSQLError : called SQLGetDiagField; ret=%i, statusRecCount=%i\n", ret, statusRecCount);
+  DEBUG_PRINTF("ODBC::ReadSQLDiagnostics : called SQLGetDiagField; ret=%i, statusRecCount=%i\n", ret, statusRecCount);
+
+  if (!SQL_SUCCEEDED(ret) || statusRecCount <= 0) {
+    return diagnostics;
+  }
+
+  diagnostics->records = (SQLDiagRecord *) malloc(statusRecCount * sizeof(SQLDiagRecord));
+
+  for (int32_t i = 0; i < statusRecCount; i++) {
+    SQLDiagRecord* record = &diagnostics->records[diagnostics->count];
 
-  Local<Array> errors = Nan::New<Array>();
-  objError->Set(Nan::New("errors").ToLocalChecked(), errors);
-  
-  for (i = 0; i < statusRecCount; i++){
-    DEBUG_PRINTF("ODBC::GetSQLError : calling SQLGetDiagRec; i=%i, statusRecCount=%i\n", i, statusRecCount);
-    
     ret = SQLGetDiagRec(
-      handleType, 
+      handleType,
       handle,
-      (SQLSMALLINT)(i + 1), 
-      (SQLTCHAR *) errorSQLState,
-      &native,
-      (SQLTCHAR *) errorMessage,
+      (SQLSMALLINT)(i + 1),
+      (SQLTCHAR *) record->state,
+      &record->native,
+      (SQLTCHAR *) record->message,
       ERROR_MESSAGE_BUFFER_CHARS,
       &len);
-    
-    DEBUG_PRINTF("ODBC::GetSQLError : after SQLGetDiagRec; i=%i\n", i);
+
+    DEBUG_PRINTF("ODBC::ReadSQLDiagnostics : after SQLGetDiagRec; i=%i\n", i);
 
     if (SQL_SUCCEEDED(ret)) {
-      DEBUG_PRINTF("ODBC::GetSQLError : errorMessage=%s, errorSQLState=%s\n", errorMessage, errorSQLState);
-      
-      if (i == 0) {
-        // First error is assumed the primary error
-        objError->Set(Nan::New("error").ToLocalChecked(), Nan::New(message).ToLocalChecked());
+      DEBUG_PRINTF("ODBC::ReadSQLDiagnostics : errorMessage=%s, errorSQLState=%s\n", record->message, record->state);
+
+      diagnostics->count++;
+    } else if (ret == SQL_NO_DATA) {
+      break;
+    }
+  }
+
+  return diagnostics;
+}
+
+void ODBC::FreeSQLDiagnostics (SQLDiagnostics* diagnostics) {
+  if (diagnostics) {
+    free(diagnostics->records);
+    free(diagnostics);
+  }
+}
+
+Local<Object> ODBC::GetSQLError (SQLDiagnostics* diagnostics, const char* message) {
+  Nan::EscapableHandleScope scope;
+
+  Local<Object> objError = Nan::New<Object>();
+
+  Local<Array> errors = Nan::New<Array>();
+  objError->Set(Nan::New("errors").ToLocalChecked(), errors);
+
+  for (int32_t i = 0; i < diagnostics->count; i++) {
+    SQLDiagRecord* record = &diagnostics->records[i];
+
+    if (i == 0) {
+      // First error is assumed the primary error
+      objError->Set(Nan::New("error").ToLocalChecked(), Nan::New(message).ToLocalChecked());
 #ifdef UNICODE
-        objError->SetPrototype(Exception::Error(Nan::New((uint16_t *)errorMessage).ToLocalChecked()));
-        objError->Set(Nan::New("message").ToLocalChecked(), Nan::New((uint16_t *)errorMessage).ToLocalChecked());
-        objError->Set(Nan::New("state").ToLocalChecked(), Nan::New((uint16_t *)errorSQLState).ToLocalChecked());
+      objError->SetPrototype(Exception::Error(Nan::New((uint16_t *)record->message).ToLocalChecked()));
+      objError->Set(Nan::New("message").ToLocalChecked(), Nan::New((uint16_t *)record->message).ToLocalChecked());
+      objError->Set(Nan::New("state").ToLocalChecked(), Nan::New((uint16_t *)record->state).ToLocalChecked());
 #else
-        objError->SetPrototype(Exception::Error(Nan::New(errorMessage).ToLocalChecked()));
-        objError->Set(Nan::New("message").ToLocalChecked(), Nan::New(errorMessage).ToLocalChecked());
-        objError->Set(Nan::New("state").ToLocalChecked(), Nan::New(errorSQLState).ToLocalChecked());
+      objError->SetPrototype(Exception::Error(Nan::New(record->message).ToLocalChecked()));
+      objError->Set(Nan::New("message").ToLocalChecked(), Nan::New(record->message).ToLocalChecked());
+      objError->Set(Nan::New("state").ToLocalChecked(), Nan::New(record->state).ToLocalChecked());
 #endif
-        objError->Set(Nan::New("code").ToLocalChecked(), Nan::New(native));
+      objError->Set(Nan::New("code").ToLocalChecked(), Nan::New(record->native));
+
+      //cancellations and timeouts get a reason, code stays the native error
+      const char* reason = GetStateReason((SQLTCHAR *) record->state);
+
+      if (reason) {
+        objError->Set(Nan::New("reason").ToLocalChecked(), Nan::New(reason).ToLocalChecked());
       }
+    }
 
-      Local<Object> subError = Nan::New<Object>();
+    Local<Object> subError = Nan::New<Object>();
 
 #ifdef UNICODE
-      subError->Set(Nan::New("message").ToLocalChecked(), Nan::New((uint16_t *)errorMessage).ToLocalChecked());
-      subError->Set(Nan::New("state").ToLocalChecked(), Nan::New((uint16_t *)errorSQLState).ToLocalChecked());
+    subError->Set(Nan::New("message").ToLocalChecked(), Nan::New((uint16_t *)record->message).ToLocalChecked());
+    subError->Set(Nan::New("state").ToLocalChecked(), Nan::New((uint16_t *)record->state).ToLocalChecked());
 #else
-      subError->Set(Nan::New("message").ToLocalChecked(), Nan::New(errorMessage).ToLocalChecked());
-      subError->Set(Nan::New("state").ToLocalChecked(), Nan::New(errorSQLState).ToLocalChecked());
+    subError->Set(Nan::New("message").ToLocalChecked(), Nan::New(record->message).ToLocalChecked());
+    subError->Set(Nan::New("state").ToLocalChecked(), Nan::New(record->state).ToLocalChecked());
 #endif
-      subError->Set(Nan::New("code").ToLocalChecked(), Nan::New(native));
-      errors->Set(Nan::New(i), subError);
-
-    } else if (ret == SQL_NO_DATA) {
-      break;
-    }
+    subError->Set(Nan::New("code").ToLocalChecked(), Nan::New(record->native));
+    errors->Set(Nan::New(i), subError);
   }
 
-  if (statusRecCount == 0) {
+  if (diagnostics->count == 0) {
     //Create a default error object if there were no diag records
     objError->Set(Nan::New("error").ToLocalChecked(), Nan::New(message).ToLocalChecked());
     objError->SetPrototype(Exception::Error(Nan::New(message).ToLocalChecked()));
@@ -1276,6 +1113,143 @@ Local<Object> ODBC::GetError(const char* message, const char* code, const char*
   return scope.Escape(objError);
 }
 
+/*
+ * CanExecuteAsync
+ *
+ * Drivers that execute asynchronously per statement return
+ * SQL_STILL_EXECUTING from calls on statements with SQL_ATTR_ASYNC_ENABLE
+ * set, and are polled until the call is done.
+ */
+
+bool ODBC::CanExecuteAsync(HDBC hDBC) {
+  SQLUINTEGER mode = SQL_AM_NONE;
+
+  SQLRETURN ret = SQLGetInfo(hDBC, SQL_ASYNC_MODE, &mode, sizeof(mode), NULL);
+
+  return SQL_SUCCEEDED(ret) && mode == SQL_AM_STATEMENT;
+}
+
+void ODBC::SetAsyncEnable(HSTMT hSTMT, bool enable) {
+  SQLSetStmtAttr(
+    hSTMT,
+    SQL_ATTR_ASYNC_ENABLE,
+    (SQLPOINTER) (enable ? SQL_ASYNC_ENABLE_ON : SQL_ASYNC_ENABLE_OFF),
+    SQL_IS_UINTEGER);
+}
+
+void ODBC::SetQueryTimeout(HSTMT hSTMT, SQLULEN seconds) {
+  SQLSetStmtAttr(
+    hSTMT,
+    SQL_ATTR_QUERY_TIMEOUT,
+    (SQLPOINTER) seconds,
+    SQL_IS_UINTEGER);
+}
+
+/*
+ * InitCancelState
+ */
+
+void ODBC::InitCancelState(CancelState* cancel) {
+  uv_mutex_init(&cancel->mutex);
+  uv_cond_init(&cancel->cond);
+
+  cancel->hSTMT = NULL;
+  cancel->isCancelled = false;
+  cancel->isCancelling = false;
+}
+
+void ODBC::FreeCancelState(CancelState* cancel) {
+  uv_cond_destroy(&cancel->cond);
+  uv_mutex_destroy(&cancel->mutex);
+}
+
+/*
+ * BeginExecute
+ *
+ * Called on the worker right before executing. Returns false if the
+ * statement was cancelled before it started, in which case it must not be
+ * executed.
+ */
+
+bool ODBC::BeginExecute(CancelState* cancel, HSTMT hSTMT) {
+  uv_mutex_lock(&cancel->mutex);
+
+  bool isCancelled = cancel->isCancelled;
+
+  if (!isCancelled) {
+    cancel->hSTMT = hSTMT;
+  }
+
+  uv_mutex_unlock(&cancel->mutex);
+
+  return !isCancelled;
+}
+
+/*
+ * EndExecute
+ *
+ * Unpublishes the handle. Waits for a SQLCancel already running on it so
+ * that the handle is not reset or freed under the driver.
+ */
+
+void ODBC::EndExecute(CancelState* cancel) {
+  uv_mutex_lock(&cancel->mutex);
+
+  cancel->hSTMT = NULL;
+
+  while (cancel->isCancelling) {
+    uv_cond_wait(&cancel->cond, &cancel->mutex);
+  }
+
+  uv_mutex_unlock(&cancel->mutex);
+}
+
+/*
+ * IsCancelled
+ */
+
+bool ODBC::IsCancelled(CancelState* cancel) {
+  uv_mutex_lock(&cancel->mutex);
+
+  bool isCancelled = cancel->isCancelled;
+
+  uv_mutex_unlock(&cancel->mutex);
+
+  return isCancelled;
+}
+
+/*
+ * CancelExecute
+ *
+ * Marks the statement cancelled and calls SQLCancel if it is executing.
+ * The worker then gets an error back from the driver, typically HY008.
+ * SQLCancel can block, so it runs without the mutex held; EndExecute waits
+ * for it instead.
+ */
+
+bool ODBC::CancelExecute(CancelState* cancel) {
+  uv_mutex_lock(&cancel->mutex);
+
+  bool wasCancelled = cancel->isCancelled;
+  HSTMT hSTMT = cancel->hSTMT;
+
+  cancel->isCancelled = true;
+  cancel->isCancelling = hSTMT != NULL;
+
+  uv_mutex_unlock(&cancel->mutex);
+
+  if (hSTMT) {
+    SQLCancel(hSTMT);
+
+    uv_mutex_lock(&cancel->mutex);
+    cancel->isCancelling = false;
+    uv_cond_signal(&cancel->cond);
+    uv_mutex_unlock(&cancel->mutex);
+  }
+
+  return !wasCancelled;
+}
+
 /*
  * GetAllRecordsSync
  */
@@ -1301,10 +1275,23 @@ Local<Array> ODBC::GetAllRecordsSync (HENV hENV,
   
   Local<Array> rows = Nan::New<Array>();
   
+  ValueOptions valueOptions = { BIGINT_STRING, DECIMAL_STRING, DATE_STRING, false, LOB_VALUE };
+  RowBatch batch(columns, colCount, maxValueSize, valueChunkSize, valueOptions);
+  RecordShape shape;
+  
+  shape.build(columns, colCount);
+  
   //loop through all records
   while (true) {
+    batch.clear();
+    
     SQLRETURN ret = SQLFetch(hSTMT);
     
+    if (SQL_SUCCEEDED(ret)) {
+      ret = batch.readRow(hSTMT, buffer, bufferLength);
+      ret = SQL_SUCCEEDED(ret) ? SQL_SUCCESS : SQL_ERROR;
+    }
+    
     //check to see if there was an error
     if (ret == SQL_ERROR)  {
       //TODO: what do we do when we actually get an error here...
@@ -1312,8 +1299,7 @@ Local<Array> ODBC::GetAllRecordsSync (HENV hENV,
       
       errorCount++;
       
-      objError = ODBC::GetSQLError(
-        SQL_HANDLE_STMT, 
+      objError = batch.getError(
         hSTMT,
         (char *) "[node-odbc] Error in ODBC::GetAllRecordsSync"
       );
@@ -1330,14 +1316,7 @@ Local<Array> ODBC::GetAllRecordsSync (HENV hENV,
 
     rows->Set(
       Nan::New(count), 
-      ODBC::GetRecordTuple(
-        hSTMT,
-        columns,
-        &colCount,
-        buffer,
-        bufferLength,
-        maxValueSize,
-        valueChunkSize)
+      batch.getRecordTuple(0, &shape)
     );
 
     count++;
@@ -1364,11 +1343,17 @@ extern "C" void init(v8::Handle<Object> exports) {
   exports->Set(Nan::New("loadODBCLibrary").ToLocalChecked(),
         Nan::New<FunctionTemplate>(ODBC::LoadODBCLibrary)->GetFunction());
 #endif
+
+  exports->Set(Nan::New("configureExecutor").ToLocalChecked(),
+        Nan::New<FunctionTemplate>(Executor::Configure)->GetFunction());
+  exports->Set(Nan::New("getExecutorStatsSync").ToLocalChecked(),
+        Nan::New<FunctionTemplate>(Executor::GetStatsSync)->GetFunction());
   
   ODBC::Init(exports);
   ODBCResult::Init(exports);
   ODBCConnection::Init(exports);
   ODBCStatement::Init(exports);
+  ODBCPool::Init(exports);
 }
 
 NODE_MODULE(odbc_bindings, init)
@@ -39,8 +39,27 @@
 using namespace v8;
 using namespace node;
 
+// BigInt and BigInt64Array are available from V8 6.7
+#if V8_MAJOR_VERSION > 6 || (V8_MAJOR_VERSION == 6 && V8_MINOR_VERSION >= 7)
+#define HAVE_BIGINT
+#endif
+
+// BigInt::NewFromWords is available from V8 6.8
+#if V8_MAJOR_VERSION > 6 || (V8_MAJOR_VERSION == 6 && V8_MINOR_VERSION >= 8)
+#define HAVE_BIGINT_WORDS
+#endif
+
 #define MAX_FIELD_SIZE 1024
 #define FIXED_BUFFER_SIZE 1048576
+// Initial buffer size in bytes for column and type names
+#define COLUMN_STRING_SIZE 128
+
+// Column attribute read for the names of result columns
+#ifdef STRICT_COLUMN_NAMES
+#define COLUMN_NAME_FIELD SQL_DESC_NAME
+#else
+#define COLUMN_NAME_FIELD SQL_DESC_LABEL
+#endif
 
 #define MAX_VALUE_SIZE SIZE_MAX
 #define MAX_VALUE_SIZE_DEFAULT MAX_VALUE_SIZE
@@ -48,6 +67,20 @@ using namespace node;
 #define MAX_VALUE_CHUNK_SIZE_DEFAULT 16777216
 #define LONG_DATA_THRESHOLD 8000
 
+// Largest integer that a double represents exactly
+#define MAX_SAFE_INTEGER 9007199254740991LL
+// Largest precision of SQL_NUMERIC_STRUCT
+#define NUMERIC_PRECISION_MAX 38
+
+#define ROWSET_SIZE_DEFAULT 1
+#define ROWSET_SIZE_MAX 65535
+#define CLAMP_ROWSET_SIZE(v) ((v) > 1 ? ((v) < ROWSET_SIZE_MAX ? (size_t)(v) : (size_t)ROWSET_SIZE_MAX) : (size_t)1)
+
+#define BATCH_SIZE_DEFAULT 1000
+#define BATCH_SIZE_MAX 1048576
+#define CLAMP_BATCH_SIZE(v) ((v) > 1 ? ((v) < BATCH_SIZE_MAX ? (size_t)(v) : (size_t)BATCH_SIZE_MAX) : (size_t)1)
+#define MAX_BATCH_BYTES_DEFAULT 4194304
+
 #ifdef UNICODE
 #define ERROR_MESSAGE_BUFFER_BYTES 4096
 #define ERROR_MESSAGE_BUFFER_CHARS 2048
@@ -60,9 +93,40 @@ using namespace node;
 #define MODE_CALLBACK_FOR_EACH 2
 #define FETCH_ARRAY 3
 #define FETCH_OBJECT 4
+#define FETCH_COLUMNAR 5
+#define FETCH_FLAT 6
+
+// How BIGINT values are returned in rows
+#define BIGINT_STRING 0
+#define BIGINT_NUMBER 1
+#define BIGINT_BIGINT 2
+
+// How DECIMAL and NUMERIC values are returned in rows
+#define DECIMAL_STRING 0
+#define DECIMAL_NUMBER 1
+#define DECIMAL_SCALED 2
+
+// How DATE, TIME and TIMESTAMP values are returned in rows
+#define DATE_STRING 0
+#define DATE_UTC 1
+#define DATE_LOCAL 2
+
+// How long data (LONGVARCHAR, WLONGVARCHAR and LONGVARBINARY) is returned by fetch
+#define LOB_VALUE 0
+#define LOB_STREAM 1
+
+// How much of the driver manager is locked around handle allocation, frees
+// and resets. Connecting only ever locks the connection itself.
+#define THREADING_NONE 0
+#define THREADING_CONNECTION 1
+#define THREADING_ENVIRONMENT 2
+#define THREADING_PROCESS 3
+#define THREADING_DEFAULT THREADING_CONNECTION
+
 #define SQL_DESTROY 9999
 
 
+// Name strings point into the allocation made by ODBC::GetColumns
 typedef struct {
   uint8_t *name;
   uint8_t *typeName;
@@ -74,6 +138,15 @@ typedef struct {
   SQLUSMALLINT index;
 } Column;
 
+// Determines how column values are fetched and converted
+typedef struct {
+  int bigintMode;
+  int decimalMode;
+  int dateMode;
+  bool dateFraction;
+  int lobMode;
+} ValueOptions;
+
 typedef struct {
   SQLSMALLINT  ValueType;
   SQLSMALLINT  ParameterType;
@@ -84,6 +157,35 @@ typedef struct {
   SQLLEN       StrLen_or_IndPtr;
 } Parameter;
 
+// Lets the event loop cancel a statement while a worker executes it. The
+// fields are guarded by mutex, which belongs to the one statement so that
+// cancels on different connections never wait on each other.
+typedef struct {
+  uv_mutex_t mutex;
+  uv_cond_t cond;
+  // Set while the statement is executing
+  HSTMT hSTMT;
+  bool isCancelled;
+  // Set while SQLCancel is running on hSTMT
+  bool isCancelling;
+} CancelState;
+
+// A diagnostic record copied from a handle
+typedef struct {
+  char state[14];
+  SQLINTEGER native;
+  char message[ERROR_MESSAGE_BUFFER_BYTES];
+} SQLDiagRecord;
+
+// Diagnostic records read on the thread pool and turned into an error on
+// the event loop with GetSQLError
+typedef struct {
+  SQLDiagRecord *records;
+  int32_t count;
+} SQLDiagnostics;
+
+class HandleLock;
+
 class ODBC : public Nan::ObjectWrap {
   public:
     static Nan::Persistent<Function> constructor;
@@ -93,14 +195,25 @@ class ODBC : public Nan::ObjectWrap {
     static Column* GetColumns(SQLHSTMT hStmt, short* colCount);
     static void FreeColumns(Column* columns, short* colCount);
     static Local<Array> GetColumnMetadata(Column* columns, short* colCount);
-    static Handle<Value> GetColumnValue(SQLHSTMT hStmt, Column column, uint8_t* buffer, int bufferLength, size_t maxValueSize, size_t valueChunkSize);
-    static Local<Value> GetRecordTuple (SQLHSTMT hStmt, Column* columns, short* colCount, uint8_t* buffer, int bufferLength, size_t maxValueSize, size_t valueChunkSize);
-    static Local<Value> GetRecordArray (SQLHSTMT hStmt, Column* columns, short* colCount, uint8_t* buffer, int bufferLength, size_t maxValueSize, size_t valueChunkSize);
     static Handle<Value> CallbackSQLError(SQLSMALLINT handleType, SQLHANDLE handle, Nan::Callback* cb);
     static Local<Value> CallbackSQLError (SQLSMALLINT handleType, SQLHANDLE handle, char* message, Nan::Callback* cb);
     static Local<Object> GetSQLError (SQLSMALLINT handleType, SQLHANDLE handle);
     static Local<Object> GetSQLError (SQLSMALLINT handleType, SQLHANDLE handle, const char* message);
+    static Local<Object> GetSQLError (SQLDiagnostics* diagnostics, const char* message);
     static Local<Object> GetError (const char* message, const char* code = NULL, const char* hint = NULL);
+    // Safe to call from the thread pool
+    static bool CanExecuteAsync(HDBC hDBC);
+    static SQLDiagnostics* ReadSQLDiagnostics(SQLSMALLINT handleType, SQLHANDLE handle);
+    static void FreeSQLDiagnostics(SQLDiagnostics* diagnostics);
+    static void SetAsyncEnable(HSTMT hSTMT, bool enable);
+    static void SetQueryTimeout(HSTMT hSTMT, SQLULEN seconds);
+    static void InitCancelState(CancelState* cancel);
+    static void FreeCancelState(CancelState* cancel);
+    static bool BeginExecute(CancelState* cancel, HSTMT hSTMT);
+    static void EndExecute(CancelState* cancel);
+    static bool IsCancelled(CancelState* cancel);
+    // Event loop only
+    static bool CancelExecute(CancelState* cancel);
     static Local<Array>  GetAllRecordsSync (HENV hENV, HDBC hDBC, HSTMT hSTMT, uint8_t* buffer, int bufferLength, size_t maxValueSize, size_t valueChunkSize);
 #ifdef dynodbc
     static NAN_METHOD(LoadODBCLibrary);
@@ -118,6 +231,9 @@ class ODBC : public Nan::ObjectWrap {
   public:
     static NAN_METHOD(New);
 
+    //Property Getter/Setters
+    static NAN_GETTER(ThreadingGetter);
+
     //async methods
     static NAN_METHOD(CreateConnection);
   protected:
@@ -129,11 +245,14 @@ class ODBC : public Nan::ObjectWrap {
     //sync methods
   public:
     static NAN_METHOD(CreateConnectionSync);
+    static NAN_METHOD(CreatePoolSync);
   protected:
     
     ODBC *self(void) { return this; }
 
     HENV m_hEnv;
+    // Parent of the locks of connections created from this environment
+    HandleLock *m_lock;
 };
 
 struct create_connection_work_data {
@@ -243,6 +362,11 @@ struct query_request {
     return Nan::ThrowTypeError("Argument " #I " invalid");                \
   Local<External> VAR = Local<External>::Cast(info[I]);
 
+#define REQ_OBJ_ARG(I, VAR)                                             \
+  if (info.Length() <= (I) || !info[I]->IsObject())                     \
+    return Nan::ThrowTypeError("Argument " #I " must be an object");      \
+  Local<Object> VAR = Local<Object>::Cast(info[I]);
+
 #define OPT_INT_ARG(I, VAR, DEFAULT)                                    \
   int VAR;                                                              \
   if (info.Length() <= (I)) {                                           \
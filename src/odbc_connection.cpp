@@ -29,6 +29,8 @@
 #include "odbc_connection.h"
 #include "odbc_result.h"
 #include "odbc_statement.h"
+#include "odbc_pool.h"
+#include "executor.h"
 
 using namespace v8;
 using namespace node;
@@ -37,6 +39,7 @@ Nan::Persistent<Function> ODBCConnection::constructor;
 Nan::Persistent<String> ODBCConnection::OPTION_SQL;
 Nan::Persistent<String> ODBCConnection::OPTION_PARAMS;
 Nan::Persistent<String> ODBCConnection::OPTION_NORESULTS;
+Nan::Persistent<String> ODBCConnection::OPTION_TIMEOUT;
 
 void ODBCConnection::Init(v8::Handle<Object> exports) {
   DEBUG_PRINTF("ODBCConnection::Init\n");
@@ -45,6 +48,7 @@ void ODBCConnection::Init(v8::Handle<Object> exports) {
   OPTION_SQL.Reset(Nan::New<String>("sql").ToLocalChecked());
   OPTION_PARAMS.Reset(Nan::New<String>("params").ToLocalChecked());
   OPTION_NORESULTS.Reset(Nan::New<String>("noResults").ToLocalChecked());
+  OPTION_TIMEOUT.Reset(Nan::New<String>("timeout").ToLocalChecked());
 
   Local<FunctionTemplate> constructor_template = Nan::New<FunctionTemplate>(New);
 
@@ -60,6 +64,11 @@ void ODBCConnection::Init(v8::Handle<Object> exports) {
   Nan::SetAccessor(instance_template, Nan::New("connected").ToLocalChecked(), ConnectedGetter);
   Nan::SetAccessor(instance_template, Nan::New("connectTimeout").ToLocalChecked(), ConnectTimeoutGetter, ConnectTimeoutSetter);
   Nan::SetAccessor(instance_template, Nan::New("loginTimeout").ToLocalChecked(), LoginTimeoutGetter, LoginTimeoutSetter);
+  Nan::SetAccessor(instance_template, Nan::New("metadataCacheSize").ToLocalChecked(), MetadataCacheSizeGetter, MetadataCacheSizeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("statementCacheSize").ToLocalChecked(), StatementCacheSizeGetter, StatementCacheSizeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("statementFreeListSize").ToLocalChecked(), StatementFreeListSizeGetter, StatementFreeListSizeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("asyncExecution").ToLocalChecked(), AsyncExecutionGetter, AsyncExecutionSetter);
+  Nan::SetAccessor(instance_template, Nan::New("_stillExecutingPolls").ToLocalChecked(), StillExecutingPollsGetter, StillExecutingPollsSetter);
   
   // Prototype Methods
   Nan::SetPrototypeMethod(constructor_template, "open", Open);
@@ -75,6 +84,12 @@ void ODBCConnection::Init(v8::Handle<Object> exports) {
   Nan::SetPrototypeMethod(constructor_template, "beginTransactionSync", BeginTransactionSync);
   Nan::SetPrototypeMethod(constructor_template, "endTransaction", EndTransaction);
   Nan::SetPrototypeMethod(constructor_template, "endTransactionSync", EndTransactionSync);
+
+  Nan::SetPrototypeMethod(constructor_template, "getMetadataCacheStatsSync", GetMetadataCacheStatsSync);
+  Nan::SetPrototypeMethod(constructor_template, "clearMetadataCacheSync", ClearMetadataCacheSync);
+  Nan::SetPrototypeMethod(constructor_template, "getStatementCacheStatsSync", GetStatementCacheStatsSync);
+  Nan::SetPrototypeMethod(constructor_template, "clearStatementCacheSync", ClearStatementCacheSync);
+  Nan::SetPrototypeMethod(constructor_template, "cancelSync", CancelSync);
   
   Nan::SetPrototypeMethod(constructor_template, "columns", Columns);
   Nan::SetPrototypeMethod(constructor_template, "tables", Tables);
@@ -86,24 +101,68 @@ void ODBCConnection::Init(v8::Handle<Object> exports) {
 
 ODBCConnection::~ODBCConnection() {
   DEBUG_PRINTF("ODBCConnection::~ODBCConnection\n");
+
+  if (m_pool) {
+    this->Release();
+  }
+
+  //cached statements must be freed before disconnecting
+  m_statementCache->clear();
+  m_statementCache->unref();
+
   this->Free();
+
+  m_lock->unref();
 }
 
 void ODBCConnection::Free() {
   DEBUG_PRINTF("ODBCConnection::Free\n");
   if (m_hDBC) {
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+    //disconnecting only locks this connection
+    m_lock->lockHandle();
     
-    if (m_hDBC) {
-      SQLDisconnect(m_hDBC);
-      SQLFreeHandle(SQL_HANDLE_DBC, m_hDBC);
-      m_hDBC = NULL;
+    HDBC hDBC = m_hDBC;
+    m_hDBC = NULL;
+
+    if (hDBC) {
+      SQLDisconnect(hDBC);
     }
     
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    m_lock->unlockHandle();
+
+    //the connection handle belongs to the environment
+    if (hDBC) {
+      m_lock->parent()->lock();
+
+      SQLFreeHandle(SQL_HANDLE_DBC, hDBC);
+
+      m_lock->parent()->unlock();
+    }
   }
 }
 
+void ODBCConnection::Release() {
+  DEBUG_PRINTF("ODBCConnection::Release\n");
+  ODBCPool* pool = m_pool;
+
+  PooledHandle handle;
+  handle.hDBC = m_hDBC;
+  handle.canHaveMoreResults = canHaveMoreResults;
+  handle.lock = m_lock;
+  handle.cache = m_statementCache;
+
+  m_pool = NULL;
+  m_hDBC = NULL;
+
+  //the prepared statements stay with the handle, and the pool takes over
+  //the reference to them
+  m_statementCache = new StatementCache(m_lock);
+  m_statementCache->ref();
+
+  pool->release(&handle, inTransaction);
+  pool->Unref();
+}
+
 /*
  * New
  */
@@ -121,12 +180,45 @@ NAN_METHOD(ODBCConnection::New) {
   ODBCConnection* conn = new ODBCConnection(hENV, hDBC);
   
   conn->Wrap(info.Holder());
+
+  //the connection locks at the threading level of its environment, or
+  //across the process if created without one
+  HandleLock* envLock = NULL;
+
+  if (info.Length() > 2 && info[2]->IsExternal()) {
+    envLock = static_cast<HandleLock *>(info[2].As<External>()->Value());
+  }
+
+  //a pooled connection keeps its lock and prepared statements between
+  //leases
+  if (info.Length() > 3 && info[3]->IsExternal()) {
+    conn->m_lock = static_cast<HandleLock *>(info[3].As<External>()->Value());
+  } else {
+    conn->m_lock = new HandleLock(envLock ? envLock->threading() : THREADING_PROCESS, envLock);
+  }
+
+  conn->m_lock->ref();
   
   //set default connectTimeout to 0 seconds
   conn->connectTimeout = 0;
   //set default loginTimeout to 5 seconds
   conn->loginTimeout = 5;
 
+  if (info.Length() > 4 && info[4]->IsExternal()) {
+    conn->m_statementCache = static_cast<StatementCache *>(info[4].As<External>()->Value());
+  } else {
+    conn->m_statementCache = new StatementCache(conn->m_lock);
+  }
+
+  conn->m_statementCache->ref();
+
+  conn->m_pool = NULL;
+  conn->inTransaction = false;
+  conn->asyncExecution = false;
+  conn->m_asyncMode = -1;
+  conn->m_nextQueryId = 1;
+  conn->m_stillExecutingPolls = 0;
+
   info.GetReturnValue().Set(info.Holder());
 }
 
@@ -174,6 +266,115 @@ NAN_SETTER(ODBCConnection::LoginTimeoutSetter) {
   }
 }
 
+NAN_GETTER(ODBCConnection::MetadataCacheSizeGetter) {
+  Nan::HandleScope scope;
+
+  ODBCConnection *obj = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double) obj->m_metadataCache.capacity()));
+}
+
+NAN_SETTER(ODBCConnection::MetadataCacheSizeSetter) {
+  Nan::HandleScope scope;
+
+  ODBCConnection *obj = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+  
+  if (value->IsNumber()) {
+    obj->m_metadataCache.setCapacity(value->Uint32Value());
+  }
+}
+
+NAN_GETTER(ODBCConnection::StatementCacheSizeGetter) {
+  Nan::HandleScope scope;
+
+  ODBCConnection *obj = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double) obj->m_statementCache->capacity()));
+}
+
+NAN_SETTER(ODBCConnection::StatementCacheSizeSetter) {
+  Nan::HandleScope scope;
+
+  ODBCConnection *obj = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+  
+  if (value->IsNumber()) {
+    obj->m_statementCache->setCapacity(value->Uint32Value());
+  }
+}
+
+NAN_GETTER(ODBCConnection::StatementFreeListSizeGetter) {
+  Nan::HandleScope scope;
+
+  ODBCConnection *obj = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double) obj->m_statementCache->freeListSize()));
+}
+
+NAN_SETTER(ODBCConnection::StatementFreeListSizeSetter) {
+  Nan::HandleScope scope;
+
+  ODBCConnection *obj = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+  
+  if (value->IsNumber()) {
+    obj->m_statementCache->setFreeListSize(value->Uint32Value());
+  }
+}
+
+NAN_GETTER(ODBCConnection::AsyncExecutionGetter) {
+  Nan::HandleScope scope;
+
+  ODBCConnection *obj = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+
+  info.GetReturnValue().Set(obj->asyncExecution ? Nan::True() : Nan::False());
+}
+
+NAN_SETTER(ODBCConnection::AsyncExecutionSetter) {
+  Nan::HandleScope scope;
+
+  ODBCConnection *obj = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+
+  if (value->IsBoolean()) {
+    obj->asyncExecution = value->BooleanValue();
+  }
+}
+
+NAN_GETTER(ODBCConnection::StillExecutingPollsGetter) {
+  Nan::HandleScope scope;
+
+  ODBCConnection *obj = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>(obj->m_stillExecutingPolls));
+}
+
+NAN_SETTER(ODBCConnection::StillExecutingPollsSetter) {
+  Nan::HandleScope scope;
+
+  ODBCConnection *obj = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_stillExecutingPolls = value->Uint32Value();
+  }
+}
+
+/*
+ * canExecuteAsync
+ *
+ * Whether queries are executed asynchronously: asyncExecution is set and
+ * the driver supports it. The driver is asked once it is connected.
+ */
+
+bool ODBCConnection::canExecuteAsync() {
+  if (!this->asyncExecution || !this->connected) {
+    return false;
+  }
+
+  if (this->m_asyncMode < 0) {
+    this->m_asyncMode = ODBC::CanExecuteAsync(this->m_hDBC) ? 1 : 0;
+  }
+
+  return this->m_asyncMode == 1;
+}
+
 /*
  * Open
  * 
@@ -214,10 +415,11 @@ NAN_METHOD(ODBCConnection::Open) {
   work_req->data = data;
   
   //queue the work
-  uv_queue_work(uv_default_loop(), 
+  Executor::QueueWork(uv_default_loop(), 
     work_req, 
     UV_Open, 
-    (uv_after_work_cb)UV_AfterOpen);
+    (uv_after_work_cb)UV_AfterOpen,
+    data->conn->m_lock);
 
   conn->Ref();
 
@@ -232,10 +434,11 @@ void ODBCConnection::UV_Open(uv_work_t* req) {
 
   DEBUG_PRINTF("ODBCConnection::UV_Open : connectTimeout=%i, loginTimeout = %i\n", *&(self->connectTimeout), *&(self->loginTimeout));
   
-  uv_mutex_lock(&ODBC::g_odbcMutex); 
+  //connecting only locks this connection, so a slow login does not block
+  //other connections
+  self->m_lock->lockHandle();
   
   if (self->connectTimeout > 0) {
-    //NOTE: SQLSetConnectAttr requires the thread to be locked
     SQLSetConnectAttr(
       self->m_hDBC,                              //ConnectionHandle
       SQL_ATTR_CONNECTION_TIMEOUT,               //Attribute
@@ -244,7 +447,6 @@ void ODBCConnection::UV_Open(uv_work_t* req) {
   }
   
   if (self->loginTimeout > 0) {
-    //NOTE: SQLSetConnectAttr requires the thread to be locked
     SQLSetConnectAttr(
       self->m_hDBC,                            //ConnectionHandle
       SQL_ATTR_LOGIN_TIMEOUT,                  //Attribute
@@ -253,7 +455,6 @@ void ODBCConnection::UV_Open(uv_work_t* req) {
   }
   
   //Attempt to connect
-  //NOTE: SQLDriverConnect requires the thread to be locked
   int ret = SQLDriverConnect(
     self->m_hDBC,                   //ConnectionHandle
     NULL,                           //WindowHandle
@@ -265,27 +466,20 @@ void ODBCConnection::UV_Open(uv_work_t* req) {
     SQL_DRIVER_NOPROMPT);           //DriverCompletion
   
   if (SQL_SUCCEEDED(ret)) {
-    HSTMT hStmt;
-    
-    //allocate a temporary statment
-    ret = SQLAllocHandle(SQL_HANDLE_STMT, self->m_hDBC, &hStmt);
-    
     //try to determine if the driver can handle
     //multiple recordsets
-    ret = SQLGetFunctions(
+    if (!SQL_SUCCEEDED(SQLGetFunctions(
       self->m_hDBC,
       SQL_API_SQLMORERESULTS, 
-      &(self->canHaveMoreResults));
-
-    if (!SQL_SUCCEEDED(ret)) {
+      &(self->canHaveMoreResults)))) {
       self->canHaveMoreResults = 0;
     }
-    
-    //free the handle
-    ret = SQLFreeHandle( SQL_HANDLE_STMT, hStmt);
+
+    //informational messages from connecting are not errors
+    ret = SQL_SUCCESS;
   }
 
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  self->m_lock->unlockHandle();
   
   data->result = ret;
 }
@@ -357,10 +551,11 @@ NAN_METHOD(ODBCConnection::OpenSync) {
   connection->WriteUtf8(connectionString);
 #endif
   
-  uv_mutex_lock(&ODBC::g_odbcMutex);
+  //connecting only locks this connection, so a slow login does not block
+  //other connections
+  conn->m_lock->lockHandle();
   
   if (conn->connectTimeout > 0) {
-    //NOTE: SQLSetConnectAttr requires the thread to be locked
     SQLSetConnectAttr(
       conn->m_hDBC,                              //ConnectionHandle
       SQL_ATTR_CONNECTION_TIMEOUT,               //Attribute
@@ -369,7 +564,6 @@ NAN_METHOD(ODBCConnection::OpenSync) {
   }
 
   if (conn->loginTimeout > 0) {
-    //NOTE: SQLSetConnectAttr requires the thread to be locked
     SQLSetConnectAttr(
       conn->m_hDBC,                            //ConnectionHandle
       SQL_ATTR_LOGIN_TIMEOUT,                  //Attribute
@@ -378,7 +572,6 @@ NAN_METHOD(ODBCConnection::OpenSync) {
   }
   
   //Attempt to connect
-  //NOTE: SQLDriverConnect requires the thread to be locked
   ret = SQLDriverConnect(
     conn->m_hDBC,                   //ConnectionHandle
     NULL,                           //WindowHandle
@@ -395,11 +588,6 @@ NAN_METHOD(ODBCConnection::OpenSync) {
     objError = ODBC::GetSQLError(SQL_HANDLE_DBC, conn->self()->m_hDBC);
   }
   else {
-    HSTMT hStmt;
-    
-    //allocate a temporary statment
-    ret = SQLAllocHandle(SQL_HANDLE_STMT, conn->m_hDBC, &hStmt);
-    
     //try to determine if the driver can handle
     //multiple recordsets
     ret = SQLGetFunctions(
@@ -410,14 +598,11 @@ NAN_METHOD(ODBCConnection::OpenSync) {
     if (!SQL_SUCCEEDED(ret)) {
       conn->canHaveMoreResults = 0;
     }
-  
-    //free the handle
-    ret = SQLFreeHandle( SQL_HANDLE_STMT, hStmt);
     
     conn->self()->connected = true;
   }
 
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  conn->m_lock->unlockHandle();
 
   free(connectionString);
   
@@ -451,12 +636,19 @@ NAN_METHOD(ODBCConnection::Close) {
   data->conn = conn;
 
   work_req->data = data;
+
+  //cached statements must be freed before disconnecting, but stay with a
+  //pooled connection
+  if (!conn->m_pool) {
+    conn->m_statementCache->clear();
+  }
   
-  uv_queue_work(
+  Executor::QueueWork(
     uv_default_loop(),
     work_req,
     UV_Close,
-    (uv_after_work_cb)UV_AfterClose);
+    (uv_after_work_cb)UV_AfterClose,
+    data->conn->m_lock);
 
   conn->Ref();
 
@@ -471,7 +663,10 @@ void ODBCConnection::UV_Close(uv_work_t* req) {
   //TODO: check to see if there are any open statements
   //on this connection
   
-  conn->Free();
+  //pooled connections are reset and kept connected by the pool
+  if (!conn->m_pool) {
+    conn->Free();
+  }
   
   data->result = 0;
 }
@@ -492,7 +687,12 @@ void ODBCConnection::UV_AfterClose(uv_work_t* req, int status) {
     argv[0] = Exception::Error(Nan::New("Error closing database").ToLocalChecked());
   }
   else {
+    if (conn->m_pool) {
+      conn->Release();
+    }
+
     conn->connected = false;
+    conn->m_metadataCache.clear();
   }
 
   Nan::TryCatch try_catch;
@@ -523,9 +723,15 @@ NAN_METHOD(ODBCConnection::CloseSync) {
   //TODO: check to see if there are any open statements
   //on this connection
   
+  if (conn->m_pool) {
+    conn->Release();
+  }
+
+  conn->m_statementCache->clear();
   conn->Free();
   
   conn->connected = false;
+  conn->m_metadataCache.clear();
 
   info.GetReturnValue().Set(Nan::True());
 }
@@ -542,22 +748,20 @@ NAN_METHOD(ODBCConnection::CreateStatementSync) {
   ODBCConnection* conn = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
    
   HSTMT hSTMT;
+  StatementLease* lease = conn->m_statementCache->acquire(std::string());
 
-  uv_mutex_lock(&ODBC::g_odbcMutex);
-  
-  SQLAllocHandle(
-    SQL_HANDLE_STMT, 
-    conn->m_hDBC, 
-    &hSTMT);
-  
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  //reuse a recycled statment handle, or allocate a new one
+  conn->m_statementCache->allocHandle(conn->m_hDBC, lease, &hSTMT);
   
-  Local<Value> params[3];
+  Local<Value> params[5];
   params[0] = Nan::New<External>(conn->m_hENV);
   params[1] = Nan::New<External>(conn->m_hDBC);
   params[2] = Nan::New<External>(hSTMT);
+  params[3] = Nan::New<External>(lease);
+  params[4] = Nan::New<External>(conn->m_lock);
   
-  Local<Object> js_result(Nan::New<Function>(ODBCStatement::constructor)->NewInstance(3, params));
+  //the statement takes the lease and recycles the handle when it is freed
+  Local<Object> js_result(Nan::New<Function>(ODBCStatement::constructor)->NewInstance(5, params));
   
   info.GetReturnValue().Set(js_result);
 }
@@ -584,14 +788,16 @@ NAN_METHOD(ODBCConnection::CreateStatement) {
 
   data->cb = new Nan::Callback(cb);
   data->conn = conn;
+  data->lease = conn->m_statementCache->acquire(std::string());
 
   work_req->data = data;
   
-  uv_queue_work(
+  Executor::QueueWork(
     uv_default_loop(), 
     work_req, 
     UV_CreateStatement, 
-    (uv_after_work_cb)UV_AfterCreateStatement);
+    (uv_after_work_cb)UV_AfterCreateStatement,
+    data->conn->m_lock);
 
   conn->Ref();
 
@@ -611,14 +817,8 @@ void ODBCConnection::UV_CreateStatement(uv_work_t* req) {
   //  data->hSTMT
   //);
   
-  uv_mutex_lock(&ODBC::g_odbcMutex);
-  
-  //allocate a new statment handle
-  SQLAllocHandle( SQL_HANDLE_STMT, 
-                  data->conn->m_hDBC, 
-                  &data->hSTMT);
-
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  //reuse a recycled statment handle, or allocate a new one
+  data->conn->m_statementCache->allocHandle(data->conn->m_hDBC, data->lease, &data->hSTMT);
   
   DEBUG_PRINTF("ODBCConnection::UV_CreateStatement\n");
   //DEBUG_PRINTF("ODBCConnection::UV_CreateStatement m_hDBC=%X m_hDBC=%X m_hSTMT=%X\n",
@@ -641,12 +841,15 @@ void ODBCConnection::UV_AfterCreateStatement(uv_work_t* req, int status) {
   //  data->hSTMT
   //);
   
-  Local<Value> info[3];
+  Local<Value> info[5];
   info[0] = Nan::New<External>(data->conn->m_hENV);
   info[1] = Nan::New<External>(data->conn->m_hDBC);
   info[2] = Nan::New<External>(data->hSTMT);
+  info[3] = Nan::New<External>(data->lease);
+  info[4] = Nan::New<External>(data->conn->m_lock);
   
-  Local<Value> js_result = Nan::New<Function>(ODBCStatement::constructor)->NewInstance(3, info);
+  //the statement takes the lease and recycles the handle when it is freed
+  Local<Value> js_result = Nan::New<Function>(ODBCStatement::constructor)->NewInstance(5, info);
 
   info[0] = Nan::Null();
   info[1] = js_result;
@@ -772,6 +975,11 @@ NAN_METHOD(ODBCConnection::Query) {
       else {
         data->noResultObject = false;
       }
+
+      Local<String> optionTimeoutKey = Nan::New(OPTION_TIMEOUT);
+      if (obj->Has(optionTimeoutKey) && obj->Get(optionTimeoutKey)->IsNumber()) {
+        data->timeout = obj->Get(optionTimeoutKey)->Uint32Value();
+      }
     }
     else {
       return Nan::ThrowTypeError("ODBCConnection::Query(): Argument 0 must be a String or an Object.");
@@ -798,76 +1006,222 @@ NAN_METHOD(ODBCConnection::Query) {
 
   DEBUG_PRINTF("ODBCConnection::Query : sqlLen=%i, sqlSize=%i, sql=%s\n",
                data->sqlLen, data->sqlSize, (char*) data->sql);
+
+  std::string key = MetadataCache::GetKey(data->sql, data->sqlLen);
+
+  if (!data->noResultObject) {
+    data->cachedShape = conn->m_metadataCache.get(key);
+  }
+
+  data->lease = conn->m_statementCache->acquire(key);
   
   data->conn = conn;
+  data->isAsync = conn->canExecuteAsync();
   work_req->data = data;
+
+  //the test hook polls whether or not the driver can execute asynchronously
+  data->stillExecutingPolls = conn->m_stillExecutingPolls;
+
+  if (data->stillExecutingPolls) {
+    data->isAsync = true;
+  }
+
+  ODBC::InitCancelState(&data->cancel);
+
+  //0 is never an id
+  data->id = conn->m_nextQueryId++;
+  if (conn->m_nextQueryId == 0) {
+    conn->m_nextQueryId = 1;
+  }
+
+  conn->m_queries[data->id] = data;
   
-  uv_queue_work(
-    uv_default_loop(),
-    work_req, 
-    UV_Query, 
-    (uv_after_work_cb)UV_AfterQuery);
+  if (data->isAsync) {
+    Executor::QueuePoll(
+      uv_default_loop(),
+      work_req,
+      UV_QueryPoll,
+      (uv_after_work_cb)UV_AfterQuery,
+      data->conn->m_lock);
+  }
+  else {
+    Executor::QueueWork(
+      uv_default_loop(),
+      work_req, 
+      UV_Query, 
+      (uv_after_work_cb)UV_AfterQuery,
+      data->conn->m_lock);
+  }
 
   conn->Ref();
 
-  info.GetReturnValue().Set(Nan::Undefined());
+  info.GetReturnValue().Set(Nan::New<Number>(data->id));
 }
 
 void ODBCConnection::UV_Query(uv_work_t* req) {
   DEBUG_PRINTF("ODBCConnection::UV_Query\n");
-  
+
+  UV_QueryPoll(req);
+}
+
+/*
+ * UV_QueryPoll
+ *
+ * Prepares and binds on the first call. With isAsync, only the execute runs
+ * with SQL_ATTR_ASYNC_ENABLE set, and the work is called again while the
+ * driver is still executing. A query cancelled before it executes fails
+ * without executing. stillExecutingPolls stands in for a driver that keeps
+ * executing, for tests.
+ */
+
+bool ODBCConnection::UV_QueryPoll(uv_work_t* req) {
   query_work_data* data = (query_work_data *)(req->data);
   
   Parameter prm;
   SQLRETURN ret;
-  
-  uv_mutex_lock(&ODBC::g_odbcMutex);
 
-  //allocate a new statment handle
-  SQLAllocHandle( SQL_HANDLE_STMT, 
-                  data->conn->m_hDBC, 
-                  &data->hSTMT );
+  if (!data->isExecuting) {
+    //reuse a leased statment handle, or allocate a new one
+    data->conn->m_statementCache->allocHandle(data->conn->m_hDBC, data->lease, &data->hSTMT);
 
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+    //a cached statement is prepared once, then only bound and executed
+    bool isCached = data->lease && data->lease->isCached;
 
-  // SQLExecDirect will use bound parameters, but without the overhead of SQLPrepare
-  // for a single execution.
-  if (data->paramCount) {
-    for (int i = 0; i < data->paramCount; i++) {
-      prm = data->params[i];
+    if (isCached && !data->lease->isPrepared) {
+      ret = SQLPrepare(
+        data->hSTMT,
+        (SQLTCHAR *)data->sql,
+        data->sqlLen);
 
+      if (ret == SQL_ERROR) {
+        return UV_QueryError(data);
+      }
+    }
 
-      /*DEBUG_TPRINTF(
-        SQL_T("ODBCConnection::UV_Query - param[%i]: ValueType=%i type=%i BufferLength=%i size=%i length=%i &length=%X\n"), i, prm.ValueType, prm.ParameterType,
-        prm.BufferLength, prm.ColumnSize, prm.length, &data->params[i].length);*/
+    // SQLExecDirect will use bound parameters, but without the overhead of SQLPrepare
+    // for a single execution.
+    if (data->paramCount) {
+      for (int i = 0; i < data->paramCount; i++) {
+        prm = data->params[i];
 
-      ret = SQLBindParameter(
-        data->hSTMT,                        //StatementHandle
-        i + 1,                              //ParameterNumber
-        SQL_PARAM_INPUT,                    //InputOutputType
-        prm.ValueType,
-        prm.ParameterType,
-        prm.ColumnSize,
-        prm.DecimalDigits,
-        prm.ParameterValuePtr,
-        prm.BufferLength,
-        &data->params[i].StrLen_or_IndPtr);
 
-      if (ret == SQL_ERROR) {
-        data->result = ret;
-        return;
+        /*DEBUG_TPRINTF(
+          SQL_T("ODBCConnection::UV_Query - param[%i]: ValueType=%i type=%i BufferLength=%i size=%i length=%i &length=%X\n"), i, prm.ValueType, prm.ParameterType,
+          prm.BufferLength, prm.ColumnSize, prm.length, &data->params[i].length);*/
+
+        ret = SQLBindParameter(
+          data->hSTMT,                        //StatementHandle
+          i + 1,                              //ParameterNumber
+          SQL_PARAM_INPUT,                    //InputOutputType
+          prm.ValueType,
+          prm.ParameterType,
+          prm.ColumnSize,
+          prm.DecimalDigits,
+          prm.ParameterValuePtr,
+          prm.BufferLength,
+          &data->params[i].StrLen_or_IndPtr);
+
+        if (ret == SQL_ERROR) {
+          return UV_QueryError(data);
+        }
       }
     }
+
+    if (data->timeout) {
+      ODBC::SetQueryTimeout(data->hSTMT, data->timeout);
+    }
+
+    if (!ODBC::BeginExecute(&data->cancel, data->hSTMT)) {
+      return UV_QueryError(data);
+    }
+
+    if (data->isAsync) {
+      ODBC::SetAsyncEnable(data->hSTMT, true);
+    }
+
+    data->isExecuting = true;
+  }
+
+  if (data->stillExecutingPolls && ODBC::IsCancelled(&data->cancel)) {
+    //fails as a driver does on the poll after SQLCancel
+    ret = SQL_ERROR;
+  }
+  else if (data->stillExecutingPolls) {
+    data->stillExecutingPolls--;
+    ret = SQL_STILL_EXECUTING;
+  }
+  else if (data->lease && data->lease->isCached) {
+    ret = SQLExecute(data->hSTMT);
+  }
+  else {
+    // execute the query directly
+    ret = SQLExecDirect(
+      data->hSTMT,
+      (SQLTCHAR *)data->sql,
+      data->sqlLen);
+  }
+
+  if (data->isAsync && ret == SQL_STILL_EXECUTING) {
+    return false;
   }
 
-  // execute the query directly
-  ret = SQLExecDirect(
-    data->hSTMT,
-    (SQLTCHAR *)data->sql,
-    data->sqlLen);
+  ODBC::EndExecute(&data->cancel);
+
+  if (ret == SQL_ERROR) {
+    return UV_QueryError(data);
+  }
+
+  ResetQueryAttributes(data);
+
+  //describe the result set here rather than on the event loop
+  if (SQL_SUCCEEDED(ret) && !data->noResultObject) {
+    data->shape = ResultShape::Describe(data->hSTMT, data->cachedShape);
+  }
 
   // this will be checked later in UV_AfterQuery
   data->result = ret;
+
+  return true;
+}
+
+/*
+ * UV_QueryError
+ *
+ * Fails the query. Setting attributes clears the diagnostics, so they are
+ * read into the work data first and turned into an error in UV_AfterQuery.
+ */
+
+bool ODBCConnection::UV_QueryError(query_work_data* data) {
+  if (data->hSTMT) {
+    data->diagnostics = ODBC::ReadSQLDiagnostics(SQL_HANDLE_STMT, data->hSTMT);
+  }
+
+  ResetQueryAttributes(data);
+
+  data->result = SQL_ERROR;
+
+  return true;
+}
+
+/*
+ * ResetQueryAttributes
+ *
+ * Turns off what UV_QueryPoll turned on for the execute, so that the result
+ * fetches synchronously and a leased handle is reused without a timeout.
+ */
+
+void ODBCConnection::ResetQueryAttributes(query_work_data* data) {
+  if (!data->hSTMT) {
+    return;
+  }
+
+  if (data->isAsync && data->isExecuting) {
+    ODBC::SetAsyncEnable(data->hSTMT, false);
+  }
+
+  if (data->timeout) {
+    ODBC::SetQueryTimeout(data->hSTMT, 0);
+  }
 }
 
 void ODBCConnection::UV_AfterQuery(uv_work_t* req, int status) {
@@ -881,16 +1235,23 @@ void ODBCConnection::UV_AfterQuery(uv_work_t* req, int status) {
 
   DEBUG_PRINTF("ODBCConnection::UV_AfterQuery : data->result=%i, data->noResultObject=%i\n", data->result, data->noResultObject);
 
+  data->conn->m_queries.erase(data->id);
+
   if (data->result != SQL_ERROR && data->noResultObject) {
     //We have been requested to not create a result object
     //this means we should release the handle now and call back
     //with Nan::True()
     
-    uv_mutex_lock(&ODBC::g_odbcMutex);
-    
-    SQLFreeHandle(SQL_HANDLE_STMT, data->hSTMT);
-   
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    if (data->lease) {
+      data->conn->m_statementCache->release(data->lease);
+    }
+    else {
+      data->conn->m_lock->lock();
+      
+      SQLFreeHandle(SQL_HANDLE_STMT, data->hSTMT);
+     
+      data->conn->m_lock->unlock();
+    }
     
     Local<Value> info[2];
     info[0] = Nan::Null();
@@ -899,22 +1260,42 @@ void ODBCConnection::UV_AfterQuery(uv_work_t* req, int status) {
     data->cb->Call(2, info);
   }
   else {
-    Local<Value> info[4];
+    Local<Value> info[7];
     bool* canFreeHandle = new bool(true);
+
+    //a statement that failed is not cached again
+    if (data->lease && data->result == SQL_ERROR) {
+      data->lease->isReusable = false;
+    }
     
     info[0] = Nan::New<External>(data->conn->m_hENV);
     info[1] = Nan::New<External>(data->conn->m_hDBC);
     info[2] = Nan::New<External>(data->hSTMT);
     info[3] = Nan::New<External>(canFreeHandle);
+    info[4] = Nan::New<External>(data->shape);
+    info[5] = Nan::New<External>(data->lease);
+    info[6] = Nan::New<External>(data->conn->m_lock);
     
-    Local<Object> js_result = Nan::New<Function>(ODBCResult::constructor)->NewInstance(4, info);
+    //the result takes the lease and returns the statement when it is freed
+    Local<Object> js_result = Nan::New<Function>(ODBCResult::constructor)->NewInstance(7, info);
+
+    data->conn->m_metadataCache.update(
+      MetadataCache::GetKey(data->sql, data->sqlLen),
+      data->cachedShape,
+      data->shape,
+      data->result == SQL_ERROR);
 
     // Check now to see if there was an error (as there may be further result sets)
-    if (data->result == SQL_ERROR) {
+    if (data->result == SQL_ERROR && data->cancel.isCancelled) {
+      info[0] = ODBC::GetError("[node-odbc] Query was cancelled", "ECANCELED", "[node-odbc] Error in ODBCConnection::UV_AfterQuery");
+    } else if (data->result == SQL_ERROR && data->diagnostics) {
+      info[0] = ODBC::GetSQLError(data->diagnostics, (char *) "[node-odbc] SQL_ERROR");
+    } else if (data->result == SQL_ERROR) {
       info[0] = ODBC::GetSQLError(SQL_HANDLE_STMT, data->hSTMT, (char *) "[node-odbc] SQL_ERROR");
     } else {
         info[0] = Nan::Null();
     }
+
     info[1] = js_result;
     
     data->cb->Call(2, info);
@@ -952,6 +1333,8 @@ void ODBCConnection::UV_AfterQuery(uv_work_t* req, int status) {
   free(data->table);
   free(data->type);
   free(data->column);
+  ODBC::FreeCancelState(&data->cancel);
+  ODBC::FreeSQLDiagnostics(data->diagnostics);
   free(data);
   free(req);
 }
@@ -979,6 +1362,7 @@ NAN_METHOD(ODBCConnection::QuerySync) {
   HSTMT hSTMT;
   int paramCount = 0;
   bool noResultObject = false;
+  SQLULEN timeout = 0;
   
   //Check arguments for different variations of calling this function
   if (info.Length() == 2) {
@@ -1053,6 +1437,11 @@ NAN_METHOD(ODBCConnection::QuerySync) {
       if (obj->Has(optionNoResultsKey) && obj->Get(optionNoResultsKey)->IsBoolean()) {
         noResultObject = obj->Get(optionNoResultsKey)->ToBoolean()->Value();
       }
+
+      Local<String> optionTimeoutKey = Nan::New(OPTION_TIMEOUT);
+      if (obj->Has(optionTimeoutKey) && obj->Get(optionTimeoutKey)->IsNumber()) {
+        timeout = obj->Get(optionTimeoutKey)->Uint32Value();
+      }
     }
     else {
       return Nan::ThrowTypeError("ODBCConnection::QuerySync(): Argument 0 must be a String or an Object.");
@@ -1063,19 +1452,26 @@ NAN_METHOD(ODBCConnection::QuerySync) {
   }
   //Done checking arguments
 
-  uv_mutex_lock(&ODBC::g_odbcMutex);
+  std::string key = MetadataCache::GetKey(**sql, sql->length());
+  StatementLease* lease = conn->m_statementCache->acquire(key);
 
-  //allocate a new statment handle
-  ret = SQLAllocHandle( SQL_HANDLE_STMT, 
-                  conn->m_hDBC, 
-                  &hSTMT );
+  bool isCached = lease && lease->isCached;
 
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  //reuse a leased statment handle, or allocate a new one
+  ret = conn->m_statementCache->allocHandle(conn->m_hDBC, lease, &hSTMT);
 
   DEBUG_PRINTF("ODBCConnection::QuerySync - hSTMT=%p\n", hSTMT);
   
   if (SQL_SUCCEEDED(ret)) {
-    if (paramCount) {
+    //a cached statement is prepared once, then only bound and executed
+    if (isCached && !lease->isPrepared) {
+      ret = SQLPrepare(
+        hSTMT,
+        (SQLTCHAR *) **sql,
+        sql->length());
+    }
+
+    if (paramCount && SQL_SUCCEEDED(ret)) {
       for (int i = 0; i < paramCount; i++) {
         prm = params[i];
         
@@ -1099,12 +1495,24 @@ NAN_METHOD(ODBCConnection::QuerySync) {
       }
     }
 
-    if (SQL_SUCCEEDED(ret)) {
+    if (SQL_SUCCEEDED(ret) && timeout) {
+      ODBC::SetQueryTimeout(hSTMT, timeout);
+    }
+
+    if (SQL_SUCCEEDED(ret) && isCached) {
+      ret = SQLExecute(hSTMT);
+    }
+    else if (SQL_SUCCEEDED(ret)) {
       ret = SQLExecDirect(
         hSTMT,
         (SQLTCHAR *) **sql, 
         sql->length());
     }
+
+    //after an error, reset once the diagnostics have been read
+    if (timeout && ret != SQL_ERROR) {
+      ODBC::SetQueryTimeout(hSTMT, 0);
+    }
     
     // free parameters
     for (int i = 0; i < paramCount; i++) {
@@ -1126,12 +1534,24 @@ NAN_METHOD(ODBCConnection::QuerySync) {
   
   //check to see if there was an error during execution
   if (ret == SQL_ERROR) {
+    conn->m_metadataCache.remove(key);
+
     Local<Value> objError = ODBC::GetSQLError(
       SQL_HANDLE_STMT,
       hSTMT,
       (char *) "[node-odbc] Error in ODBCConnection::QuerySync"
     );
 
+    if (timeout) {
+      ODBC::SetQueryTimeout(hSTMT, 0);
+    }
+
+    //a statement that failed is not cached again
+    if (lease) {
+      lease->isReusable = false;
+      conn->m_statementCache->release(lease);
+    }
+
     Nan::ThrowError(objError);
     
     return;
@@ -1139,24 +1559,37 @@ NAN_METHOD(ODBCConnection::QuerySync) {
   else if (noResultObject) {
     //if there is not result object requested then
     //we must destroy the STMT ourselves.
-    uv_mutex_lock(&ODBC::g_odbcMutex);
-    
-    SQLFreeHandle(SQL_HANDLE_STMT, hSTMT);
-   
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    if (lease) {
+      conn->m_statementCache->release(lease);
+    }
+    else {
+      conn->m_lock->lock();
+      
+      SQLFreeHandle(SQL_HANDLE_STMT, hSTMT);
+     
+      conn->m_lock->unlock();
+    }
     
     info.GetReturnValue().Set(Nan::True());
   }
   else {
-    Local<Value> result[4];
+    Local<Value> result[7];
     bool* canFreeHandle = new bool(true);
+    ResultShape* cachedShape = conn->m_metadataCache.get(key);
+    ResultShape* shape = ResultShape::Describe(hSTMT, cachedShape);
     
     result[0] = Nan::New<External>(conn->m_hENV);
     result[1] = Nan::New<External>(conn->m_hDBC);
     result[2] = Nan::New<External>(hSTMT);
     result[3] = Nan::New<External>(canFreeHandle);
+    result[4] = Nan::New<External>(shape);
+    result[5] = Nan::New<External>(lease);
+    result[6] = Nan::New<External>(conn->m_lock);
     
-    Local<Object> js_result = Nan::New<Function>(ODBCResult::constructor)->NewInstance(4, result);
+    //the result takes the lease and returns the statement when it is freed
+    Local<Object> js_result = Nan::New<Function>(ODBCResult::constructor)->NewInstance(7, result);
+
+    conn->m_metadataCache.update(key, cachedShape, shape, false);
 
     info.GetReturnValue().Set(js_result);
   }
@@ -1237,13 +1670,15 @@ NAN_METHOD(ODBCConnection::Tables) {
   }
   
   data->conn = conn;
+  data->lease = conn->m_statementCache->acquire(std::string());
   work_req->data = data;
   
-  uv_queue_work(
+  Executor::QueueWork(
     uv_default_loop(), 
     work_req, 
     UV_Tables, 
-    (uv_after_work_cb) UV_AfterQuery);
+    (uv_after_work_cb) UV_AfterQuery,
+    data->conn->m_lock);
 
   conn->Ref();
 
@@ -1253,11 +1688,7 @@ NAN_METHOD(ODBCConnection::Tables) {
 void ODBCConnection::UV_Tables(uv_work_t* req) {
   query_work_data* data = (query_work_data *)(req->data);
   
-  uv_mutex_lock(&ODBC::g_odbcMutex);
-  
-  SQLAllocHandle(SQL_HANDLE_STMT, data->conn->m_hDBC, &data->hSTMT );
-  
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  data->conn->m_statementCache->allocHandle(data->conn->m_hDBC, data->lease, &data->hSTMT);
   
   SQLRETURN ret = SQLTables( 
     data->hSTMT, 
@@ -1348,13 +1779,15 @@ NAN_METHOD(ODBCConnection::Columns) {
   }
   
   data->conn = conn;
+  data->lease = conn->m_statementCache->acquire(std::string());
   work_req->data = data;
   
-  uv_queue_work(
+  Executor::QueueWork(
     uv_default_loop(),
     work_req, 
     UV_Columns, 
-    (uv_after_work_cb)UV_AfterQuery);
+    (uv_after_work_cb)UV_AfterQuery,
+    data->conn->m_lock);
   
   conn->Ref();
 
@@ -1364,11 +1797,7 @@ NAN_METHOD(ODBCConnection::Columns) {
 void ODBCConnection::UV_Columns(uv_work_t* req) {
   query_work_data* data = (query_work_data *)(req->data);
   
-  uv_mutex_lock(&ODBC::g_odbcMutex);
-  
-  SQLAllocHandle(SQL_HANDLE_STMT, data->conn->m_hDBC, &data->hSTMT );
-  
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  data->conn->m_statementCache->allocHandle(data->conn->m_hDBC, data->lease, &data->hSTMT);
   
   SQLRETURN ret = SQLColumns( 
     data->hSTMT, 
@@ -1395,6 +1824,8 @@ NAN_METHOD(ODBCConnection::BeginTransactionSync) {
   
   SQLRETURN ret;
 
+  conn->inTransaction = true;
+
   //set the connection manual commits
   ret = SQLSetConnectAttr(
     conn->m_hDBC,
@@ -1439,12 +1870,15 @@ NAN_METHOD(ODBCConnection::BeginTransaction) {
   data->cb = new Nan::Callback(cb);
   data->conn = conn;
   work_req->data = data;
+
+  conn->inTransaction = true;
   
-  uv_queue_work(
+  Executor::QueueWork(
     uv_default_loop(),
     work_req, 
     UV_BeginTransaction, 
-    (uv_after_work_cb)UV_AfterBeginTransaction);
+    (uv_after_work_cb)UV_AfterBeginTransaction,
+    data->conn->m_lock);
 
   return;
 }
@@ -1564,6 +1998,8 @@ NAN_METHOD(ODBCConnection::EndTransactionSync) {
     info.GetReturnValue().Set(Nan::False());
   }
   else {
+    conn->inTransaction = false;
+
     info.GetReturnValue().Set(Nan::True());
   }
 }
@@ -1600,11 +2036,12 @@ NAN_METHOD(ODBCConnection::EndTransaction) {
   data->conn = conn;
   work_req->data = data;
   
-  uv_queue_work(
+  Executor::QueueWork(
     uv_default_loop(),
     work_req, 
     UV_EndTransaction, 
-    (uv_after_work_cb)UV_AfterEndTransaction);
+    (uv_after_work_cb)UV_AfterEndTransaction,
+    data->conn->m_lock);
 
   info.GetReturnValue().Set(Nan::Undefined());
 }
@@ -1670,6 +2107,9 @@ void ODBCConnection::UV_AfterEndTransaction(uv_work_t* req, int status) {
     
     argv[0] = objError;
   }
+  else {
+    data->conn->inTransaction = false;
+  }
 
   Nan::TryCatch try_catch;
 
@@ -1684,3 +2124,90 @@ void ODBCConnection::UV_AfterEndTransaction(uv_work_t* req, int status) {
   free(data);
   free(req);
 }
+
+/*
+ * GetMetadataCacheStatsSync
+ */
+
+NAN_METHOD(ODBCConnection::GetMetadataCacheStatsSync) {
+  DEBUG_PRINTF("ODBCConnection::GetMetadataCacheStatsSync\n");
+  Nan::HandleScope scope;
+
+  ODBCConnection* conn = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+
+  info.GetReturnValue().Set(conn->m_metadataCache.getStats());
+}
+
+/*
+ * ClearMetadataCacheSync
+ */
+
+NAN_METHOD(ODBCConnection::ClearMetadataCacheSync) {
+  DEBUG_PRINTF("ODBCConnection::ClearMetadataCacheSync\n");
+  Nan::HandleScope scope;
+
+  ODBCConnection* conn = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+
+  conn->m_metadataCache.clear();
+
+  info.GetReturnValue().Set(Nan::True());
+}
+
+/*
+ * GetStatementCacheStatsSync
+ */
+
+NAN_METHOD(ODBCConnection::GetStatementCacheStatsSync) {
+  DEBUG_PRINTF("ODBCConnection::GetStatementCacheStatsSync\n");
+  Nan::HandleScope scope;
+
+  ODBCConnection* conn = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+
+  info.GetReturnValue().Set(conn->m_statementCache->getStats());
+}
+
+/*
+ * ClearStatementCacheSync
+ */
+
+NAN_METHOD(ODBCConnection::ClearStatementCacheSync) {
+  DEBUG_PRINTF("ODBCConnection::ClearStatementCacheSync\n");
+  Nan::HandleScope scope;
+
+  ODBCConnection* conn = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+
+  conn->m_statementCache->clear();
+
+  info.GetReturnValue().Set(Nan::True());
+}
+
+/*
+ * CancelSync
+ *
+ * Cancels the query with the id that query returned, if it has not called
+ * back yet. A query still queued fails without executing, and one executing
+ * is cancelled with SQLCancel. Either way it calls back with an ECANCELED
+ * error. Other queries on the connection are not affected. Returns whether
+ * there was anything to cancel.
+ */
+
+NAN_METHOD(ODBCConnection::CancelSync) {
+  DEBUG_PRINTF("ODBCConnection::CancelSync\n");
+  Nan::HandleScope scope;
+
+  ODBCConnection* conn = Nan::ObjectWrap::Unwrap<ODBCConnection>(info.Holder());
+
+  if (info.Length() < 1 || !info[0]->IsNumber()) {
+    return Nan::ThrowTypeError("ODBCConnection::CancelSync(): The first argument must be a query id.");
+  }
+
+  bool cancelled = false;
+
+  std::map<uint32_t, query_work_data*>::iterator it = conn->m_queries.find(info[0]->Uint32Value());
+
+  if (it != conn->m_queries.end()) {
+    cancelled = ODBC::CancelExecute(&it->second->cancel);
+  }
+
+  info.GetReturnValue().Set(cancelled ? Nan::True() : Nan::False());
+}
@@ -21,19 +21,32 @@
 #define _SRC_ODBC_CONNECTION_H
 
 #include <nan.h>
+#include <map>
+
+#include "handle_lock.h"
+#include "metadata_cache.h"
+#include "statement_cache.h"
+
+class ODBCPool;
+struct query_work_data;
 
 class ODBCConnection : public Nan::ObjectWrap {
   public:
    static Nan::Persistent<String> OPTION_SQL;
    static Nan::Persistent<String> OPTION_PARAMS;
    static Nan::Persistent<String> OPTION_NORESULTS;
+   static Nan::Persistent<String> OPTION_TIMEOUT;
    static Nan::Persistent<Function> constructor;
    
    static void Init(v8::Handle<Object> exports);
    
    void Free();
+   // Hands the handle back to the pool the connection was acquired from
+   void Release();
    
   protected:
+    friend class ODBCPool;
+
     ODBCConnection() {};
     
     explicit ODBCConnection(HENV hENV, HDBC hDBC): 
@@ -53,6 +66,16 @@ public:
     static NAN_SETTER(ConnectTimeoutSetter);
     static NAN_GETTER(LoginTimeoutGetter);
     static NAN_SETTER(LoginTimeoutSetter);
+    static NAN_GETTER(MetadataCacheSizeGetter);
+    static NAN_SETTER(MetadataCacheSizeSetter);
+    static NAN_GETTER(StatementCacheSizeGetter);
+    static NAN_SETTER(StatementCacheSizeSetter);
+    static NAN_GETTER(StatementFreeListSizeGetter);
+    static NAN_SETTER(StatementFreeListSizeSetter);
+    static NAN_GETTER(AsyncExecutionGetter);
+    static NAN_SETTER(AsyncExecutionSetter);
+    static NAN_GETTER(StillExecutingPollsGetter);
+    static NAN_SETTER(StillExecutingPollsSetter);
 
     //async methods
     static NAN_METHOD(BeginTransaction);
@@ -88,6 +111,9 @@ public:
     static NAN_METHOD(Query);
 protected:
     static void UV_Query(uv_work_t* req);
+    static bool UV_QueryPoll(uv_work_t* req);
+    static bool UV_QueryError(query_work_data* data);
+    static void ResetQueryAttributes(query_work_data* data);
     static void UV_AfterQuery(uv_work_t* req, int status);
 
 public:
@@ -108,6 +134,11 @@ public:
     static NAN_METHOD(QuerySync);
     static NAN_METHOD(BeginTransactionSync);
     static NAN_METHOD(EndTransactionSync);
+    static NAN_METHOD(GetMetadataCacheStatsSync);
+    static NAN_METHOD(ClearMetadataCacheSync);
+    static NAN_METHOD(GetStatementCacheStatsSync);
+    static NAN_METHOD(ClearStatementCacheSync);
+    static NAN_METHOD(CancelSync);
 protected:
 
     struct Fetch_Request {
@@ -118,14 +149,37 @@ protected:
     
     ODBCConnection *self(void) { return this; }
 
+    bool canExecuteAsync();
+
   protected:
     HENV m_hENV;
     HDBC m_hDBC;
+    // Shared with the statements and results of this connection
+    HandleLock *m_lock;
     SQLUSMALLINT canHaveMoreResults;
     bool connected;
     int statements;
     SQLUINTEGER connectTimeout;
     SQLUINTEGER loginTimeout;
+    // Result shapes of queries, by SQL text
+    MetadataCache m_metadataCache;
+    // Prepared statement handles of queries by SQL text, and reset handles
+    // for reuse
+    StatementCache *m_statementCache;
+    // Set while the handle is leased from a pool
+    ODBCPool *m_pool;
+    // Set from beginTransaction until the transaction is ended
+    bool inTransaction;
+    // Execute queries asynchronously where the driver supports it
+    bool asyncExecution;
+    // Whether the driver supports it, -1 until asked
+    int m_asyncMode;
+    // Queries queued or executing by the id query returned, for cancelSync
+    std::map<uint32_t, query_work_data*> m_queries;
+    uint32_t m_nextQueryId;
+    // Test hook: polls of each query that see SQL_STILL_EXECUTING before
+    // the driver is called, so that async execution runs on any driver
+    uint32_t m_stillExecutingPolls;
 };
 
 struct create_statement_work_data {
@@ -133,12 +187,16 @@ struct create_statement_work_data {
   ODBCConnection *conn;
   HSTMT hSTMT;
   int result;
+
+  // Statement handle leased from the free list
+  StatementLease *lease;
 };
 
 struct query_work_data {
   Nan::Callback* cb;
   ODBCConnection *conn;
   HSTMT hSTMT;
+  uint32_t id;
   
   Parameter *params;
   int paramCount;
@@ -156,6 +214,27 @@ struct query_work_data {
   int sqlSize;
   
   int result;
+
+  // Cached result shape, and the shape described on the worker thread
+  ResultShape *cachedShape;
+  ResultShape *shape;
+
+  // Statement handle leased from the statement cache or free list
+  StatementLease *lease;
+
+  // Polled until the driver is done executing, and whether it has started
+  bool isAsync;
+  bool isExecuting;
+
+  // SQL_ATTR_QUERY_TIMEOUT in seconds, 0 for none
+  SQLULEN timeout;
+  CancelState cancel;
+
+  // Read on the worker before the statement attributes are reset
+  SQLDiagnostics *diagnostics;
+
+  // Polls answered with SQL_STILL_EXECUTING before executing, for tests
+  uint32_t stillExecutingPolls;
 };
 
 struct open_connection_work_data {
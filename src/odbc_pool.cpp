@@ -0,0 +1,1371 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <string.h>
+#include <v8.h>
+#include <node.h>
+#include <node_version.h>
+#include <uv.h>
+#include <math.h>
+#include <algorithm>
+
+#include "odbc.h"
+#include "odbc_connection.h"
+#include "odbc_pool.h"
+#include "executor.h"
+
+using namespace v8;
+using namespace node;
+
+Nan::Persistent<Function> ODBCPool::constructor;
+
+static void FreeTimer(uv_handle_t* handle) {
+  free(handle);
+}
+
+static void StartWaiterTimer(PoolWaiter* waiter, uint64_t timeout, uv_timer_cb callback) {
+  waiter->timer = (uv_timer_t *) calloc(1, sizeof(uv_timer_t));
+  waiter->timer->data = waiter;
+
+  uv_timer_init(uv_default_loop(), waiter->timer);
+  uv_timer_start(waiter->timer, callback, timeout, 0);
+}
+
+static void StopWaiterTimer(PoolWaiter* waiter) {
+  if (waiter->timer) {
+    uv_timer_stop(waiter->timer);
+    uv_close((uv_handle_t *) waiter->timer, FreeTimer);
+    waiter->timer = NULL;
+  }
+}
+
+void ODBCPool::Init(v8::Handle<Object> exports) {
+  DEBUG_PRINTF("ODBCPool::Init\n");
+  Nan::HandleScope scope;
+
+  Local<FunctionTemplate> constructor_template = Nan::New<FunctionTemplate>(New);
+
+  // Constructor Template
+  constructor_template->SetClassName(Nan::New("ODBCPool").ToLocalChecked());
+
+  // Reserve space for one Handle<Value>
+  Local<ObjectTemplate> instance_template = constructor_template->InstanceTemplate();
+  instance_template->SetInternalFieldCount(1);
+
+  // Properties
+  Nan::SetAccessor(instance_template, Nan::New("minSize").ToLocalChecked(), MinSizeGetter, MinSizeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("maxSize").ToLocalChecked(), MaxSizeGetter, MaxSizeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("maxWaiters").ToLocalChecked(), MaxWaitersGetter, MaxWaitersSetter);
+  Nan::SetAccessor(instance_template, Nan::New("acquireTimeout").ToLocalChecked(), AcquireTimeoutGetter, AcquireTimeoutSetter);
+  Nan::SetAccessor(instance_template, Nan::New("idleTimeout").ToLocalChecked(), IdleTimeoutGetter, IdleTimeoutSetter);
+  Nan::SetAccessor(instance_template, Nan::New("connectTimeout").ToLocalChecked(), ConnectTimeoutGetter, ConnectTimeoutSetter);
+  Nan::SetAccessor(instance_template, Nan::New("loginTimeout").ToLocalChecked(), LoginTimeoutGetter, LoginTimeoutSetter);
+  Nan::SetAccessor(instance_template, Nan::New("warmConcurrency").ToLocalChecked(), WarmConcurrencyGetter, WarmConcurrencySetter);
+  Nan::SetAccessor(instance_template, Nan::New("prepare").ToLocalChecked(), PrepareGetter, PrepareSetter);
+
+  // Prototype Methods
+  Nan::SetPrototypeMethod(constructor_template, "acquire", Acquire);
+  Nan::SetPrototypeMethod(constructor_template, "warm", Warm);
+  Nan::SetPrototypeMethod(constructor_template, "close", Close);
+  Nan::SetPrototypeMethod(constructor_template, "getStatsSync", GetStatsSync);
+
+  // Attach the Pool Constructor to the target object
+  constructor.Reset(constructor_template->GetFunction());
+  exports->Set(Nan::New("ODBCPool").ToLocalChecked(), constructor_template->GetFunction());
+}
+
+ODBCPool::~ODBCPool() {
+  DEBUG_PRINTF("ODBCPool::~ODBCPool\n");
+
+  uv_timer_stop(m_evictTimer);
+  uv_close((uv_handle_t *) m_evictTimer, FreeTimer);
+
+  //nothing is in use once the pool is collected, so only idle handles are
+  //left
+  for (size_t i = 0; i < m_idle.size(); i++) {
+    m_idle[i].cache->clear();
+    m_idle[i].cache->unref();
+
+    SQLDisconnect(m_idle[i].hDBC);
+
+    m_lock->lock();
+
+    SQLFreeHandle(SQL_HANDLE_DBC, m_idle[i].hDBC);
+
+    m_lock->unlock();
+
+    m_idle[i].lock->unref();
+  }
+
+  m_idle.clear();
+
+  for (size_t i = 0; i < m_statements.size(); i++) {
+    free(m_statements[i].sql);
+  }
+
+  free(m_connection);
+  m_odbc.Reset();
+  m_lock->unref();
+}
+
+/*
+ * New
+ */
+
+NAN_METHOD(ODBCPool::New) {
+  DEBUG_PRINTF("ODBCPool::New\n");
+  Nan::HandleScope scope;
+
+  REQ_EXT_ARG(0, js_henv);
+  REQ_EXT_ARG(1, js_lock);
+  REQ_STRO_ARG(2, connection);
+
+  ODBCPool* pool = new ODBCPool();
+
+  pool->Wrap(info.Holder());
+
+  pool->m_hENV = static_cast<HENV>(js_henv->Value());
+  pool->m_lock = static_cast<HandleLock *>(js_lock->Value());
+  pool->m_lock->ref();
+
+  if (info.Length() > 3 && info[3]->IsObject()) {
+    pool->m_odbc.Reset(info[3]->ToObject());
+  }
+
+#ifdef UNICODE
+  pool->m_connectionLength = connection->Length() + 1;
+  pool->m_connection = (uint16_t *) malloc(sizeof(uint16_t) * pool->m_connectionLength);
+  connection->Write((uint16_t*) pool->m_connection);
+#else
+  pool->m_connectionLength = connection->Utf8Length() + 1;
+  pool->m_connection = (char *) malloc(sizeof(char) * pool->m_connectionLength);
+  connection->WriteUtf8((char*) pool->m_connection);
+#endif
+
+  pool->m_minSize = 0;
+  pool->m_maxSize = POOL_MAX_SIZE_DEFAULT;
+  pool->m_maxWaiters = 0;
+  pool->m_acquireTimeout = 0;
+  pool->m_idleTimeout = POOL_IDLE_TIMEOUT_DEFAULT;
+  //same defaults as ODBCConnection
+  pool->m_connectTimeout = 0;
+  pool->m_loginTimeout = 5;
+  pool->m_warmConcurrency = POOL_WARM_CONCURRENCY_DEFAULT;
+
+  pool->m_closed = false;
+  pool->m_size = 0;
+  pool->m_inUse = 0;
+
+  pool->m_created = 0;
+  pool->m_destroyed = 0;
+  pool->m_acquired = 0;
+  pool->m_timeouts = 0;
+  pool->m_rejected = 0;
+  pool->m_failedResets = 0;
+  pool->m_waitIndex = 0;
+
+  //idle eviction must not keep the process alive
+  pool->m_evictTimer = (uv_timer_t *) calloc(1, sizeof(uv_timer_t));
+  pool->m_evictTimer->data = pool;
+
+  uv_timer_init(uv_default_loop(), pool->m_evictTimer);
+  uv_timer_start(pool->m_evictTimer, EvictTimerCallback, POOL_EVICT_INTERVAL, POOL_EVICT_INTERVAL);
+  uv_unref((uv_handle_t *) pool->m_evictTimer);
+
+  info.GetReturnValue().Set(info.Holder());
+}
+
+NAN_GETTER(ODBCPool::MinSizeGetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double) obj->m_minSize));
+}
+
+NAN_SETTER(ODBCPool::MinSizeSetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_minSize = value->Uint32Value();
+  }
+}
+
+NAN_GETTER(ODBCPool::MaxSizeGetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double) obj->m_maxSize));
+}
+
+NAN_SETTER(ODBCPool::MaxSizeSetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_maxSize = value->Uint32Value();
+
+    //a larger pool may serve callers that are waiting
+    obj->dispatch();
+  }
+}
+
+NAN_GETTER(ODBCPool::MaxWaitersGetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double) obj->m_maxWaiters));
+}
+
+NAN_SETTER(ODBCPool::MaxWaitersSetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_maxWaiters = value->Uint32Value();
+  }
+}
+
+NAN_GETTER(ODBCPool::AcquireTimeoutGetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>(obj->m_acquireTimeout));
+}
+
+NAN_SETTER(ODBCPool::AcquireTimeoutSetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_acquireTimeout = value->Uint32Value();
+  }
+}
+
+NAN_GETTER(ODBCPool::IdleTimeoutGetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>(obj->m_idleTimeout));
+}
+
+NAN_SETTER(ODBCPool::IdleTimeoutSetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_idleTimeout = value->Uint32Value();
+  }
+}
+
+NAN_GETTER(ODBCPool::ConnectTimeoutGetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>(obj->m_connectTimeout));
+}
+
+NAN_SETTER(ODBCPool::ConnectTimeoutSetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_connectTimeout = value->Uint32Value();
+  }
+}
+
+NAN_GETTER(ODBCPool::LoginTimeoutGetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>(obj->m_loginTimeout));
+}
+
+NAN_SETTER(ODBCPool::LoginTimeoutSetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_loginTimeout = value->Uint32Value();
+  }
+}
+
+NAN_GETTER(ODBCPool::WarmConcurrencyGetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double) obj->m_warmConcurrency));
+}
+
+NAN_SETTER(ODBCPool::WarmConcurrencySetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  //at least one connection is made at a time
+  if (value->IsNumber() && value->Uint32Value() > 0) {
+    obj->m_warmConcurrency = value->Uint32Value();
+  }
+}
+
+NAN_GETTER(ODBCPool::PrepareGetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  Local<Array> statements = Nan::New<Array>(obj->m_statements.size());
+
+  for (size_t i = 0; i < obj->m_statements.size(); i++) {
+#ifdef UNICODE
+    statements->Set(i, Nan::New((uint16_t *) obj->m_statements[i].sql, obj->m_statements[i].sqlLen).ToLocalChecked());
+#else
+    statements->Set(i, Nan::New((char *) obj->m_statements[i].sql, obj->m_statements[i].sqlLen).ToLocalChecked());
+#endif
+  }
+
+  info.GetReturnValue().Set(statements);
+}
+
+NAN_SETTER(ODBCPool::PrepareSetter) {
+  Nan::HandleScope scope;
+
+  ODBCPool *obj = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  if (!value->IsArray()) {
+    return;
+  }
+
+  //connections being made read the statements without locking
+  if (obj->m_size > 0) {
+    return Nan::ThrowError("Statements to prepare must be set before the pool connects");
+  }
+
+  for (size_t i = 0; i < obj->m_statements.size(); i++) {
+    free(obj->m_statements[i].sql);
+  }
+
+  obj->m_statements.clear();
+
+  Local<Array> arr = Local<Array>::Cast(value);
+
+  for (uint32_t i = 0; i < arr->Length(); i++) {
+    if (!arr->Get(i)->IsString()) {
+      continue;
+    }
+
+    Local<String> sql = arr->Get(i)->ToString();
+    PoolStatement statement;
+
+#ifdef UNICODE
+    statement.sqlLen = sql->Length();
+    statement.sql = (uint16_t *) malloc((statement.sqlLen + 1) * sizeof(uint16_t));
+    sql->Write((uint16_t *) statement.sql);
+#else
+    statement.sqlLen = sql->Utf8Length();
+    statement.sql = (char *) malloc(statement.sqlLen + 1);
+    sql->WriteUtf8((char *) statement.sql);
+#endif
+
+    //the same key that queries look up the statement cache with
+    statement.key = MetadataCache::GetKey(statement.sql, statement.sqlLen);
+
+    obj->m_statements.push_back(statement);
+  }
+}
+
+/*
+ * ResetHandle
+ *
+ * Undoes what the last user of a connection may have left behind. Any open
+ * transaction is rolled back. Drivers for ODBC 3.8 reset the connection
+ * attributes with SQL_ATTR_RESET_CONNECTION, others only get autocommit
+ * applied again, since that is all ODBCConnection changes. A connection
+ * that keeps prepared statements is never reset that way, since drivers
+ * may drop them.
+ */
+
+bool ODBCPool::ResetHandle(HDBC hDBC, bool canResetConnection) {
+  SQLRETURN ret = SQLEndTran(SQL_HANDLE_DBC, hDBC, SQL_ROLLBACK);
+
+  if (!SQL_SUCCEEDED(ret)) {
+    return false;
+  }
+
+#ifdef SQL_ATTR_RESET_CONNECTION
+  if (canResetConnection) {
+    ret = SQLSetConnectAttr(
+      hDBC,
+      SQL_ATTR_RESET_CONNECTION,
+      (SQLPOINTER) SQL_RESET_CONNECTION_YES,
+      SQL_IS_UINTEGER);
+
+    if (SQL_SUCCEEDED(ret)) {
+      return true;
+    }
+  }
+#endif
+
+  ret = SQLSetConnectAttr(
+    hDBC,
+    SQL_ATTR_AUTOCOMMIT,
+    (SQLPOINTER) SQL_AUTOCOMMIT_ON,
+    SQL_NTS);
+
+  return SQL_SUCCEEDED(ret);
+}
+
+/*
+ * IsDead
+ *
+ * SQL_ATTR_CONNECTION_DEAD reports the state the driver last saw without a
+ * round trip to the server. Drivers that do not support it are trusted.
+ */
+
+bool ODBCPool::IsDead(HDBC hDBC) {
+  SQLUINTEGER dead = SQL_CD_FALSE;
+
+  SQLRETURN ret = SQLGetConnectAttr(
+    hDBC,
+    SQL_ATTR_CONNECTION_DEAD,
+    &dead,
+    SQL_IS_UINTEGER,
+    NULL);
+
+  return SQL_SUCCEEDED(ret) && dead == SQL_CD_TRUE;
+}
+
+/*
+ * Connect
+ *
+ * Allocates and connects a handle, then prepares the statements of the
+ * pool on it. Any failure leaves the handle, and the statement that failed,
+ * for the error.
+ */
+
+void ODBCPool::Connect(pool_connect_data* data) {
+  data->envLock->lock();
+
+  data->result = SQLAllocHandle(SQL_HANDLE_DBC, data->hENV, &data->handle.hDBC);
+
+  data->envLock->unlock();
+
+  if (!SQL_SUCCEEDED(data->result)) {
+    data->handle.hDBC = NULL;
+    return;
+  }
+
+  if (data->connectTimeout > 0) {
+    SQLSetConnectAttr(
+      data->handle.hDBC,                         //ConnectionHandle
+      SQL_ATTR_CONNECTION_TIMEOUT,               //Attribute
+      (SQLPOINTER) size_t(data->connectTimeout), //ValuePtr
+      SQL_IS_UINTEGER);                          //StringLength
+  }
+
+  if (data->loginTimeout > 0) {
+    SQLSetConnectAttr(
+      data->handle.hDBC,                       //ConnectionHandle
+      SQL_ATTR_LOGIN_TIMEOUT,                  //Attribute
+      (SQLPOINTER) size_t(data->loginTimeout), //ValuePtr
+      SQL_IS_UINTEGER);                        //StringLength
+  }
+
+  //Attempt to connect
+  SQLRETURN ret = SQLDriverConnect(
+    data->handle.hDBC,              //ConnectionHandle
+    NULL,                           //WindowHandle
+    (SQLTCHAR*) data->connection,   //InConnectionString
+    data->connectionLength,         //StringLength1
+    NULL,                           //OutConnectionString
+    0,                              //BufferLength - in characters
+    NULL,                           //StringLength2Ptr
+    SQL_DRIVER_NOPROMPT);           //DriverCompletion
+
+  if (!SQL_SUCCEEDED(ret)) {
+    data->result = ret;
+    return;
+  }
+
+  if (!SQL_SUCCEEDED(SQLGetFunctions(
+    data->handle.hDBC,
+    SQL_API_SQLMORERESULTS,
+    &(data->handle.canHaveMoreResults)))) {
+    data->handle.canHaveMoreResults = 0;
+  }
+
+  for (size_t i = 0; i < data->statementCount; i++) {
+    HSTMT hStmt;
+
+    ret = data->handle.cache->allocHandle(data->handle.hDBC, NULL, &hStmt);
+
+    if (!SQL_SUCCEEDED(ret)) {
+      data->result = ret;
+      return;
+    }
+
+    ret = SQLPrepare(hStmt, (SQLTCHAR *) data->statements[i].sql, data->statements[i].sqlLen);
+
+    if (!SQL_SUCCEEDED(ret)) {
+      data->errorStmt = hStmt;
+      data->result = ret;
+      return;
+    }
+
+    data->prepared[i] = hStmt;
+  }
+
+  data->result = SQL_SUCCESS;
+}
+
+void ODBCPool::initConnect(pool_connect_data* data) {
+  data->hENV = m_hENV;
+  data->envLock = m_lock;
+  data->connection = m_connection;
+  data->connectionLength = m_connectionLength;
+  data->connectTimeout = m_connectTimeout;
+  data->loginTimeout = m_loginTimeout;
+  data->statements = m_statements.empty() ? NULL : &m_statements[0];
+  data->statementCount = m_statements.size();
+  data->prepared = (HSTMT *) calloc(m_statements.size() + 1, sizeof(HSTMT));
+
+  //the connection keeps its lock and statement cache for its lifetime
+  data->handle.lock = new HandleLock(m_lock->threading(), m_lock);
+  data->handle.lock->ref();
+
+  data->handle.cache = new StatementCache(data->handle.lock);
+  data->handle.cache->ref();
+  data->handle.cache->setCapacity(m_statements.size());
+}
+
+void ODBCPool::finishConnect(pool_connect_data* data) {
+  for (size_t i = 0; i < data->statementCount; i++) {
+    data->handle.cache->add(data->statements[i].key, data->prepared[i]);
+  }
+
+  free(data->prepared);
+  data->prepared = NULL;
+
+  m_created++;
+}
+
+Local<Value> ODBCPool::failConnect(pool_connect_data* data, const char* message) {
+  Nan::EscapableHandleScope scope;
+
+  Local<Value> objError;
+
+  if (data->errorStmt) {
+    objError = ODBC::GetSQLError(SQL_HANDLE_STMT, data->errorStmt, message);
+  }
+  else if (data->handle.hDBC) {
+    objError = ODBC::GetSQLError(SQL_HANDLE_DBC, data->handle.hDBC, message);
+  }
+  else {
+    objError = ODBC::GetSQLError(SQL_HANDLE_ENV, m_hENV, message);
+  }
+
+  //statements that were prepared are not cached yet
+  data->handle.lock->lock();
+
+  for (size_t i = 0; i < data->statementCount && data->prepared[i]; i++) {
+    SQLFreeHandle(SQL_HANDLE_STMT, data->prepared[i]);
+  }
+
+  if (data->errorStmt) {
+    SQLFreeHandle(SQL_HANDLE_STMT, data->errorStmt);
+  }
+
+  data->handle.lock->unlock();
+
+  free(data->prepared);
+  data->prepared = NULL;
+
+  if (data->handle.hDBC) {
+    PooledHandle* handles = (PooledHandle *) malloc(sizeof(PooledHandle));
+    handles[0] = data->handle;
+
+    this->discard(handles, 1, NULL);
+  }
+  else {
+    data->handle.cache->unref();
+    data->handle.lock->unref();
+  }
+
+  return scope.Escape(objError);
+}
+
+/*
+ * Acquire
+ */
+
+NAN_METHOD(ODBCPool::Acquire) {
+  DEBUG_PRINTF("ODBCPool::Acquire\n");
+  Nan::HandleScope scope;
+
+  REQ_FUN_ARG(0, cb);
+
+  ODBCPool* pool = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  if (pool->m_closed) {
+    return Nan::ThrowError("Pool is closed");
+  }
+
+  PoolWaiter* waiter = new PoolWaiter();
+  waiter->pool = pool;
+  waiter->cb = new Nan::Callback(cb);
+  waiter->start = uv_now(uv_default_loop());
+  waiter->timer = NULL;
+  waiter->errorMessage = NULL;
+  waiter->errorCode = NULL;
+
+  //the pool stays alive until the waiter is called back
+  pool->Ref();
+
+  bool mustWait = !pool->m_waiters.empty()
+    || (pool->m_idle.empty() && pool->m_maxSize && pool->m_size >= pool->m_maxSize);
+
+  if (mustWait && pool->m_maxWaiters && pool->m_waiters.size() >= pool->m_maxWaiters) {
+    pool->m_rejected++;
+
+    //the callback is always called asynchronously
+    waiter->errorMessage = "Too many callers waiting for a pooled connection";
+    waiter->errorCode = "EPOOLFULL";
+    StartWaiterTimer(waiter, 0, WaiterTimerCallback);
+  }
+  else {
+    pool->m_waiters.push_back(waiter);
+    pool->dispatch();
+
+    if (pool->m_acquireTimeout && !pool->m_waiters.empty() && pool->m_waiters.back() == waiter) {
+      StartWaiterTimer(waiter, pool->m_acquireTimeout, WaiterTimerCallback);
+    }
+  }
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+void ODBCPool::dispatch() {
+  while (!m_waiters.empty()) {
+    PoolWaiter* waiter = m_waiters.front();
+
+    if (!m_idle.empty()) {
+      //the most recently used handle is the most likely to still be alive
+      PooledHandle handle = m_idle.back();
+      m_idle.pop_back();
+      m_waiters.pop_front();
+
+      this->startAcquire(waiter, &handle);
+    }
+    else if (!m_maxSize || m_size < m_maxSize) {
+      m_size++;
+      m_waiters.pop_front();
+
+      this->startAcquire(waiter, NULL);
+    }
+    else {
+      break;
+    }
+  }
+}
+
+void ODBCPool::startAcquire(PoolWaiter* waiter, PooledHandle* handle) {
+  StopWaiterTimer(waiter);
+
+  uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
+
+  pool_acquire_work_data* data = (pool_acquire_work_data *)
+    calloc(1, sizeof(pool_acquire_work_data));
+
+  data->pool = this;
+  data->waiter = waiter;
+
+  if (handle) {
+    data->connect.handle = *handle;
+  }
+  else {
+    data->isNew = true;
+    this->initConnect(&data->connect);
+  }
+
+  work_req->data = data;
+
+  Executor::QueueWork(
+    uv_default_loop(),
+    work_req,
+    UV_Acquire,
+    (uv_after_work_cb)UV_AfterAcquire,
+    data->connect.handle.lock);
+
+  this->Ref();
+}
+
+void ODBCPool::UV_Acquire(uv_work_t* req) {
+  DEBUG_PRINTF("ODBCPool::UV_Acquire\n");
+  pool_acquire_work_data* data = (pool_acquire_work_data *)(req->data);
+
+  if (data->isNew) {
+    ODBCPool::Connect(&data->connect);
+  }
+  else {
+    //the server went away while the handle was idle. Its statements are
+    //freed on the event loop before it is disconnected.
+    data->wasDead = ODBCPool::IsDead(data->connect.handle.hDBC);
+    data->connect.result = SQL_SUCCESS;
+  }
+}
+
+void ODBCPool::UV_AfterAcquire(uv_work_t* req, int status) {
+  DEBUG_PRINTF("ODBCPool::UV_AfterAcquire\n");
+  Nan::HandleScope scope;
+
+  pool_acquire_work_data* data = (pool_acquire_work_data *)(req->data);
+
+  ODBCPool* pool = data->pool;
+  PoolWaiter* waiter = data->waiter;
+
+  if (data->wasDead) {
+    PooledHandle* handles = (PooledHandle *) malloc(sizeof(PooledHandle));
+    handles[0] = data->connect.handle;
+
+    pool->m_destroyed++;
+    pool->discard(handles, 1, NULL);
+
+    //connect again in the same slot
+    pool->startAcquire(waiter, NULL);
+    pool->Unref();
+
+    free(data);
+    free(req);
+    return;
+  }
+
+  Local<Value> argv[2];
+  int argc;
+
+  if (data->connect.result != SQL_SUCCESS) {
+    argv[0] = pool->failConnect(&data->connect, "[node-odbc] Error in ODBCPool::Acquire");
+    argc = 1;
+
+    pool->m_size--;
+  }
+  else {
+    if (data->isNew) {
+      pool->finishConnect(&data->connect);
+    }
+
+    Local<Value> info[5];
+    info[0] = Nan::New<External>(pool->m_hENV);
+    info[1] = Nan::New<External>(data->connect.handle.hDBC);
+    info[2] = Nan::New<External>(pool->m_lock);
+    info[3] = Nan::New<External>(data->connect.handle.lock);
+    info[4] = Nan::New<External>(data->connect.handle.cache);
+
+    Local<Object> js_conn = Nan::New<Function>(ODBCConnection::constructor)->NewInstance(5, info);
+
+    //the connection holds its own references now
+    data->connect.handle.cache->unref();
+    data->connect.handle.lock->unref();
+
+    //the connection returns the handle to the pool when it is closed
+    ODBCConnection* conn = Nan::ObjectWrap::Unwrap<ODBCConnection>(js_conn);
+    conn->connected = true;
+    conn->canHaveMoreResults = data->connect.handle.canHaveMoreResults;
+    conn->m_pool = pool;
+    pool->Ref();
+
+    pool->m_inUse++;
+    pool->m_acquired++;
+    pool->recordWait(uv_now(uv_default_loop()) - waiter->start);
+
+    argv[0] = Nan::Null();
+    argv[1] = js_conn;
+    argc = 2;
+  }
+
+  Nan::TryCatch try_catch;
+
+  waiter->cb->Call(argc, argv);
+
+  if (try_catch.HasCaught()) {
+    Nan::FatalException(try_catch);
+  }
+
+  pool->finishWaiter(waiter);
+
+  if (argc == 1) {
+    //the failed connection left room for someone else
+    pool->dispatch();
+  }
+
+  pool->Unref();
+
+  free(data);
+  free(req);
+}
+
+void ODBCPool::WaiterTimerCallback(uv_timer_t* handle) {
+  DEBUG_PRINTF("ODBCPool::WaiterTimerCallback\n");
+  Nan::HandleScope scope;
+
+  PoolWaiter* waiter = (PoolWaiter *) handle->data;
+  ODBCPool* pool = waiter->pool;
+
+  StopWaiterTimer(waiter);
+
+  if (!waiter->errorMessage) {
+    pool->m_waiters.remove(waiter);
+    pool->m_timeouts++;
+
+    waiter->errorMessage = "Timed out waiting for a pooled connection";
+    waiter->errorCode = "ETIMEDOUT";
+  }
+
+  Local<Value> argv[1];
+  argv[0] = ODBC::GetError(waiter->errorMessage, waiter->errorCode, "[node-odbc] Error in ODBCPool::Acquire");
+
+  Nan::TryCatch try_catch;
+
+  waiter->cb->Call(1, argv);
+
+  if (try_catch.HasCaught()) {
+    Nan::FatalException(try_catch);
+  }
+
+  pool->finishWaiter(waiter);
+}
+
+void ODBCPool::finishWaiter(PoolWaiter* waiter) {
+  delete waiter->cb;
+  delete waiter;
+
+  this->Unref();
+}
+
+void ODBCPool::recordWait(uint64_t waitTime) {
+  if (m_waitTimes.size() < POOL_WAIT_SAMPLES) {
+    m_waitTimes.push_back((uint32_t) waitTime);
+  }
+  else {
+    m_waitTimes[m_waitIndex] = (uint32_t) waitTime;
+  }
+
+  m_waitIndex = (m_waitIndex + 1) % POOL_WAIT_SAMPLES;
+}
+
+/*
+ * release
+ */
+
+void ODBCPool::release(PooledHandle* handle, bool inTransaction) {
+  DEBUG_PRINTF("ODBCPool::release\n");
+
+  m_inUse--;
+
+  handle->lock->ref();
+
+  //a closed pool disconnects the handle without resetting it
+  if (m_closed) {
+    return this->returnHandle(handle, true);
+  }
+
+  //rolling back may close or delete prepared statements
+  if (inTransaction) {
+    handle->cache->clear();
+  }
+
+  uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
+
+  pool_reset_work_data* data = (pool_reset_work_data *)
+    calloc(1, sizeof(pool_reset_work_data));
+
+  data->pool = this;
+  data->handle = *handle;
+  data->canResetConnection = !handle->cache->hasHandles();
+
+  work_req->data = data;
+
+  Executor::QueueWork(
+    uv_default_loop(),
+    work_req,
+    UV_Reset,
+    (uv_after_work_cb)UV_AfterReset,
+    data->handle.lock);
+
+  this->Ref();
+}
+
+void ODBCPool::UV_Reset(uv_work_t* req) {
+  DEBUG_PRINTF("ODBCPool::UV_Reset\n");
+  pool_reset_work_data* data = (pool_reset_work_data *)(req->data);
+
+  data->isReset = ODBCPool::ResetHandle(data->handle.hDBC, data->canResetConnection);
+}
+
+void ODBCPool::UV_AfterReset(uv_work_t* req, int status) {
+  DEBUG_PRINTF("ODBCPool::UV_AfterReset\n");
+  Nan::HandleScope scope;
+
+  pool_reset_work_data* data = (pool_reset_work_data *)(req->data);
+
+  ODBCPool* pool = data->pool;
+
+  pool->returnHandle(&data->handle, data->isReset);
+  pool->Unref();
+
+  free(data);
+  free(req);
+}
+
+void ODBCPool::returnHandle(PooledHandle* handle, bool isUsable) {
+  if (!isUsable || m_closed) {
+    if (!isUsable) {
+      m_failedResets++;
+    }
+
+    PooledHandle* handles = (PooledHandle *) malloc(sizeof(PooledHandle));
+    handles[0] = *handle;
+
+    m_size--;
+    m_destroyed++;
+    this->discard(handles, 1, NULL);
+  }
+  else {
+    handle->idleSince = uv_now(uv_default_loop());
+
+    m_idle.push_back(*handle);
+  }
+
+  this->dispatch();
+}
+
+/*
+ * discard
+ */
+
+void ODBCPool::discard(PooledHandle* handles, size_t count, Nan::Callback* cb) {
+  //cached statements must be freed before disconnecting
+  for (size_t i = 0; i < count; i++) {
+    handles[i].cache->clear();
+    handles[i].cache->unref();
+  }
+
+  uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
+
+  pool_discard_work_data* data = (pool_discard_work_data *)
+    calloc(1, sizeof(pool_discard_work_data));
+
+  data->pool = this;
+  data->lock = m_lock;
+  data->handles = handles;
+  data->count = count;
+  data->cb = cb;
+
+  work_req->data = data;
+
+  Executor::QueueWork(
+    uv_default_loop(),
+    work_req,
+    UV_Discard,
+    (uv_after_work_cb)UV_AfterDiscard,
+    NULL);
+
+  this->Ref();
+}
+
+void ODBCPool::UV_Discard(uv_work_t* req) {
+  DEBUG_PRINTF("ODBCPool::UV_Discard\n");
+  pool_discard_work_data* data = (pool_discard_work_data *)(req->data);
+
+  for (size_t i = 0; i < data->count; i++) {
+    SQLDisconnect(data->handles[i].hDBC);
+
+    data->lock->lock();
+
+    SQLFreeHandle(SQL_HANDLE_DBC, data->handles[i].hDBC);
+
+    data->lock->unlock();
+  }
+}
+
+void ODBCPool::UV_AfterDiscard(uv_work_t* req, int status) {
+  DEBUG_PRINTF("ODBCPool::UV_AfterDiscard\n");
+  Nan::HandleScope scope;
+
+  pool_discard_work_data* data = (pool_discard_work_data *)(req->data);
+
+  for (size_t i = 0; i < data->count; i++) {
+    data->handles[i].lock->unref();
+  }
+
+  if (data->cb) {
+    Nan::TryCatch try_catch;
+
+    data->cb->Call(0, NULL);
+
+    if (try_catch.HasCaught()) {
+      Nan::FatalException(try_catch);
+    }
+
+    delete data->cb;
+  }
+
+  data->pool->Unref();
+
+  free(data->handles);
+  free(data);
+  free(req);
+}
+
+/*
+ * evictIdle
+ *
+ * Disconnects the handles that have been idle for longer than idleTimeout,
+ * oldest first, while the pool is larger than minSize.
+ */
+
+void ODBCPool::evictIdle() {
+  if (!m_idleTimeout || m_closed || m_idle.empty()) {
+    return;
+  }
+
+  uint64_t now = uv_now(uv_default_loop());
+  size_t count = 0;
+
+  while (count < m_idle.size()
+    && m_size - count > m_minSize
+    && now - m_idle[count].idleSince >= m_idleTimeout) {
+    count++;
+  }
+
+  if (!count) {
+    return;
+  }
+
+  PooledHandle* handles = (PooledHandle *) malloc(sizeof(PooledHandle) * count);
+
+  for (size_t i = 0; i < count; i++) {
+    handles[i] = m_idle[i];
+  }
+
+  m_idle.erase(m_idle.begin(), m_idle.begin() + count);
+  m_size -= count;
+  m_destroyed += count;
+
+  this->discard(handles, count, NULL);
+}
+
+void ODBCPool::EvictTimerCallback(uv_timer_t* handle) {
+  Nan::HandleScope scope;
+
+  ODBCPool* pool = (ODBCPool *) handle->data;
+
+  pool->evictIdle();
+}
+
+/*
+ * Warm
+ *
+ * Connects until the pool holds count connections, or maxSize. Logins are
+ * slow and mostly spent waiting on the server, so each connection is made
+ * on its own thread rather than queued behind the thread pool, with up to
+ * warmConcurrency threads at a time. The callback
+ * is called once every connection is made and its statements are
+ * prepared, with the first error if any failed. Connections that are made
+ * are handed to waiting callers as soon as they are ready.
+ */
+
+NAN_METHOD(ODBCPool::Warm) {
+  DEBUG_PRINTF("ODBCPool::Warm\n");
+  Nan::HandleScope scope;
+
+  REQ_ARGS(2);
+  REQ_FUN_ARG(1, cb);
+
+  ODBCPool* pool = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  if (pool->m_closed) {
+    return Nan::ThrowError("Pool is closed");
+  }
+
+  size_t target = 0;
+
+  if (info[0]->IsNumber()) {
+    target = info[0]->Uint32Value();
+  }
+
+  if (pool->m_maxSize && target > pool->m_maxSize) {
+    target = pool->m_maxSize;
+  }
+
+  size_t count = target > pool->m_size ? target - pool->m_size : 0;
+
+  PoolWarmBatch* batch = new PoolWarmBatch();
+  batch->pool = pool;
+  batch->cb = new Nan::Callback(cb);
+  batch->count = count;
+  batch->concurrency = pool->m_warmConcurrency;
+  batch->started = 0;
+  batch->running = 0;
+  batch->finished = 0;
+  batch->slots = new PoolWarmSlot[count ? count : 1]();
+
+  batch->async = (uv_async_t *) calloc(1, sizeof(uv_async_t));
+  batch->async->data = batch;
+  uv_async_init(uv_default_loop(), batch->async, WarmAsyncCallback);
+
+  pool->m_size += count;
+  pool->Ref();
+
+  for (size_t i = 0; i < count; i++) {
+    PoolWarmSlot* slot = &batch->slots[i];
+
+    pool->initConnect(&slot->connect);
+    slot->batch = batch;
+    slot->isDone = false;
+    slot->isFinished = false;
+    slot->isStarted = false;
+  }
+
+  StartWarm(batch);
+
+  //also completes a batch with nothing to connect
+  uv_async_send(batch->async);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+bool ODBCPool::StartWarm(PoolWarmBatch* batch) {
+  bool failed = false;
+
+  while (batch->started < batch->count && batch->running < batch->concurrency) {
+    PoolWarmSlot* slot = &batch->slots[batch->started++];
+
+    slot->isStarted = uv_thread_create(&slot->thread, WarmThread, slot) == 0;
+
+    if (slot->isStarted) {
+      batch->running++;
+    }
+    else {
+      //reported like a connection that failed
+      slot->connect.result = SQL_ERROR;
+      slot->isDone = true;
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+void ODBCPool::WarmThread(void* arg) {
+  PoolWarmSlot* slot = (PoolWarmSlot *) arg;
+
+  ODBCPool::Connect(&slot->connect);
+
+  slot->isDone = true;
+
+  uv_async_send(slot->batch->async);
+}
+
+static void FreeAsync(uv_handle_t* handle) {
+  free(handle);
+}
+
+void ODBCPool::WarmAsyncCallback(uv_async_t* handle) {
+  DEBUG_PRINTF("ODBCPool::WarmAsyncCallback\n");
+  Nan::HandleScope scope;
+
+  PoolWarmBatch* batch = (PoolWarmBatch *) handle->data;
+  ODBCPool* pool = batch->pool;
+
+  for (size_t i = 0; i < batch->count; i++) {
+    PoolWarmSlot* slot = &batch->slots[i];
+
+    if (slot->isFinished || !slot->isDone) {
+      continue;
+    }
+
+    slot->isFinished = true;
+    batch->finished++;
+
+    if (slot->isStarted) {
+      uv_thread_join(&slot->thread);
+      batch->running--;
+    }
+
+    if (slot->connect.result == SQL_SUCCESS) {
+      pool->finishConnect(&slot->connect);
+
+      //handed to a waiter, or discarded if the pool was closed meanwhile
+      pool->returnHandle(&slot->connect.handle, true);
+    }
+  }
+
+  if (batch->finished < batch->count) {
+    //slots that failed to start are finished on the next callback
+    if (StartWarm(batch)) {
+      uv_async_send(handle);
+    }
+
+    return;
+  }
+
+  //errors are read once every connection is done, then the failed
+  //connections are discarded
+  Local<Value> argv[1];
+  int argc = 0;
+
+  for (size_t i = 0; i < batch->count; i++) {
+    PoolWarmSlot* slot = &batch->slots[i];
+
+    if (slot->connect.result != SQL_SUCCESS) {
+      Local<Value> objError = pool->failConnect(&slot->connect, "[node-odbc] Error in ODBCPool::Warm");
+
+      if (!argc) {
+        argv[0] = objError;
+        argc = 1;
+      }
+
+      pool->m_size--;
+    }
+  }
+
+  pool->dispatch();
+
+  uv_close((uv_handle_t *) batch->async, FreeAsync);
+
+  Nan::TryCatch try_catch;
+
+  batch->cb->Call(argc, argv);
+
+  if (try_catch.HasCaught()) {
+    Nan::FatalException(try_catch);
+  }
+
+  delete batch->cb;
+  delete[] batch->slots;
+  delete batch;
+
+  pool->Unref();
+}
+
+/*
+ * Close
+ *
+ * Disconnects the idle handles and fails the callers still waiting.
+ * Connections in use are disconnected when they are closed.
+ */
+
+NAN_METHOD(ODBCPool::Close) {
+  DEBUG_PRINTF("ODBCPool::Close\n");
+  Nan::HandleScope scope;
+
+  REQ_FUN_ARG(0, cb);
+
+  ODBCPool* pool = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  pool->m_closed = true;
+
+  while (!pool->m_waiters.empty()) {
+    PoolWaiter* waiter = pool->m_waiters.front();
+    pool->m_waiters.pop_front();
+
+    StopWaiterTimer(waiter);
+
+    waiter->errorMessage = "Pool is closed";
+    waiter->errorCode = "EPOOLCLOSED";
+    StartWaiterTimer(waiter, 0, WaiterTimerCallback);
+  }
+
+  size_t count = pool->m_idle.size();
+  PooledHandle* handles = (PooledHandle *) malloc(sizeof(PooledHandle) * (count ? count : 1));
+
+  for (size_t i = 0; i < count; i++) {
+    handles[i] = pool->m_idle[i];
+  }
+
+  pool->m_idle.clear();
+  pool->m_size -= count;
+  pool->m_destroyed += count;
+
+  pool->discard(handles, count, new Nan::Callback(cb));
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+/*
+ * GetStatsSync
+ */
+
+NAN_METHOD(ODBCPool::GetStatsSync) {
+  DEBUG_PRINTF("ODBCPool::GetStatsSync\n");
+  Nan::HandleScope scope;
+
+  ODBCPool* pool = Nan::ObjectWrap::Unwrap<ODBCPool>(info.Holder());
+
+  std::vector<uint32_t> waitTimes(pool->m_waitTimes);
+  std::sort(waitTimes.begin(), waitTimes.end());
+
+  //nearest rank percentiles of the recent wait times
+  double percentiles[3] = { 0.5, 0.9, 0.99 };
+  const char* names[3] = { "waitTimeP50", "waitTimeP90", "waitTimeP99" };
+
+  Local<Object> stats = Nan::New<Object>();
+
+  stats->Set(Nan::New("size").ToLocalChecked(), Nan::New<Number>((double) pool->m_size));
+  stats->Set(Nan::New("inUse").ToLocalChecked(), Nan::New<Number>((double) pool->m_inUse));
+  stats->Set(Nan::New("idle").ToLocalChecked(), Nan::New<Number>((double) pool->m_idle.size()));
+  stats->Set(Nan::New("pending").ToLocalChecked(), Nan::New<Number>((double) (pool->m_size - pool->m_inUse - pool->m_idle.size())));
+  stats->Set(Nan::New("waiters").ToLocalChecked(), Nan::New<Number>((double) pool->m_waiters.size()));
+  stats->Set(Nan::New("minSize").ToLocalChecked(), Nan::New<Number>((double) pool->m_minSize));
+  stats->Set(Nan::New("maxSize").ToLocalChecked(), Nan::New<Number>((double) pool->m_maxSize));
+  stats->Set(Nan::New("created").ToLocalChecked(), Nan::New<Number>((double) pool->m_created));
+  stats->Set(Nan::New("destroyed").ToLocalChecked(), Nan::New<Number>((double) pool->m_destroyed));
+  stats->Set(Nan::New("acquired").ToLocalChecked(), Nan::New<Number>((double) pool->m_acquired));
+  stats->Set(Nan::New("timeouts").ToLocalChecked(), Nan::New<Number>((double) pool->m_timeouts));
+  stats->Set(Nan::New("rejected").ToLocalChecked(), Nan::New<Number>((double) pool->m_rejected));
+  stats->Set(Nan::New("failedResets").ToLocalChecked(), Nan::New<Number>((double) pool->m_failedResets));
+
+  for (int i = 0; i < 3; i++) {
+    double value = 0;
+
+    if (!waitTimes.empty()) {
+      size_t rank = (size_t) ceil(percentiles[i] * waitTimes.size());
+      value = waitTimes[rank > 0 ? rank - 1 : 0];
+    }
+
+    stats->Set(Nan::New(names[i]).ToLocalChecked(), Nan::New<Number>(value));
+  }
+
+  stats->Set(Nan::New("waitTimeMax").ToLocalChecked(), Nan::New<Number>(waitTimes.empty() ? 0 : (double) waitTimes.back()));
+
+  info.GetReturnValue().Set(stats);
+}
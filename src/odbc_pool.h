@@ -0,0 +1,291 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SRC_ODBC_POOL_H
+#define _SRC_ODBC_POOL_H
+
+#include <atomic>
+#include <deque>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <nan.h>
+
+#include "handle_lock.h"
+#include "statement_cache.h"
+
+// Maximum number of pooled connections, 0 for no limit
+#define POOL_MAX_SIZE_DEFAULT 0
+// Milliseconds a connection above the minimum size stays idle before it is
+// disconnected, 0 to keep idle connections
+#define POOL_IDLE_TIMEOUT_DEFAULT 30000
+// Milliseconds between idle eviction passes
+#define POOL_EVICT_INTERVAL 1000
+// Most connections made at once by one warm call
+#define POOL_WARM_CONCURRENCY_DEFAULT 8
+// Number of acquire wait times kept for percentiles
+#define POOL_WAIT_SAMPLES 1024
+
+// Connected handle owned by the pool
+struct PooledHandle {
+  HDBC hDBC;
+  SQLUSMALLINT canHaveMoreResults;
+  // Lock and prepared statements of the connection, kept between leases.
+  // The pool holds a reference to each.
+  HandleLock* lock;
+  StatementCache* cache;
+  // uv_now when the handle became idle
+  uint64_t idleSince;
+};
+
+// Statement prepared on every new connection
+struct PoolStatement {
+  void* sql;
+  int sqlLen;
+  std::string key;
+};
+
+// Connection made on the thread pool or a warm-up thread
+struct pool_connect_data {
+  HENV hENV;
+  HandleLock *envLock;
+  void *connection;
+  int connectionLength;
+  SQLUINTEGER connectTimeout;
+  SQLUINTEGER loginTimeout;
+  // Owned by the pool, which does not change them once it has connected
+  PoolStatement *statements;
+  size_t statementCount;
+
+  PooledHandle handle;
+  // Handles prepared for statements, in order
+  HSTMT *prepared;
+  // Statement that failed to prepare, for the error
+  HSTMT errorStmt;
+  int result;
+};
+
+class ODBCPool;
+struct PoolWarmBatch;
+
+struct PoolWaiter {
+  ODBCPool* pool;
+  Nan::Callback* cb;
+  // uv_now when acquire was called
+  uint64_t start;
+  // Set while waiting with an acquire timeout, or to fail the waiter
+  uv_timer_t* timer;
+  // Set when the waiter is failed without a timeout
+  const char* errorMessage;
+  const char* errorCode;
+};
+
+// Connections to one connection string, kept connected between uses.
+// Connections are handed out as ODBCConnection objects, which return their
+// handle to the pool when closed instead of disconnecting. Returned handles
+// are reset on the thread pool, and idle handles are checked with
+// SQL_ATTR_CONNECTION_DEAD before they are handed out again. Callers beyond
+// maxSize wait in order, up to maxWaiters and acquireTimeout.
+//
+// Pool state is only touched on the event loop. Work on the thread pool is
+// given the handles it uses, so it never reads the pool itself.
+class ODBCPool : public Nan::ObjectWrap {
+  public:
+    static Nan::Persistent<Function> constructor;
+
+    static void Init(v8::Handle<Object> exports);
+
+    // Takes a handle back from a closed connection and resets it. Takes the
+    // reference to the statement cache of the handle.
+    void release(PooledHandle* handle, bool inTransaction);
+
+    // Safe to call from the thread pool
+    static bool ResetHandle(HDBC hDBC, bool canResetConnection);
+    static bool IsDead(HDBC hDBC);
+    static void Connect(pool_connect_data* data);
+
+  protected:
+    friend class ODBCConnection;
+
+    ODBCPool() {};
+
+    ~ODBCPool();
+
+  public:
+    //constructor
+    static NAN_METHOD(New);
+
+    //Property Getter/Setters
+    static NAN_GETTER(MinSizeGetter);
+    static NAN_SETTER(MinSizeSetter);
+    static NAN_GETTER(MaxSizeGetter);
+    static NAN_SETTER(MaxSizeSetter);
+    static NAN_GETTER(MaxWaitersGetter);
+    static NAN_SETTER(MaxWaitersSetter);
+    static NAN_GETTER(AcquireTimeoutGetter);
+    static NAN_SETTER(AcquireTimeoutSetter);
+    static NAN_GETTER(IdleTimeoutGetter);
+    static NAN_SETTER(IdleTimeoutSetter);
+    static NAN_GETTER(ConnectTimeoutGetter);
+    static NAN_SETTER(ConnectTimeoutSetter);
+    static NAN_GETTER(LoginTimeoutGetter);
+    static NAN_SETTER(LoginTimeoutSetter);
+    static NAN_GETTER(WarmConcurrencyGetter);
+    static NAN_SETTER(WarmConcurrencySetter);
+    static NAN_GETTER(PrepareGetter);
+    static NAN_SETTER(PrepareSetter);
+
+    //async methods
+    static NAN_METHOD(Acquire);
+  protected:
+    static void UV_Acquire(uv_work_t* work_req);
+    static void UV_AfterAcquire(uv_work_t* work_req, int status);
+
+  public:
+    static NAN_METHOD(Warm);
+  protected:
+    // Starts connecting the next slots up to the concurrency of the batch.
+    // Returns whether a thread could not be created.
+    static bool StartWarm(PoolWarmBatch* batch);
+    static void WarmThread(void* arg);
+    static void WarmAsyncCallback(uv_async_t* handle);
+
+  public:
+    static NAN_METHOD(Close);
+  protected:
+    static void UV_Reset(uv_work_t* work_req);
+    static void UV_AfterReset(uv_work_t* work_req, int status);
+    static void UV_Discard(uv_work_t* work_req);
+    static void UV_AfterDiscard(uv_work_t* work_req, int status);
+
+    //sync methods
+  public:
+    static NAN_METHOD(GetStatsSync);
+
+  protected:
+    static void EvictTimerCallback(uv_timer_t* handle);
+    static void WaiterTimerCallback(uv_timer_t* handle);
+
+    // Hands idle handles or new connections to waiters while there is room
+    void dispatch();
+    void startAcquire(PoolWaiter* waiter, PooledHandle* handle);
+    // Sets up a new connection, with the lock and cache it will keep
+    void initConnect(pool_connect_data* data);
+    // Caches the prepared statements of a new connection
+    void finishConnect(pool_connect_data* data);
+    // Returns the error of a failed connection and discards it
+    Local<Value> failConnect(pool_connect_data* data, const char* message);
+    void returnHandle(PooledHandle* handle, bool isUsable);
+    // Frees the prepared statements, then disconnects and frees handles on
+    // the thread pool. Takes the array.
+    void discard(PooledHandle* handles, size_t count, Nan::Callback* cb);
+    void evictIdle();
+    void finishWaiter(PoolWaiter* waiter);
+    void recordWait(uint64_t waitTime);
+
+    HENV m_hENV;
+    // Environment lock, parent of the locks of pooled connections
+    HandleLock *m_lock;
+    // Keeps the environment alive while the pool is
+    Nan::Persistent<Object> m_odbc;
+
+    void *m_connection;
+    int m_connectionLength;
+    std::vector<PoolStatement> m_statements;
+
+    size_t m_minSize;
+    size_t m_maxSize;
+    size_t m_maxWaiters;
+    uint32_t m_acquireTimeout;
+    uint32_t m_idleTimeout;
+    SQLUINTEGER m_connectTimeout;
+    SQLUINTEGER m_loginTimeout;
+    size_t m_warmConcurrency;
+
+    bool m_closed;
+    // Handles owned by the pool: idle, in use, or being checked, reset or
+    // connected on the thread pool
+    size_t m_size;
+    size_t m_inUse;
+    // Most recently used last
+    std::deque<PooledHandle> m_idle;
+    std::list<PoolWaiter*> m_waiters;
+    uv_timer_t* m_evictTimer;
+
+    size_t m_created;
+    size_t m_destroyed;
+    size_t m_acquired;
+    size_t m_timeouts;
+    size_t m_rejected;
+    size_t m_failedResets;
+
+    // Ring of recent acquire wait times in milliseconds
+    std::vector<uint32_t> m_waitTimes;
+    size_t m_waitIndex;
+};
+
+struct pool_acquire_work_data {
+  ODBCPool *pool;
+  PoolWaiter *waiter;
+
+  // Idle handle to check, or the new connection
+  pool_connect_data connect;
+  bool isNew;
+  bool wasDead;
+};
+
+struct pool_reset_work_data {
+  ODBCPool *pool;
+  PooledHandle handle;
+  bool canResetConnection;
+  bool isReset;
+};
+
+struct pool_discard_work_data {
+  ODBCPool *pool;
+  HandleLock *lock;
+  PooledHandle *handles;
+  size_t count;
+  Nan::Callback *cb;
+};
+
+// Connections made by one warm call, each on its own thread with at most
+// concurrency threads at a time
+struct PoolWarmSlot {
+  PoolWarmBatch *batch;
+  pool_connect_data connect;
+  uv_thread_t thread;
+  bool isStarted;
+  std::atomic<bool> isDone;
+  bool isFinished;
+};
+
+struct PoolWarmBatch {
+  ODBCPool *pool;
+  Nan::Callback *cb;
+  uv_async_t *async;
+  PoolWarmSlot *slots;
+  size_t count;
+  size_t concurrency;
+  size_t started;
+  size_t running;
+  size_t finished;
+};
+
+#endif
@@ -30,6 +30,13 @@
 #include "odbc_statement.h"
 
 #include "util.h"
+#include "rowset.h"
+#include "row_batch.h"
+#include "buffer_pool.h"
+#include "metadata_cache.h"
+#include "statement_cache.h"
+#include "handle_lock.h"
+#include "executor.h"
 
 using namespace v8;
 using namespace node;
@@ -40,6 +47,14 @@ Nan::Persistent<String> ODBCResult::OPTION_FETCH_MODE;
 Nan::Persistent<String> ODBCResult::OPTION_INCLUDE_METADATA;
 Nan::Persistent<String> ODBCResult::OPTION_MAX_VALUE_SIZE;
 Nan::Persistent<String> ODBCResult::OPTION_VALUE_CHUNK_SIZE;
+Nan::Persistent<String> ODBCResult::OPTION_ROWSET_SIZE;
+Nan::Persistent<String> ODBCResult::OPTION_BATCH_SIZE;
+Nan::Persistent<String> ODBCResult::OPTION_MAX_BATCH_BYTES;
+Nan::Persistent<String> ODBCResult::OPTION_BIGINT_MODE;
+Nan::Persistent<String> ODBCResult::OPTION_DECIMAL_MODE;
+Nan::Persistent<String> ODBCResult::OPTION_DATE_MODE;
+Nan::Persistent<String> ODBCResult::OPTION_DATE_FRACTION;
+Nan::Persistent<String> ODBCResult::OPTION_LOB_MODE;
 
 void ODBCResult::Init(v8::Handle<Object> exports) {
   DEBUG_PRINTF("ODBCResult::Init\n");
@@ -57,26 +72,46 @@ void ODBCResult::Init(v8::Handle<Object> exports) {
   // Prototype Methods  
   Nan::SetPrototypeMethod(constructor_template, "fetchAll", FetchAll);
   Nan::SetPrototypeMethod(constructor_template, "fetch", Fetch);
+  Nan::SetPrototypeMethod(constructor_template, "fetchMany", FetchMany);
+  Nan::SetPrototypeMethod(constructor_template, "getData", GetData);
 
   Nan::SetPrototypeMethod(constructor_template, "moreResultsSync", MoreResultsSync);
   Nan::SetPrototypeMethod(constructor_template, "closeSync", CloseSync);
   Nan::SetPrototypeMethod(constructor_template, "fetchSync", FetchSync);
   Nan::SetPrototypeMethod(constructor_template, "fetchAllSync", FetchAllSync);
+  Nan::SetPrototypeMethod(constructor_template, "fetchManySync", FetchManySync);
   Nan::SetPrototypeMethod(constructor_template, "getColumnNamesSync", GetColumnNamesSync);
   Nan::SetPrototypeMethod(constructor_template, "getColumnMetadataSync", GetColumnMetadataSync);
   Nan::SetPrototypeMethod(constructor_template, "getRowCountSync", GetRowCountSync);
+  Nan::SetPrototypeMethod(constructor_template, "cancelSync", CancelSync);
 
   // Options
   OPTION_FETCH_MODE.Reset(Nan::New("fetchMode").ToLocalChecked());
   OPTION_INCLUDE_METADATA.Reset(Nan::New("includeMetadata").ToLocalChecked());
   OPTION_MAX_VALUE_SIZE.Reset(Nan::New("maxValueSize").ToLocalChecked());
   OPTION_VALUE_CHUNK_SIZE.Reset(Nan::New("valueChunkSize").ToLocalChecked());
+  OPTION_ROWSET_SIZE.Reset(Nan::New("rowsetSize").ToLocalChecked());
+  OPTION_BATCH_SIZE.Reset(Nan::New("batchSize").ToLocalChecked());
+  OPTION_MAX_BATCH_BYTES.Reset(Nan::New("maxBatchBytes").ToLocalChecked());
+  OPTION_BIGINT_MODE.Reset(Nan::New("bigintMode").ToLocalChecked());
+  OPTION_DECIMAL_MODE.Reset(Nan::New("decimalMode").ToLocalChecked());
+  OPTION_DATE_MODE.Reset(Nan::New("dateMode").ToLocalChecked());
+  OPTION_DATE_FRACTION.Reset(Nan::New("dateFraction").ToLocalChecked());
+  OPTION_LOB_MODE.Reset(Nan::New("lobMode").ToLocalChecked());
 
   // Properties
   Nan::SetAccessor(instance_template, Nan::New("fetchMode").ToLocalChecked(), FetchModeGetter, FetchModeSetter);
   Nan::SetAccessor(instance_template, Nan::New("includeMetadata").ToLocalChecked(), IncludeMetadataGetter, IncludeMetadataSetter);
   Nan::SetAccessor(instance_template, Nan::New("maxValueSize").ToLocalChecked(), MaxValueSizeGetter, MaxValueSizeSetter);
   Nan::SetAccessor(instance_template, Nan::New("valueChunkSize").ToLocalChecked(), ValueChunkSizeGetter, ValueChunkSizeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("rowsetSize").ToLocalChecked(), RowsetSizeGetter, RowsetSizeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("batchSize").ToLocalChecked(), BatchSizeGetter, BatchSizeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("maxBatchBytes").ToLocalChecked(), MaxBatchBytesGetter, MaxBatchBytesSetter);
+  Nan::SetAccessor(instance_template, Nan::New("bigintMode").ToLocalChecked(), BigIntModeGetter, BigIntModeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("decimalMode").ToLocalChecked(), DecimalModeGetter, DecimalModeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("dateMode").ToLocalChecked(), DateModeGetter, DateModeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("dateFraction").ToLocalChecked(), DateFractionGetter, DateFractionSetter);
+  Nan::SetAccessor(instance_template, Nan::New("lobMode").ToLocalChecked(), LobModeGetter, LobModeSetter);
 
   // Attach the Database Constructor to the target object
   constructor.Reset(constructor_template->GetFunction());
@@ -88,26 +123,33 @@ ODBCResult::~ODBCResult() {
   DEBUG_PRINTF("ODBCResult::~ODBCResult\n");
   //DEBUG_PRINTF("ODBCResult::~ODBCResult m_hSTMT=%x\n", m_hSTMT);
   this->Free();
+
+  ODBC::FreeCancelState(&m_cancel);
+
+  m_lock->unref();
 }
 
 void ODBCResult::Free() {
   DEBUG_PRINTF("ODBCResult::Free\n");
   //DEBUG_PRINTF("ODBCResult::Free m_hSTMT=%X m_canFreeHandle=%X\n", m_hSTMT, m_canFreeHandle);
 
-  if (m_hSTMT && m_canFreeHandle) {
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+  if (m_hSTMT && m_canFreeHandle && m_lease) {
+    m_lease->cache->release(m_lease);
+
+    m_lease = NULL;
+    m_hSTMT = NULL;
+  }
+  else if (m_hSTMT && m_canFreeHandle) {
+    m_lock->lock();
     
     SQLFreeHandle( SQL_HANDLE_STMT, m_hSTMT);
     
     m_hSTMT = NULL;
   
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    m_lock->unlock();
   }
   
-  if (bufferLength > 0) {
-    bufferLength = 0;
-    free(buffer);
-  }
+  this->FreeColumns();
 }
 
 NAN_METHOD(ODBCResult::New) {
@@ -138,21 +180,57 @@ NAN_METHOD(ODBCResult::New) {
   //free the pointer to canFreeHandle
   delete canFreeHandle;
 
-  //specify the buffer length
-  objODBCResult->bufferLength = ALIGN_SIZE(FIXED_BUFFER_SIZE);
+  //the buffer is taken from the pool once the columns are known
+  objODBCResult->buffer = NULL;
+  objODBCResult->bufferLength = 0;
+  objODBCResult->m_externalMemory = 0;
 
-  //initialze a buffer for this object
-  objODBCResult->buffer = (uint8_t *) malloc(objODBCResult->bufferLength);
-  //TODO: make sure the malloc succeeded
-
-  //set the initial colCount to 0
+  //set the initial colCount to 0, or take the columns described on execute
+  objODBCResult->columns = NULL;
   objODBCResult->colCount = 0;
+  objODBCResult->m_shape = NULL;
+  objODBCResult->m_lease = NULL;
+
+  if (info.Length() > 5 && info[5]->IsExternal()) {
+    objODBCResult->m_lease = static_cast<StatementLease *>(info[5].As<External>()->Value());
+  }
+
+  //share the lock of the connection, or lock across the process
+  if (info.Length() > 6 && info[6]->IsExternal()) {
+    objODBCResult->m_lock = static_cast<HandleLock *>(info[6].As<External>()->Value());
+  } else {
+    objODBCResult->m_lock = new HandleLock(THREADING_PROCESS, NULL);
+  }
+
+  objODBCResult->m_lock->ref();
+
+  if (info.Length() > 4 && info[4]->IsExternal()) {
+    ResultShape* shape = static_cast<ResultShape *>(info[4].As<External>()->Value());
+
+    if (shape) {
+      shape->ref();
+      objODBCResult->m_shape = shape;
+      objODBCResult->columns = shape->columns();
+      objODBCResult->colCount = shape->columnCount();
+    }
+  }
 
   //set option defaults
   objODBCResult->m_fetchMode = FETCH_OBJECT;
   objODBCResult->m_includeMetadata = false;
   objODBCResult->m_maxValueSize = CLAMP_SIZE_UNSIGNED(MAX_VALUE_SIZE_DEFAULT, MAX_VALUE_SIZE);
   objODBCResult->m_valueChunkSize = CLAMP_SIZE_UNSIGNED(MAX_VALUE_CHUNK_SIZE_DEFAULT, MAX_VALUE_CHUNK_SIZE);
+  objODBCResult->m_rowsetSize = ROWSET_SIZE_DEFAULT;
+  objODBCResult->m_batchSize = BATCH_SIZE_DEFAULT;
+  objODBCResult->m_maxBatchBytes = MAX_BATCH_BYTES_DEFAULT;
+  objODBCResult->m_valueOptions.bigintMode = BIGINT_STRING;
+  objODBCResult->m_valueOptions.decimalMode = DECIMAL_STRING;
+  objODBCResult->m_valueOptions.dateMode = DATE_STRING;
+  objODBCResult->m_valueOptions.dateFraction = false;
+  objODBCResult->m_valueOptions.lobMode = LOB_VALUE;
+  objODBCResult->m_fetchCount = 0;
+  objODBCResult->m_isFetching = false;
+  ODBC::InitCancelState(&objODBCResult->m_cancel);
 
   objODBCResult->Wrap(info.Holder());
   
@@ -219,6 +297,384 @@ NAN_SETTER(ODBCResult::ValueChunkSizeSetter) {
   }
 }
 
+NAN_GETTER(ODBCResult::RowsetSizeGetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double)obj->m_rowsetSize));
+}
+
+NAN_SETTER(ODBCResult::RowsetSizeSetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_rowsetSize = CLAMP_ROWSET_SIZE(value->NumberValue());
+  }
+}
+
+NAN_GETTER(ODBCResult::BatchSizeGetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double)obj->m_batchSize));
+}
+
+NAN_SETTER(ODBCResult::BatchSizeSetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_batchSize = CLAMP_BATCH_SIZE(value->NumberValue());
+  }
+}
+
+NAN_GETTER(ODBCResult::MaxBatchBytesGetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double)CLAMP_SIZE_SIGNED(obj->m_maxBatchBytes)));
+}
+
+NAN_SETTER(ODBCResult::MaxBatchBytesSetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_maxBatchBytes = CLAMP_SIZE_UNSIGNED(value->NumberValue(), MAX_VALUE_SIZE);
+  }
+}
+
+NAN_GETTER(ODBCResult::BigIntModeGetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New(obj->m_valueOptions.bigintMode));
+}
+
+NAN_SETTER(ODBCResult::BigIntModeSetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  if (value->IsInt32()) {
+    obj->m_valueOptions.bigintMode = value->Int32Value();
+  }
+}
+
+NAN_GETTER(ODBCResult::DecimalModeGetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New(obj->m_valueOptions.decimalMode));
+}
+
+NAN_SETTER(ODBCResult::DecimalModeSetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  if (value->IsInt32()) {
+    obj->m_valueOptions.decimalMode = value->Int32Value();
+  }
+}
+
+NAN_GETTER(ODBCResult::DateModeGetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New(obj->m_valueOptions.dateMode));
+}
+
+NAN_SETTER(ODBCResult::DateModeSetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  if (value->IsInt32()) {
+    obj->m_valueOptions.dateMode = value->Int32Value();
+  }
+}
+
+NAN_GETTER(ODBCResult::DateFractionGetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New(obj->m_valueOptions.dateFraction));
+}
+
+NAN_SETTER(ODBCResult::DateFractionSetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  if (value->IsBoolean()) {
+    obj->m_valueOptions.dateFraction = value->BooleanValue();
+  }
+}
+
+NAN_GETTER(ODBCResult::LobModeGetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New(obj->m_valueOptions.lobMode));
+}
+
+NAN_SETTER(ODBCResult::LobModeSetter) {
+  ODBCResult *obj = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  if (value->IsInt32()) {
+    obj->m_valueOptions.lobMode = value->Int32Value();
+  }
+}
+
+/*
+ * GetValueOptions
+ *
+ * Reads the value options set in a fetch options object.
+ */
+
+void ODBCResult::GetValueOptions(Local<Object> obj, ValueOptions* valueOptions) {
+  Local<String> bigintModeKey = Nan::New<String>(OPTION_BIGINT_MODE);
+  if (obj->Has(bigintModeKey) && obj->Get(bigintModeKey)->IsInt32()) {
+    valueOptions->bigintMode = obj->Get(bigintModeKey)->ToInt32()->Value();
+  }
+
+  Local<String> decimalModeKey = Nan::New<String>(OPTION_DECIMAL_MODE);
+  if (obj->Has(decimalModeKey) && obj->Get(decimalModeKey)->IsInt32()) {
+    valueOptions->decimalMode = obj->Get(decimalModeKey)->ToInt32()->Value();
+  }
+
+  Local<String> dateModeKey = Nan::New<String>(OPTION_DATE_MODE);
+  if (obj->Has(dateModeKey) && obj->Get(dateModeKey)->IsInt32()) {
+    valueOptions->dateMode = obj->Get(dateModeKey)->ToInt32()->Value();
+  }
+
+  Local<String> dateFractionKey = Nan::New<String>(OPTION_DATE_FRACTION);
+  if (obj->Has(dateFractionKey) && obj->Get(dateFractionKey)->IsBoolean()) {
+    valueOptions->dateFraction = obj->Get(dateFractionKey)->BooleanValue();
+  }
+
+  Local<String> lobModeKey = Nan::New<String>(OPTION_LOB_MODE);
+  if (obj->Has(lobModeKey) && obj->Get(lobModeKey)->IsInt32()) {
+    valueOptions->lobMode = obj->Get(lobModeKey)->ToInt32()->Value();
+  }
+}
+
+/*
+ * SetValueOptions
+ *
+ * Applies value options to a result object.
+ */
+
+void ODBCResult::SetValueOptions(Local<Object> result, ValueOptions& valueOptions) {
+  result->Set(Nan::New(OPTION_BIGINT_MODE), Nan::New(valueOptions.bigintMode));
+  result->Set(Nan::New(OPTION_DECIMAL_MODE), Nan::New(valueOptions.decimalMode));
+  result->Set(Nan::New(OPTION_DATE_MODE), Nan::New(valueOptions.dateMode));
+  result->Set(Nan::New(OPTION_DATE_FRACTION), Nan::New(valueOptions.dateFraction));
+  result->Set(Nan::New(OPTION_LOB_MODE), Nan::New(valueOptions.lobMode));
+}
+
+/*
+ * BindRowset
+ *
+ * Binds the columns of the current result set for block cursor fetches.
+ * Returns NULL if the rows should be fetched one at a time instead.
+ */
+
+Rowset* ODBCResult::BindRowset(size_t rowsetSize, ValueOptions& valueOptions) {
+  if (rowsetSize <= 1) {
+    return NULL;
+  }
+
+  if (this->colCount == 0) {
+    this->columns = ODBC::GetColumns(this->m_hSTMT, &this->colCount);
+
+    if (this->colCount == 0) {
+      this->FreeColumns();
+      return NULL;
+    }
+  }
+
+  Rowset* rowset = new Rowset(this->m_hDBC, this->m_hSTMT, this->columns, this->colCount, valueOptions);
+
+  if (!rowset->bind(rowsetSize)) {
+    delete rowset;
+    return NULL;
+  }
+
+  return rowset;
+}
+
+/*
+ * ReadBatch
+ *
+ * Fetches rows, or rowsets if one is bound, into the batch until batchSize
+ * rows or maxBatchBytes bytes have been added to it. Does not touch V8 so
+ * that it can run on the thread pool. Rows read before an error or the end
+ * of the result set are kept in the batch.
+ */
+
+SQLRETURN ODBCResult::ReadBatch(RowBatch** batch, Rowset* rowset,
+                                size_t maxValueSize, size_t valueChunkSize,
+                                ValueOptions& valueOptions,
+                                size_t batchSize, size_t maxBatchBytes) {
+  SQLRETURN ret;
+
+  size_t startRows = *batch ? (*batch)->rowCount() : 0;
+  size_t startBytes = *batch ? (*batch)->byteSize() : 0;
+
+  do {
+    ret = rowset ? rowset->fetch() : SQLFetch(this->m_hSTMT);
+    this->m_fetchCount++;
+
+    if (this->colCount == 0) {
+      this->columns = ODBC::GetColumns(this->m_hSTMT, &this->colCount);
+    }
+
+    if (this->colCount == 0) {
+      return ret;
+    }
+
+    if (!*batch) {
+      *batch = new RowBatch(this->columns, this->colCount, maxValueSize, valueChunkSize, valueOptions);
+    }
+
+    if (!this->buffer && !this->AcquireBuffer()) {
+      (*batch)->setError("[node-odbc] Failed to allocate buffer for column data", "ENOMEM");
+      return SQL_ERROR;
+    }
+
+    if (!SQL_SUCCEEDED(ret)) {
+      //a cached shape may no longer match the result set
+      if (ret == SQL_ERROR && this->m_shape) { this->m_shape->invalidate(); }
+      return ret;
+    }
+
+    if (rowset) {
+      ret = rowset->readRows(*batch, this->buffer, this->bufferLength);
+    }
+    else {
+      ret = (*batch)->readRow(this->m_hSTMT, this->buffer, this->bufferLength);
+    }
+
+    if (!SQL_SUCCEEDED(ret)) {
+      if (this->m_shape) { this->m_shape->invalidate(); }
+      return SQL_ERROR;
+    }
+  } while ((*batch)->rowCount() - startRows < batchSize && (*batch)->byteSize() - startBytes < maxBatchBytes);
+
+  return SQL_SUCCESS;
+}
+
+/*
+ * AppendRecords
+ *
+ * Converts the rows in the batch and appends them to rows. For FETCH_FLAT
+ * the values of each row are appended instead. For FETCH_COLUMNAR the rows
+ * are left in the batch to be returned by RowBatch::getColumnar, and are only
+ * counted.
+ */
+
+void ODBCResult::AppendRecords(RowBatch* batch, int fetchMode, Local<Array> rows, int* count) {
+  size_t rowCount = batch->rowCount();
+
+  if (fetchMode == FETCH_COLUMNAR) {
+    *count = (int) rowCount;
+    return;
+  }
+
+  short colCount = batch->columnCount();
+  RecordShape* shape = this->GetRecordShape();
+
+  for (size_t i = 0; i < rowCount; i++) {
+    if (fetchMode == FETCH_FLAT) {
+      uint32_t index = (uint32_t) *count * colCount;
+
+      for (short j = 0; j < colCount; j++) {
+        rows->Set(Nan::New(index + j), batch->getColumnValue(i, j));
+      }
+    }
+    else if (fetchMode == FETCH_ARRAY) {
+      rows->Set(Nan::New(*count), batch->getRecordArray(i));
+    }
+    else {
+      rows->Set(Nan::New(*count), batch->getRecordTuple(i, shape));
+    }
+    (*count)++;
+  }
+}
+
+/*
+ * GetRecordShape
+ *
+ * Returns the names and row template of the current result set, creating
+ * them the first time rows are converted.
+ */
+
+RecordShape* ODBCResult::GetRecordShape() {
+  if (this->m_shape) {
+    return this->m_shape->recordShape();
+  }
+
+  if (this->m_recordShape.isEmpty()) {
+    this->m_recordShape.build(this->columns, this->colCount);
+  }
+
+  return &this->m_recordShape;
+}
+
+/*
+ * AcquireBuffer
+ *
+ * Takes a scratch buffer sized for the current columns from the pool. May
+ * run on the thread pool; the memory is reported to V8 by
+ * UpdateExternalMemory once back on the event loop.
+ */
+
+bool ODBCResult::AcquireBuffer() {
+  size_t bufferSize;
+
+  this->buffer = BufferPool::Acquire(BufferPool::GetBufferSize(this->columns, this->colCount), &bufferSize);
+  this->bufferLength = (int) bufferSize;
+
+  return this->buffer != NULL;
+}
+
+/*
+ * ReleaseBuffer
+ */
+
+void ODBCResult::ReleaseBuffer() {
+  if (this->buffer) {
+    BufferPool::Release(this->buffer, (size_t) this->bufferLength);
+
+    this->buffer = NULL;
+    this->bufferLength = 0;
+  }
+
+  this->UpdateExternalMemory();
+}
+
+/*
+ * UpdateExternalMemory
+ *
+ * Reports changes in the size of the held buffer, and of the batch read
+ * into if given, to V8. Event loop only.
+ */
+
+void ODBCResult::UpdateExternalMemory(RowBatch* batch) {
+  if (this->bufferLength != this->m_externalMemory) {
+    Nan::AdjustExternalMemory(this->bufferLength - this->m_externalMemory);
+    this->m_externalMemory = this->bufferLength;
+  }
+
+  if (batch) {
+    batch->updateExternalMemory();
+  }
+}
+
+/*
+ * FreeColumns
+ */
+
+void ODBCResult::FreeColumns() {
+  this->ReleaseBuffer();
+  this->m_recordShape.reset();
+
+  //columns described on execute belong to the shape
+  if (this->m_shape) {
+    this->m_shape->unref();
+    this->m_shape = NULL;
+    this->columns = NULL;
+    this->colCount = 0;
+    return;
+  }
+
+  ODBC::FreeColumns(this->columns, &this->colCount);
+}
+
 /*
  * Fetch
  */
@@ -228,6 +684,11 @@ NAN_METHOD(ODBCResult::Fetch) {
   Nan::HandleScope scope;
   
   ODBCResult* objODBCResult = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  //the handle is still being read by fetchAll or fetchMany
+  if (objODBCResult->m_isFetching) {
+    return Nan::ThrowError("ODBCResult::Fetch(): A fetch is already running on this result.");
+  }
   
   uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
   
@@ -239,6 +700,7 @@ NAN_METHOD(ODBCResult::Fetch) {
   data->fetchMode = objODBCResult->m_fetchMode;
   data->maxValueSize = objODBCResult->m_maxValueSize;
   data->valueChunkSize = objODBCResult->m_valueChunkSize;
+  data->valueOptions = objODBCResult->m_valueOptions;
 
   if (info.Length() == 1 && info[0]->IsFunction()) {
     cb = Local<Function>::Cast(info[0]);
@@ -262,21 +724,29 @@ NAN_METHOD(ODBCResult::Fetch) {
     if (obj->Has(valueChunkSizeKey) && obj->Get(valueChunkSizeKey)->IsNumber()) {
       data->valueChunkSize = CLAMP_SIZE_UNSIGNED(obj->Get(valueChunkSizeKey)->NumberValue(), MAX_VALUE_CHUNK_SIZE);
     }
+
+    GetValueOptions(obj, &data->valueOptions);
   }
   else {
     return Nan::ThrowTypeError("ODBCResult::Fetch(): 1 or 2 arguments are required. The last argument must be a callback function.");
   }
+
+  //streamed columns need a row to read from
+  if (data->fetchMode == FETCH_COLUMNAR) {
+    data->valueOptions.lobMode = LOB_VALUE;
+  }
   
   data->cb = new Nan::Callback(cb);
   
   data->objResult = objODBCResult;
   work_req->data = data;
   
-  uv_queue_work(
+  Executor::QueueWork(
     uv_default_loop(), 
     work_req, 
     UV_Fetch, 
-    (uv_after_work_cb)UV_AfterFetch);
+    (uv_after_work_cb)UV_AfterFetch,
+    data->objResult->m_lock);
 
   objODBCResult->Ref();
 
@@ -288,7 +758,14 @@ void ODBCResult::UV_Fetch(uv_work_t* work_req) {
   
   fetch_work_data* data = (fetch_work_data *)(work_req->data);
   
-  data->result = SQLFetch(data->objResult->m_hSTMT);
+  data->result = data->objResult->ReadBatch(
+    &data->batch,
+    NULL,
+    data->maxValueSize,
+    data->valueChunkSize,
+    data->valueOptions,
+    1,
+    MAX_VALUE_SIZE);
 }
 
 void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
@@ -296,6 +773,7 @@ void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
   Nan::HandleScope scope;
   
   fetch_work_data* data = (fetch_work_data *)(work_req->data);
+  data->objResult->UpdateExternalMemory(data->batch);
   
   SQLRETURN ret = data->result;
   //TODO: we should probably define this on the work data so we
@@ -304,12 +782,6 @@ void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
   bool moreWork = true;
   bool error = false;
   
-  if (data->objResult->colCount == 0) {
-    data->objResult->columns = ODBC::GetColumns(
-      data->objResult->m_hSTMT, 
-      &data->objResult->colCount);
-  }
-  
   //check to see if the result has no columns
   if (data->objResult->colCount == 0) {
     //this means
@@ -320,10 +792,17 @@ void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
     moreWork = false;
     error = true;
     
-    objError = ODBC::GetSQLError(
-      SQL_HANDLE_STMT, 
-      data->objResult->m_hSTMT,
-      (char *) "Error in ODBCResult::UV_AfterFetch");
+    if (data->batch) {
+      objError = data->batch->getError(
+        data->objResult->m_hSTMT,
+        (char *) "Error in ODBCResult::UV_AfterFetch");
+    }
+    else {
+      objError = ODBC::GetSQLError(
+        SQL_HANDLE_STMT, 
+        data->objResult->m_hSTMT,
+        (char *) "Error in ODBCResult::UV_AfterFetch");
+    }
   }
   //check to see if we are at the end of the recordset
   else if (ret == SQL_NO_DATA) {
@@ -336,25 +815,16 @@ void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
     Nan::TryCatch try_catch;
 
     info[0] = Nan::Null();
-    if (data->fetchMode == FETCH_ARRAY) {
-      info[1] = ODBC::GetRecordArray(
-        data->objResult->m_hSTMT,
-        data->objResult->columns,
-        &data->objResult->colCount,
-        data->objResult->buffer,
-        data->objResult->bufferLength,
-        data->maxValueSize,
-        data->valueChunkSize);
+    if (data->fetchMode == FETCH_COLUMNAR) {
+      info[1] = data->batch->getColumnar();
+    }
+    else if (data->fetchMode == FETCH_ARRAY || data->fetchMode == FETCH_FLAT) {
+      data->batch->setStreamOwner(data->objResult->handle(), data->objResult->m_fetchCount);
+      info[1] = data->batch->getRecordArray(0);
     }
     else {
-      info[1] = ODBC::GetRecordTuple(
-        data->objResult->m_hSTMT,
-        data->objResult->columns,
-        &data->objResult->colCount,
-        data->objResult->buffer,
-        data->objResult->bufferLength,
-        data->maxValueSize,
-        data->valueChunkSize);
+      data->batch->setStreamOwner(data->objResult->handle(), data->objResult->m_fetchCount);
+      info[1] = data->batch->getRecordTuple(0, data->objResult->GetRecordShape());
     }
 
     if (try_catch.HasCaught()) {
@@ -370,7 +840,10 @@ void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
      }
   }
   else {
-    ODBC::FreeColumns(data->objResult->columns, &data->objResult->colCount);
+    delete data->batch;
+    data->batch = NULL;
+
+    data->objResult->FreeColumns();
     
     Local<Value> info[2];
     
@@ -396,6 +869,7 @@ void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
   
   data->objResult->Unref();
   
+  delete data->batch;
   free(data);
   free(work_req);
   
@@ -412,6 +886,11 @@ NAN_METHOD(ODBCResult::FetchSync) {
   
   ODBCResult* objResult = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
 
+  //the handle is still being read by fetchAll or fetchMany
+  if (objResult->m_isFetching) {
+    return Nan::ThrowError("ODBCResult::FetchSync(): A fetch is already running on this result.");
+  }
+
   Local<Value> objError;
   bool moreWork = true;
   bool error = false;
@@ -419,6 +898,7 @@ NAN_METHOD(ODBCResult::FetchSync) {
   int fetchMode = objResult->m_fetchMode;
   size_t maxValueSize = objResult->m_maxValueSize;
   size_t valueChunkSize = objResult->m_valueChunkSize;
+  ValueOptions valueOptions = objResult->m_valueOptions;
 
   if (info.Length() == 1 && info[0]->IsObject()) {
     Local<Object> obj = info[0]->ToObject();
@@ -437,16 +917,20 @@ NAN_METHOD(ODBCResult::FetchSync) {
     if (obj->Has(valueChunkSizeKey) && obj->Get(valueChunkSizeKey)->IsNumber()) {
       valueChunkSize = CLAMP_SIZE_UNSIGNED(obj->Get(valueChunkSizeKey)->NumberValue(), MAX_VALUE_CHUNK_SIZE);
     }
+
+    GetValueOptions(obj, &valueOptions);
   }
-  
-  SQLRETURN ret = SQLFetch(objResult->m_hSTMT);
 
-  if (objResult->colCount == 0) {
-    objResult->columns = ODBC::GetColumns(
-      objResult->m_hSTMT, 
-      &objResult->colCount);
+  //streamed columns need a row to read from
+  if (fetchMode == FETCH_COLUMNAR) {
+    valueOptions.lobMode = LOB_VALUE;
   }
   
+  RowBatch* batch = NULL;
+
+  SQLRETURN ret = objResult->ReadBatch(&batch, NULL, maxValueSize, valueChunkSize, valueOptions, 1, MAX_VALUE_SIZE);
+  objResult->UpdateExternalMemory(batch);
+  
   //check to see if the result has no columns
   if (objResult->colCount == 0) {
     moreWork = false;
@@ -456,10 +940,17 @@ NAN_METHOD(ODBCResult::FetchSync) {
     moreWork = false;
     error = true;
     
-    objError = ODBC::GetSQLError(
-      SQL_HANDLE_STMT, 
-      objResult->m_hSTMT,
-      (char *) "Error in ODBCResult::UV_AfterFetch");
+    if (batch) {
+      objError = batch->getError(
+        objResult->m_hSTMT,
+        (char *) "Error in ODBCResult::UV_AfterFetch");
+    }
+    else {
+      objError = ODBC::GetSQLError(
+        SQL_HANDLE_STMT, 
+        objResult->m_hSTMT,
+        (char *) "Error in ODBCResult::UV_AfterFetch");
+    }
   }
   //check to see if we are at the end of the recordset
   else if (ret == SQL_NO_DATA) {
@@ -469,31 +960,26 @@ NAN_METHOD(ODBCResult::FetchSync) {
   if (moreWork) {
     Local<Value> data;
     
-    if (fetchMode == FETCH_ARRAY) {
-      data = ODBC::GetRecordArray(
-        objResult->m_hSTMT,
-        objResult->columns,
-        &objResult->colCount,
-        objResult->buffer,
-        objResult->bufferLength,
-        maxValueSize,
-        valueChunkSize);
+    if (fetchMode == FETCH_COLUMNAR) {
+      data = batch->getColumnar();
+    }
+    else if (fetchMode == FETCH_ARRAY || fetchMode == FETCH_FLAT) {
+      batch->setStreamOwner(info.Holder(), objResult->m_fetchCount);
+      data = batch->getRecordArray(0);
     }
     else {
-      data = ODBC::GetRecordTuple(
-        objResult->m_hSTMT,
-        objResult->columns,
-        &objResult->colCount,
-        objResult->buffer,
-        objResult->bufferLength,
-        maxValueSize,
-        valueChunkSize);
+      batch->setStreamOwner(info.Holder(), objResult->m_fetchCount);
+      data = batch->getRecordTuple(0, objResult->GetRecordShape());
     }
     
+    delete batch;
+
     info.GetReturnValue().Set(data);
   }
   else {
-    ODBC::FreeColumns(objResult->columns, &objResult->colCount);
+    delete batch;
+
+    objResult->FreeColumns();
 
     //if there was an error, pass that as arg[0] otherwise Null
     if (error) {
@@ -516,6 +1002,11 @@ NAN_METHOD(ODBCResult::FetchAll) {
   Nan::HandleScope scope;
   
   ODBCResult* objODBCResult = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  //the handle is still being read by fetchAll or fetchMany
+  if (objODBCResult->m_isFetching) {
+    return Nan::ThrowError("ODBCResult::FetchAll(): A fetch is already running on this result.");
+  }
   
   uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
   
@@ -527,6 +1018,11 @@ NAN_METHOD(ODBCResult::FetchAll) {
   data->includeMetadata = objODBCResult->m_includeMetadata;
   data->maxValueSize = objODBCResult->m_maxValueSize;
   data->valueChunkSize = objODBCResult->m_valueChunkSize;
+  data->valueOptions = objODBCResult->m_valueOptions;
+  data->rowsetSize = objODBCResult->m_rowsetSize;
+  data->batchSize = objODBCResult->m_batchSize;
+  data->maxBatchBytes = objODBCResult->m_maxBatchBytes;
+  data->limit = SIZE_MAX;
   
   if (info.Length() == 1 && info[0]->IsFunction()) {
     cb = Local<Function>::Cast(info[0]);
@@ -555,10 +1051,30 @@ NAN_METHOD(ODBCResult::FetchAll) {
     if (obj->Has(valueChunkSizeKey) && obj->Get(valueChunkSizeKey)->IsNumber()) {
       data->valueChunkSize = CLAMP_SIZE_UNSIGNED(obj->Get(valueChunkSizeKey)->NumberValue(), MAX_VALUE_CHUNK_SIZE);
     }
+
+    GetValueOptions(obj, &data->valueOptions);
+
+    Local<String> rowsetSizeKey = Nan::New<String>(OPTION_ROWSET_SIZE);
+    if (obj->Has(rowsetSizeKey) && obj->Get(rowsetSizeKey)->IsNumber()) {
+      data->rowsetSize = CLAMP_ROWSET_SIZE(obj->Get(rowsetSizeKey)->NumberValue());
+    }
+
+    Local<String> batchSizeKey = Nan::New<String>(OPTION_BATCH_SIZE);
+    if (obj->Has(batchSizeKey) && obj->Get(batchSizeKey)->IsNumber()) {
+      data->batchSize = CLAMP_BATCH_SIZE(obj->Get(batchSizeKey)->NumberValue());
+    }
+
+    Local<String> maxBatchBytesKey = Nan::New<String>(OPTION_MAX_BATCH_BYTES);
+    if (obj->Has(maxBatchBytesKey) && obj->Get(maxBatchBytesKey)->IsNumber()) {
+      data->maxBatchBytes = CLAMP_SIZE_UNSIGNED(obj->Get(maxBatchBytesKey)->NumberValue(), MAX_VALUE_SIZE);
+    }
   }
   else {
     Nan::ThrowTypeError("ODBCResult::FetchAll(): 1 or 2 arguments are required. The last argument must be a callback function.");
   }
+
+  //long data is only streamed by fetch
+  data->valueOptions.lobMode = LOB_VALUE;
   
   data->rows.Reset(Nan::New<Array>());
   data->errorCount = 0;
@@ -567,13 +1083,20 @@ NAN_METHOD(ODBCResult::FetchAll) {
   
   data->cb = new Nan::Callback(cb);
   data->objResult = objODBCResult;
+  //bound on the thread pool by the first UV_FetchAll
+  data->rowset = NULL;
+  data->isBound = false;
   
   work_req->data = data;
+
+  objODBCResult->m_cancel.isCancelled = false;
+  objODBCResult->m_isFetching = true;
   
-  uv_queue_work(uv_default_loop(),
+  Executor::QueueWork(uv_default_loop(),
     work_req, 
     UV_FetchAll, 
-    (uv_after_work_cb)UV_AfterFetchAll);
+    (uv_after_work_cb)UV_AfterFetchAll,
+    data->objResult->m_lock);
 
   data->objResult->Ref();
 
@@ -585,25 +1108,73 @@ void ODBCResult::UV_FetchAll(uv_work_t* work_req) {
   
   fetch_work_data* data = (fetch_work_data *)(work_req->data);
   
-  data->result = SQLFetch(data->objResult->m_hSTMT);
- }
+  //don't read past the number of rows requested by fetchMany
+  size_t remaining = data->limit - (size_t) data->count;
 
-void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
-  DEBUG_PRINTF("ODBCResult::UV_AfterFetchAll\n");
-  Nan::HandleScope scope;
+  //columnar results collect every row in the same batch
+  if (data->batch && data->fetchMode != FETCH_COLUMNAR) {
+    data->batch->clear();
+  }
+
+  if (remaining == 0) {
+    data->result = SQL_SUCCESS;
+    return;
+  }
+
+  //describing and binding the columns calls the driver too
+  if (!data->isBound) {
+    data->rowset = data->objResult->BindRowset(data->rowsetSize, data->valueOptions);
+    data->isBound = true;
+  }
+
+  //reported as cancelled in UV_AfterFetchAll
+  if (!ODBC::BeginExecute(&data->objResult->m_cancel, data->objResult->m_hSTMT)) {
+    data->result = SQL_ERROR;
+    return;
+  }
+
+  data->result = data->objResult->ReadBatch(
+    &data->batch,
+    data->rowset,
+    data->maxValueSize,
+    data->valueChunkSize,
+    data->valueOptions,
+    remaining < data->batchSize ? remaining : data->batchSize,
+    data->maxBatchBytes);
+
+  ODBC::EndExecute(&data->objResult->m_cancel);
+}
+
+void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
+  DEBUG_PRINTF("ODBCResult::UV_AfterFetchAll\n");
+  Nan::HandleScope scope;
   
   fetch_work_data* data = (fetch_work_data *)(work_req->data);
+  data->objResult->UpdateExternalMemory(data->batch);
   
   ODBCResult* self = data->objResult->self();
   
   bool doMoreWork = true;
   
-  if (self->colCount == 0) {
-    self->columns = ODBC::GetColumns(self->m_hSTMT, &self->colCount);
+  //keep the rows read before an error or the end of the recordset
+  if (data->batch) {
+    self->AppendRecords(data->batch, data->fetchMode, Nan::New(data->rows), &data->count);
+  }
+
+  //a fetch interrupted by SQLCancel fails with whatever the driver reports.
+  //A cancel that came after the batch was read does not discard it.
+  if (data->result == SQL_ERROR && self->m_cancel.isCancelled) {
+    data->errorCount++;
+
+    data->objError.Reset(ODBC::GetError(
+      "[node-odbc] Fetch was cancelled",
+      "ECANCELED",
+      "[node-odbc] Error in ODBCResult::UV_AfterFetchAll"));
+
+    doMoreWork = false;
   }
-  
   //check to see if the result set has columns
-  if (self->colCount == 0) {
+  else if (self->colCount == 0) {
     //this most likely means that the query was something like
     //'insert into ....'
     doMoreWork = false;
@@ -612,12 +1183,19 @@ void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
   else if (data->result == SQL_ERROR)  {
     data->errorCount++;
 
-    //NanAssignPersistent(data->objError, ODBC::GetSQLError(
-    data->objError.Reset(ODBC::GetSQLError(
-        SQL_HANDLE_STMT, 
-        self->m_hSTMT,
-        (char *) "[node-odbc] Error in ODBCResult::UV_AfterFetchAll"
-    ));
+    if (data->batch) {
+      data->objError.Reset(data->batch->getError(
+          self->m_hSTMT,
+          (char *) "[node-odbc] Error in ODBCResult::UV_AfterFetchAll"
+      ));
+    }
+    else {
+      data->objError.Reset(ODBC::GetSQLError(
+          SQL_HANDLE_STMT, 
+          self->m_hSTMT,
+          (char *) "[node-odbc] Error in ODBCResult::UV_AfterFetchAll"
+      ));
+    }
     
     doMoreWork = false;
   }
@@ -625,52 +1203,44 @@ void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
   else if (data->result == SQL_NO_DATA) {
     doMoreWork = false;
   }
-  else {
-    Local<Array> rows = Nan::New(data->rows);
-    if (data->fetchMode == FETCH_ARRAY) {
-      rows->Set(
-        Nan::New(data->count), 
-        ODBC::GetRecordArray(
-          self->m_hSTMT,
-          self->columns,
-          &self->colCount,
-          self->buffer,
-          self->bufferLength,
-          data->maxValueSize,
-          data->valueChunkSize)
-      );
-    }
-    else {
-      rows->Set(
-        Nan::New(data->count), 
-        ODBC::GetRecordTuple(
-          self->m_hSTMT,
-          self->columns,
-          &self->colCount,
-          self->buffer,
-          self->bufferLength,
-          data->maxValueSize,
-          data->valueChunkSize)
-      );
-    }
-    data->count++;
+  //check to see if fetchMany has all of its rows
+  else if ((size_t) data->count >= data->limit) {
+    doMoreWork = false;
   }
   
   if (doMoreWork) {
     //Go back to the thread pool and fetch more data!
-    uv_queue_work(
+    Executor::QueueWork(
       uv_default_loop(),
       work_req, 
       UV_FetchAll, 
-      (uv_after_work_cb)UV_AfterFetchAll);
+      (uv_after_work_cb)UV_AfterFetchAll,
+      self->m_lock);
   }
   else {
+    Local<Array> rows = Nan::New(data->rows);
+
+    if (data->batch && data->fetchMode == FETCH_COLUMNAR) {
+      rows = data->batch->getColumnar();
+    }
+
+    delete data->batch;
+    data->batch = NULL;
+
+    if (data->rowset) {
+      delete data->rowset;
+      data->rowset = NULL;
+    }
+
     Local<Array> columnMetadata;
     if (data->includeMetadata) {
       columnMetadata = ODBC::GetColumnMetadata(self->columns, &self->colCount);
     }
 
-    ODBC::FreeColumns(self->columns, &self->colCount);
+    //keep the columns if fetchMany stopped before the end of the recordset
+    if (data->limit > 0 && (data->result != SQL_SUCCESS || self->colCount == 0)) {
+      self->FreeColumns();
+    }
     
     Local<Value> info[2];
     
@@ -684,12 +1254,15 @@ void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
     if (data->includeMetadata) {
       Local<Object> resultObj = Nan::New<Object>();
       resultObj->Set(Nan::New<String>("metadata").ToLocalChecked(), columnMetadata);
-      resultObj->Set(Nan::New<String>("rows").ToLocalChecked(), Nan::New(data->rows));
+      resultObj->Set(Nan::New<String>("rows").ToLocalChecked(), rows);
       info[1] = resultObj;
     } else {
-      info[1] = Nan::New(data->rows);
+      info[1] = rows;
     }
 
+    //the callback can start the next fetch
+    self->m_isFetching = false;
+
     Nan::TryCatch try_catch;
 
     data->cb->Call(2, info);
@@ -708,6 +1281,113 @@ void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
   }
 }
 
+/*
+ * FetchMany
+ *
+ * Fetches up to count rows. Unlike fetchAll, the rows are read one at a time
+ * rather than through a block cursor so that no fetched rows are discarded
+ * when count is reached.
+ */
+
+NAN_METHOD(ODBCResult::FetchMany) {
+  DEBUG_PRINTF("ODBCResult::FetchMany\n");
+  Nan::HandleScope scope;
+  
+  ODBCResult* objODBCResult = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  //the handle is still being read by fetchAll or fetchMany
+  if (objODBCResult->m_isFetching) {
+    return Nan::ThrowError("ODBCResult::FetchMany(): A fetch is already running on this result.");
+  }
+  
+  Local<Function> cb;
+  
+  if (info.Length() == 2 && info[0]->IsNumber() && info[1]->IsFunction()) {
+    cb = Local<Function>::Cast(info[1]);
+  }
+  else if (info.Length() == 3 && info[0]->IsNumber() && info[1]->IsObject() && info[2]->IsFunction()) {
+    cb = Local<Function>::Cast(info[2]);
+  }
+  else {
+    return Nan::ThrowTypeError("ODBCResult::FetchMany(): 2 or 3 arguments are required. The first argument must be a number and the last argument must be a callback function.");
+  }
+  
+  uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
+  
+  fetch_work_data* data = (fetch_work_data *) calloc(1, sizeof(fetch_work_data));
+  
+  double count = info[0]->NumberValue();
+
+  data->fetchMode = objODBCResult->m_fetchMode;
+  data->maxValueSize = objODBCResult->m_maxValueSize;
+  data->valueChunkSize = objODBCResult->m_valueChunkSize;
+  data->valueOptions = objODBCResult->m_valueOptions;
+  data->batchSize = objODBCResult->m_batchSize;
+  data->maxBatchBytes = objODBCResult->m_maxBatchBytes;
+  data->limit = count > 0 ? CLAMP_SIZE_UNSIGNED(count, SIZE_MAX) : 0;
+  
+  if (info.Length() == 3) {
+    Local<Object> obj = info[1]->ToObject();
+    
+    Local<String> fetchModeKey = Nan::New<String>(OPTION_FETCH_MODE);
+    if (obj->Has(fetchModeKey) && obj->Get(fetchModeKey)->IsInt32()) {
+      data->fetchMode = obj->Get(fetchModeKey)->ToInt32()->Value();
+    }
+
+    Local<String> maxValueSizeKey = Nan::New<String>(OPTION_MAX_VALUE_SIZE);
+    if (obj->Has(maxValueSizeKey) && obj->Get(maxValueSizeKey)->IsNumber()) {
+      data->maxValueSize = CLAMP_SIZE_UNSIGNED(obj->Get(maxValueSizeKey)->NumberValue(), MAX_VALUE_SIZE);
+    }
+
+    Local<String> valueChunkSizeKey = Nan::New<String>(OPTION_VALUE_CHUNK_SIZE);
+    if (obj->Has(valueChunkSizeKey) && obj->Get(valueChunkSizeKey)->IsNumber()) {
+      data->valueChunkSize = CLAMP_SIZE_UNSIGNED(obj->Get(valueChunkSizeKey)->NumberValue(), MAX_VALUE_CHUNK_SIZE);
+    }
+
+    GetValueOptions(obj, &data->valueOptions);
+
+    Local<String> batchSizeKey = Nan::New<String>(OPTION_BATCH_SIZE);
+    if (obj->Has(batchSizeKey) && obj->Get(batchSizeKey)->IsNumber()) {
+      data->batchSize = CLAMP_BATCH_SIZE(obj->Get(batchSizeKey)->NumberValue());
+    }
+
+    Local<String> maxBatchBytesKey = Nan::New<String>(OPTION_MAX_BATCH_BYTES);
+    if (obj->Has(maxBatchBytesKey) && obj->Get(maxBatchBytesKey)->IsNumber()) {
+      data->maxBatchBytes = CLAMP_SIZE_UNSIGNED(obj->Get(maxBatchBytesKey)->NumberValue(), MAX_VALUE_SIZE);
+    }
+  }
+  
+  data->rows.Reset(Nan::New<Array>());
+  data->errorCount = 0;
+  data->count = 0;
+  data->objError.Reset(Nan::New<Object>());
+
+  //rows are read one at a time without a rowset
+  data->rowset = NULL;
+  data->isBound = true;
+  
+  //long data is only streamed by fetch
+  data->valueOptions.lobMode = LOB_VALUE;
+  
+  data->cb = new Nan::Callback(cb);
+  data->objResult = objODBCResult;
+  
+  work_req->data = data;
+
+  objODBCResult->m_cancel.isCancelled = false;
+  objODBCResult->m_isFetching = true;
+  
+  Executor::QueueWork(uv_default_loop(),
+    work_req, 
+    UV_FetchAll, 
+    (uv_after_work_cb)UV_AfterFetchAll,
+    data->objResult->m_lock);
+
+  data->objResult->Ref();
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
 /*
  * FetchAllSync
  */
@@ -717,6 +1397,11 @@ NAN_METHOD(ODBCResult::FetchAllSync) {
   Nan::HandleScope scope;
   
   ODBCResult* self = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  //the handle is still being read by fetchAll or fetchMany
+  if (self->m_isFetching) {
+    return Nan::ThrowError("ODBCResult::FetchAllSync(): A fetch is already running on this result.");
+  }
   
   Local<Value> objError = Nan::New<Object>();
   
@@ -728,6 +1413,10 @@ NAN_METHOD(ODBCResult::FetchAllSync) {
   bool includeMetadata = self->m_includeMetadata;
   size_t maxValueSize = self->m_maxValueSize;
   size_t valueChunkSize = self->m_valueChunkSize;
+  ValueOptions valueOptions = self->m_valueOptions;
+  size_t rowsetSize = self->m_rowsetSize;
+  size_t batchSize = self->m_batchSize;
+  size_t maxBatchBytes = self->m_maxBatchBytes;
 
   if (info.Length() == 1 && info[0]->IsObject()) {
     Local<Object> obj = info[0]->ToObject();
@@ -751,12 +1440,34 @@ NAN_METHOD(ODBCResult::FetchAllSync) {
     if (obj->Has(valueChunkSizeKey) && obj->Get(valueChunkSizeKey)->IsNumber()) {
       valueChunkSize = CLAMP_SIZE_UNSIGNED(obj->Get(valueChunkSizeKey)->NumberValue(), MAX_VALUE_CHUNK_SIZE);
     }
+
+    GetValueOptions(obj, &valueOptions);
+
+    Local<String> rowsetSizeKey = Nan::New<String>(OPTION_ROWSET_SIZE);
+    if (obj->Has(rowsetSizeKey) && obj->Get(rowsetSizeKey)->IsNumber()) {
+      rowsetSize = CLAMP_ROWSET_SIZE(obj->Get(rowsetSizeKey)->NumberValue());
+    }
+
+    Local<String> batchSizeKey = Nan::New<String>(OPTION_BATCH_SIZE);
+    if (obj->Has(batchSizeKey) && obj->Get(batchSizeKey)->IsNumber()) {
+      batchSize = CLAMP_BATCH_SIZE(obj->Get(batchSizeKey)->NumberValue());
+    }
+
+    Local<String> maxBatchBytesKey = Nan::New<String>(OPTION_MAX_BATCH_BYTES);
+    if (obj->Has(maxBatchBytesKey) && obj->Get(maxBatchBytesKey)->IsNumber()) {
+      maxBatchBytes = CLAMP_SIZE_UNSIGNED(obj->Get(maxBatchBytesKey)->NumberValue(), MAX_VALUE_SIZE);
+    }
   }
   
+  //long data is only streamed by fetch
+  valueOptions.lobMode = LOB_VALUE;
+  
   if (self->colCount == 0) {
     self->columns = ODBC::GetColumns(self->m_hSTMT, &self->colCount);
   }
 
+  Rowset* rowset = self->BindRowset(rowsetSize, valueOptions);
+
   Local<Array> columnMetadata;
   if (includeMetadata) {
     columnMetadata = ODBC::GetColumnMetadata(self->columns, &self->colCount);
@@ -764,64 +1475,80 @@ NAN_METHOD(ODBCResult::FetchAllSync) {
 
   Local<Array> rows = Nan::New<Array>();
 
+  RowBatch* batch = NULL;
+
   //Only loop through the recordset if there are columns
   if (self->colCount > 0) {
     //loop through all records
     while (true) {
-      ret = SQLFetch(self->m_hSTMT);
+      //columnar results collect every row in the same batch
+      if (batch && fetchMode != FETCH_COLUMNAR) {
+        batch->clear();
+      }
+
+      ret = self->ReadBatch(&batch, rowset, maxValueSize, valueChunkSize, valueOptions, batchSize, maxBatchBytes);
+      self->UpdateExternalMemory(batch);
+
+      //keep the rows read before an error or the end of the recordset
+      if (batch) {
+        self->AppendRecords(batch, fetchMode, rows, &count);
+      }
       
       //check to see if there was an error
       if (ret == SQL_ERROR)  {
         errorCount++;
         
-        objError = ODBC::GetSQLError(
-          SQL_HANDLE_STMT, 
-          self->m_hSTMT,
-          (char *) "[node-odbc] Error in ODBCResult::UV_AfterFetchAll; probably"
-            " your query did not have a result set."
-        );
+        if (batch) {
+          objError = batch->getError(
+            self->m_hSTMT,
+            (char *) "[node-odbc] Error in ODBCResult::UV_AfterFetchAll; probably"
+              " your query did not have a result set."
+          );
+        }
+        else {
+          objError = ODBC::GetSQLError(
+            SQL_HANDLE_STMT, 
+            self->m_hSTMT,
+            (char *) "[node-odbc] Error in ODBCResult::UV_AfterFetchAll; probably"
+              " your query did not have a result set."
+          );
+        }
         
         break;
       }
       
       //check to see if we are at the end of the recordset
       if (ret == SQL_NO_DATA) {
-        ODBC::FreeColumns(self->columns, &self->colCount);
+        if (batch && fetchMode == FETCH_COLUMNAR) {
+          rows = batch->getColumnar();
+        }
+
+        delete batch;
+        batch = NULL;
+
+        if (rowset) {
+          delete rowset;
+          rowset = NULL;
+        }
+
+        self->FreeColumns();
         
         break;
       }
-
-      if (fetchMode == FETCH_ARRAY) {
-        rows->Set(
-          Nan::New(count), 
-          ODBC::GetRecordArray(
-            self->m_hSTMT,
-            self->columns,
-            &self->colCount,
-            self->buffer,
-            self->bufferLength,
-            maxValueSize,
-            valueChunkSize)
-        );
-      }
-      else {
-        rows->Set(
-          Nan::New(count), 
-          ODBC::GetRecordTuple(
-            self->m_hSTMT,
-            self->columns,
-            &self->colCount,
-            self->buffer,
-            self->bufferLength,
-            maxValueSize,
-            valueChunkSize)
-        );
-      }
-      count++;
     }
   }
   else {
-    ODBC::FreeColumns(self->columns, &self->colCount);
+    self->FreeColumns();
+  }
+
+  if (batch && fetchMode == FETCH_COLUMNAR) {
+    rows = batch->getColumnar();
+  }
+
+  delete batch;
+
+  if (rowset) {
+    delete rowset;
   }
   
   //throw the error object if there were errors
@@ -840,6 +1567,152 @@ NAN_METHOD(ODBCResult::FetchAllSync) {
   }
 }
 
+/*
+ * GetData
+ *
+ * Reads the next part of a streamed column of the current row with
+ * SQLGetData. Calls back with a Buffer of at most size bytes, or null once
+ * the value has been read. Fails if the result has been fetched from since
+ * the row was returned.
+ */
+
+NAN_METHOD(ODBCResult::GetData) {
+  DEBUG_PRINTF("ODBCResult::GetData\n");
+  Nan::HandleScope scope;
+
+  ODBCResult* objODBCResult = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  if (info.Length() != 4 || !info[0]->IsInt32() || !info[1]->IsNumber() ||
+      !info[2]->IsNumber() || !info[3]->IsFunction()) {
+    return Nan::ThrowTypeError("ODBCResult::GetData(): column, fetch count, size and callback function are required.");
+  }
+
+  uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
+
+  get_data_work_data* data = (get_data_work_data *) calloc(1, sizeof(get_data_work_data));
+
+  data->column = (short) info[0]->Int32Value();
+  data->fetchCount = (size_t) info[1]->NumberValue();
+  data->size = CLAMP_SIZE_UNSIGNED(info[2]->NumberValue(), MAX_VALUE_CHUNK_SIZE);
+
+  // Leave room for a null terminator and at least one character
+  if (data->size < 2 * sizeof(uint16_t)) { data->size = 2 * sizeof(uint16_t); }
+  if (data->size > MAX_VALUE_CHUNK_SIZE) { data->size = MAX_VALUE_CHUNK_SIZE; }
+
+  data->cb = new Nan::Callback(Local<Function>::Cast(info[3]));
+  data->objResult = objODBCResult;
+  work_req->data = data;
+
+  Executor::QueueWork(
+    uv_default_loop(),
+    work_req,
+    UV_GetData,
+    (uv_after_work_cb)UV_AfterGetData,
+    data->objResult->m_lock);
+
+  objODBCResult->Ref();
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+void ODBCResult::UV_GetData(uv_work_t* work_req) {
+  DEBUG_PRINTF("ODBCResult::UV_GetData\n");
+
+  get_data_work_data* data = (get_data_work_data *)(work_req->data);
+  ODBCResult* self = data->objResult;
+
+  if (!self->m_hSTMT || data->column < 0 || data->column >= self->colCount ||
+      data->fetchCount != self->m_fetchCount) {
+    data->errorMessage = "[node-odbc] Column stream is no longer positioned on its row";
+    data->errorCode = "24000";
+    data->result = SQL_ERROR;
+    return;
+  }
+
+  Column& column = self->columns[data->column];
+  SQLSMALLINT cType = RowBatch::GetStreamType(column);
+  size_t terminatorSize = cType == SQL_C_WCHAR ? sizeof(uint16_t) : (cType == SQL_C_CHAR ? sizeof(char) : 0);
+
+  data->data = (uint8_t *) malloc(data->size);
+
+  if (!data->data) {
+    data->errorMessage = "[node-odbc] Failed to allocate buffer for column data";
+    data->errorCode = "ENOMEM";
+    data->result = SQL_ERROR;
+    return;
+  }
+
+  SQLLEN len = 0;
+
+  data->result = SQLGetData(
+    self->m_hSTMT,
+    column.index,
+    cType,
+    data->data,
+    data->size,
+    &len);
+
+  DEBUG_PRINTF("ODBCResult::UV_GetData - index=%u size=%zu len=%zi ret=%i\n",
+               column.index, data->size, len, data->result);
+
+  if (!SQL_SUCCEEDED(data->result) || len == SQL_NULL_DATA) {
+    return;
+  }
+
+  size_t availableSize = data->size - terminatorSize;
+  if (cType == SQL_C_WCHAR) { availableSize -= availableSize % sizeof(uint16_t); }
+
+  data->length = len != SQL_NO_TOTAL && (size_t) len <= availableSize ? (size_t) len : availableSize;
+
+  // The last part of a value is usually shorter than the buffer
+  if (data->length > 0 && data->length < data->size / 2) {
+    uint8_t* shrunk = (uint8_t *) realloc(data->data, data->length);
+    if (shrunk) { data->data = shrunk; }
+  }
+}
+
+void ODBCResult::UV_AfterGetData(uv_work_t* work_req, int status) {
+  DEBUG_PRINTF("ODBCResult::UV_AfterGetData\n");
+  Nan::HandleScope scope;
+
+  get_data_work_data* data = (get_data_work_data *)(work_req->data);
+
+  Local<Value> info[2];
+
+  info[0] = Nan::Null();
+  info[1] = Nan::Null();
+
+  if (data->errorMessage) {
+    info[0] = ODBC::GetError(data->errorMessage, data->errorCode, "[node-odbc] Error in ODBCResult::GetData");
+  }
+  else if (!SQL_SUCCEEDED(data->result) && data->result != SQL_NO_DATA) {
+    info[0] = ODBC::GetSQLError(
+      SQL_HANDLE_STMT,
+      data->objResult->m_hSTMT,
+      (char *) "[node-odbc] Error in ODBCResult::GetData");
+  }
+  else if (data->result != SQL_NO_DATA) {
+    // The Buffer takes ownership of the data
+    info[1] = Nan::NewBuffer((char *) data->data, (uint32_t) data->length).ToLocalChecked();
+    data->data = NULL;
+  }
+
+  Nan::TryCatch try_catch;
+
+  data->cb->Call(2, info);
+  delete data->cb;
+
+  if (try_catch.HasCaught()) {
+    Nan::FatalException(try_catch);
+  }
+
+  data->objResult->Unref();
+
+  free(data->data);
+  free(data);
+  free(work_req);
+}
+
 /*
  * CloseSync
  * 
@@ -861,18 +1734,18 @@ NAN_METHOD(ODBCResult::CloseSync) {
   }
   else if (closeOption == SQL_DESTROY && !result->m_canFreeHandle) {
     //We technically can't free the handle so, we'll SQL_CLOSE
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+    result->m_lock->lock();
     
     SQLFreeStmt(result->m_hSTMT, SQL_CLOSE);
   
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    result->m_lock->unlock();
   }
   else {
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+    result->m_lock->lock();
     
     SQLFreeStmt(result->m_hSTMT, closeOption);
   
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    result->m_lock->unlock();
   }
   
   info.GetReturnValue().Set(Nan::True());
@@ -885,6 +1758,10 @@ NAN_METHOD(ODBCResult::MoreResultsSync) {
   ODBCResult* result = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
   
   SQLRETURN ret = SQLMoreResults(result->m_hSTMT);
+  result->m_fetchCount++;
+
+  //the next result set is described when it is fetched
+  result->FreeColumns();
 
   if (ret == SQL_ERROR) {
     Local<Value> objError = ODBC::GetSQLError(
@@ -961,3 +1838,162 @@ NAN_METHOD(ODBCResult::GetRowCountSync) {
 
   info.GetReturnValue().Set(Nan::New<Number>(count));
 }
+
+/*
+ * CancelSync
+ *
+ * Stops a running fetchAll or fetchMany, which calls back with an ECANCELED
+ * error, and calls SQLCancel if a batch is being read from the driver.
+ * Returns whether there was a fetch to cancel.
+ */
+
+NAN_METHOD(ODBCResult::CancelSync) {
+  DEBUG_PRINTF("ODBCResult::CancelSync\n");
+  Nan::HandleScope scope;
+
+  ODBCResult* self = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  bool cancelled = self->m_isFetching && ODBC::CancelExecute(&self->m_cancel);
+
+  info.GetReturnValue().Set(cancelled ? Nan::True() : Nan::False());
+}
+
+/*
+ * FetchManySync
+ */
+
+NAN_METHOD(ODBCResult::FetchManySync) {
+  DEBUG_PRINTF("ODBCResult::FetchManySync\n");
+  Nan::HandleScope scope;
+  
+  ODBCResult* self = Nan::ObjectWrap::Unwrap<ODBCResult>(info.Holder());
+
+  //the handle is still being read by fetchAll or fetchMany
+  if (self->m_isFetching) {
+    return Nan::ThrowError("ODBCResult::FetchManySync(): A fetch is already running on this result.");
+  }
+  
+  if (info.Length() < 1 || !info[0]->IsNumber()) {
+    return Nan::ThrowTypeError("ODBCResult::FetchManySync(): The first argument must be a number.");
+  }
+
+  Local<Value> objError = Nan::New<Object>();
+  
+  SQLRETURN ret = SQL_SUCCESS;
+  int count = 0;
+  int errorCount = 0;
+
+  double requested = info[0]->NumberValue();
+  size_t limit = requested > 0 ? CLAMP_SIZE_UNSIGNED(requested, SIZE_MAX) : 0;
+
+  int fetchMode = self->m_fetchMode;
+  size_t maxValueSize = self->m_maxValueSize;
+  size_t valueChunkSize = self->m_valueChunkSize;
+  ValueOptions valueOptions = self->m_valueOptions;
+  size_t batchSize = self->m_batchSize;
+  size_t maxBatchBytes = self->m_maxBatchBytes;
+
+  if (info.Length() == 2 && info[1]->IsObject()) {
+    Local<Object> obj = info[1]->ToObject();
+    
+    Local<String> fetchModeKey = Nan::New<String>(OPTION_FETCH_MODE);
+    if (obj->Has(fetchModeKey) && obj->Get(fetchModeKey)->IsInt32()) {
+      fetchMode = obj->Get(fetchModeKey)->ToInt32()->Value();
+    }
+
+    Local<String> maxValueSizeKey = Nan::New<String>(OPTION_MAX_VALUE_SIZE);
+    if (obj->Has(maxValueSizeKey) && obj->Get(maxValueSizeKey)->IsNumber()) {
+      maxValueSize = CLAMP_SIZE_UNSIGNED(obj->Get(maxValueSizeKey)->NumberValue(), MAX_VALUE_SIZE);
+    }
+
+    Local<String> valueChunkSizeKey = Nan::New<String>(OPTION_VALUE_CHUNK_SIZE);
+    if (obj->Has(valueChunkSizeKey) && obj->Get(valueChunkSizeKey)->IsNumber()) {
+      valueChunkSize = CLAMP_SIZE_UNSIGNED(obj->Get(valueChunkSizeKey)->NumberValue(), MAX_VALUE_CHUNK_SIZE);
+    }
+
+    GetValueOptions(obj, &valueOptions);
+
+    Local<String> batchSizeKey = Nan::New<String>(OPTION_BATCH_SIZE);
+    if (obj->Has(batchSizeKey) && obj->Get(batchSizeKey)->IsNumber()) {
+      batchSize = CLAMP_BATCH_SIZE(obj->Get(batchSizeKey)->NumberValue());
+    }
+
+    Local<String> maxBatchBytesKey = Nan::New<String>(OPTION_MAX_BATCH_BYTES);
+    if (obj->Has(maxBatchBytesKey) && obj->Get(maxBatchBytesKey)->IsNumber()) {
+      maxBatchBytes = CLAMP_SIZE_UNSIGNED(obj->Get(maxBatchBytesKey)->NumberValue(), MAX_VALUE_SIZE);
+    }
+  }
+
+  //long data is only streamed by fetch
+  valueOptions.lobMode = LOB_VALUE;
+
+  Local<Array> rows = Nan::New<Array>();
+  RowBatch* batch = NULL;
+
+  while ((size_t) count < limit) {
+    size_t remaining = limit - (size_t) count;
+
+    //columnar results collect every row in the same batch
+    if (batch && fetchMode != FETCH_COLUMNAR) {
+      batch->clear();
+    }
+
+    ret = self->ReadBatch(&batch, NULL, maxValueSize, valueChunkSize, valueOptions,
+                          remaining < batchSize ? remaining : batchSize, maxBatchBytes);
+    self->UpdateExternalMemory(batch);
+
+    //keep the rows read before an error or the end of the recordset
+    if (batch) {
+      self->AppendRecords(batch, fetchMode, rows, &count);
+    }
+
+    //check to see if the result has no columns
+    if (self->colCount == 0) {
+      break;
+    }
+
+    //check to see if there was an error
+    if (ret == SQL_ERROR)  {
+      errorCount++;
+      
+      if (batch) {
+        objError = batch->getError(
+          self->m_hSTMT,
+          (char *) "[node-odbc] Error in ODBCResult::FetchManySync"
+        );
+      }
+      else {
+        objError = ODBC::GetSQLError(
+          SQL_HANDLE_STMT, 
+          self->m_hSTMT,
+          (char *) "[node-odbc] Error in ODBCResult::FetchManySync"
+        );
+      }
+      
+      break;
+    }
+
+    //check to see if we are at the end of the recordset
+    if (ret == SQL_NO_DATA) {
+      break;
+    }
+  }
+
+  if (batch && fetchMode == FETCH_COLUMNAR) {
+    rows = batch->getColumnar();
+  }
+
+  delete batch;
+
+  //keep the columns if we stopped before the end of the recordset
+  if (limit > 0 && (ret != SQL_SUCCESS || self->colCount == 0)) {
+    self->FreeColumns();
+  }
+
+  //throw the error object if there were errors
+  if (errorCount > 0) {
+    Nan::ThrowError(objError);
+  }
+
+  info.GetReturnValue().Set(rows);
+}
@@ -22,15 +22,32 @@
 
 #include <nan.h>
 
+#include "record_shape.h"
+
+class Rowset;
+class RowBatch;
+class ResultShape;
+class HandleLock;
+struct StatementLease;
+
 class ODBCResult : public Nan::ObjectWrap {
   public:
    static Nan::Persistent<String> OPTION_FETCH_MODE;
    static Nan::Persistent<String> OPTION_INCLUDE_METADATA;
    static Nan::Persistent<String> OPTION_MAX_VALUE_SIZE;
    static Nan::Persistent<String> OPTION_VALUE_CHUNK_SIZE;
+   static Nan::Persistent<String> OPTION_ROWSET_SIZE;
+   static Nan::Persistent<String> OPTION_BATCH_SIZE;
+   static Nan::Persistent<String> OPTION_MAX_BATCH_BYTES;
+   static Nan::Persistent<String> OPTION_BIGINT_MODE;
+   static Nan::Persistent<String> OPTION_DECIMAL_MODE;
+   static Nan::Persistent<String> OPTION_DATE_MODE;
+   static Nan::Persistent<String> OPTION_DATE_FRACTION;
+   static Nan::Persistent<String> OPTION_LOB_MODE;
 
    static Nan::Persistent<Function> constructor;
    static void Init(v8::Handle<Object> exports);
+   static void SetValueOptions(Local<Object> result, ValueOptions& valueOptions);
    
    void Free();
    
@@ -61,6 +78,13 @@ public:
 protected:
     static void UV_FetchAll(uv_work_t* work_req);
     static void UV_AfterFetchAll(uv_work_t* work_req, int status);
+
+public:
+    static NAN_METHOD(FetchMany);
+    static NAN_METHOD(GetData);
+protected:
+    static void UV_GetData(uv_work_t* work_req);
+    static void UV_AfterGetData(uv_work_t* work_req, int status);
     
     //sync methods
 public:
@@ -68,9 +92,11 @@ public:
     static NAN_METHOD(MoreResultsSync);
     static NAN_METHOD(FetchSync);
     static NAN_METHOD(FetchAllSync);
+    static NAN_METHOD(FetchManySync);
     static NAN_METHOD(GetColumnNamesSync);
     static NAN_METHOD(GetColumnMetadataSync);
     static NAN_METHOD(GetRowCountSync);
+    static NAN_METHOD(CancelSync);
     
     //property getter/setters
     static NAN_GETTER(FetchModeGetter);
@@ -81,6 +107,22 @@ public:
     static NAN_SETTER(MaxValueSizeSetter);
     static NAN_GETTER(ValueChunkSizeGetter);
     static NAN_SETTER(ValueChunkSizeSetter);
+    static NAN_GETTER(RowsetSizeGetter);
+    static NAN_SETTER(RowsetSizeSetter);
+    static NAN_GETTER(BatchSizeGetter);
+    static NAN_SETTER(BatchSizeSetter);
+    static NAN_GETTER(MaxBatchBytesGetter);
+    static NAN_SETTER(MaxBatchBytesSetter);
+    static NAN_GETTER(BigIntModeGetter);
+    static NAN_SETTER(BigIntModeSetter);
+    static NAN_GETTER(DecimalModeGetter);
+    static NAN_SETTER(DecimalModeSetter);
+    static NAN_GETTER(DateModeGetter);
+    static NAN_SETTER(DateModeSetter);
+    static NAN_GETTER(DateFractionGetter);
+    static NAN_SETTER(DateFractionSetter);
+    static NAN_GETTER(LobModeGetter);
+    static NAN_SETTER(LobModeSetter);
 
 protected:
     struct fetch_work_data {
@@ -92,15 +134,50 @@ protected:
       bool includeMetadata;
       size_t maxValueSize;
       size_t valueChunkSize;
+      ValueOptions valueOptions;
+      size_t rowsetSize;
+      size_t batchSize;
+      size_t maxBatchBytes;
+      size_t limit;
+
+      // Bound by the first UV_FetchAll, NULL to fetch a row at a time
+      Rowset *rowset;
+      bool isBound;
+      RowBatch *batch;
 
       int count;
       int errorCount;
       Nan::Persistent<Array> rows;
       Nan::Persistent<Object> objError;
     };
+
+    struct get_data_work_data {
+      Nan::Callback* cb;
+      ODBCResult *objResult;
+      SQLRETURN result;
+
+      short column;
+      size_t fetchCount;
+      size_t size;
+      uint8_t *data;
+      size_t length;
+      const char *errorMessage;
+      const char *errorCode;
+    };
     
     ODBCResult *self(void) { return this; }
 
+    static void GetValueOptions(Local<Object> obj, ValueOptions* valueOptions);
+
+    Rowset *BindRowset(size_t rowsetSize, ValueOptions& valueOptions);
+    void AppendRecords(RowBatch* batch, int fetchMode, Local<Array> rows, int* count);
+    RecordShape* GetRecordShape();
+    void FreeColumns();
+    bool AcquireBuffer();
+    void ReleaseBuffer();
+    void UpdateExternalMemory(RowBatch* batch = NULL);
+    SQLRETURN ReadBatch(RowBatch** batch, Rowset* rowset, size_t maxValueSize, size_t valueChunkSize, ValueOptions& valueOptions, size_t batchSize, size_t maxBatchBytes);
+
   protected:
     HENV m_hENV;
     HDBC m_hDBC;
@@ -111,11 +188,29 @@ protected:
     bool m_includeMetadata;
     size_t m_maxValueSize;
     size_t m_valueChunkSize;
+    size_t m_rowsetSize;
+    size_t m_batchSize;
+    size_t m_maxBatchBytes;
+    ValueOptions m_valueOptions;
+    // Number of fetches, to tell whether streamed columns are still on their row
+    size_t m_fetchCount;
+    // Set from the start of fetchAll or fetchMany until it calls back
+    bool m_isFetching;
+    // Lets cancelSync interrupt the batch being read on the thread pool
+    CancelState m_cancel;
     
     uint8_t *buffer;
     int bufferLength;
+    int m_externalMemory;
     Column *columns;
     short colCount;
+    RecordShape m_recordShape;
+    // Shape the columns were taken from when described on execute
+    ResultShape *m_shape;
+    // Set when the statement is returned to a statement cache on free
+    StatementLease *m_lease;
+    // Shared with the connection
+    HandleLock *m_lock;
 };
 
 
@@ -27,6 +27,7 @@
 #include "odbc_connection.h"
 #include "odbc_result.h"
 #include "odbc_statement.h"
+#include "executor.h"
 
 #include "util.h"
 
@@ -67,6 +68,21 @@ void ODBCStatement::Init(v8::Handle<Object> exports) {
   
   Nan::SetPrototypeMethod(t, "closeSync", CloseSync);
 
+  Nan::SetPrototypeMethod(t, "getMetadataCacheStatsSync", GetMetadataCacheStatsSync);
+  Nan::SetPrototypeMethod(t, "clearMetadataCacheSync", ClearMetadataCacheSync);
+  Nan::SetPrototypeMethod(t, "cancelSync", CancelSync);
+
+  // Properties
+  Nan::SetAccessor(instance_template, Nan::New("rowsetSize").ToLocalChecked(), RowsetSizeGetter, RowsetSizeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("bigintMode").ToLocalChecked(), BigIntModeGetter, BigIntModeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("decimalMode").ToLocalChecked(), DecimalModeGetter, DecimalModeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("dateMode").ToLocalChecked(), DateModeGetter, DateModeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("dateFraction").ToLocalChecked(), DateFractionGetter, DateFractionSetter);
+  Nan::SetAccessor(instance_template, Nan::New("lobMode").ToLocalChecked(), LobModeGetter, LobModeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("metadataCacheSize").ToLocalChecked(), MetadataCacheSizeGetter, MetadataCacheSizeSetter);
+  Nan::SetAccessor(instance_template, Nan::New("asyncExecution").ToLocalChecked(), AsyncExecutionGetter, AsyncExecutionSetter);
+  Nan::SetAccessor(instance_template, Nan::New("queryTimeout").ToLocalChecked(), QueryTimeoutGetter, QueryTimeoutSetter);
+
   // Attach the Database Constructor to the target object
   constructor.Reset(t->GetFunction());
   exports->Set(Nan::New("ODBCStatement").ToLocalChecked(), t->GetFunction());
@@ -74,6 +90,10 @@ void ODBCStatement::Init(v8::Handle<Object> exports) {
 
 ODBCStatement::~ODBCStatement() {
   this->Free();
+
+  ODBC::FreeCancelState(&m_cancel);
+
+  m_lock->unref();
 }
 
 void ODBCStatement::Free() {
@@ -101,17 +121,24 @@ void ODBCStatement::Free() {
     free(params);
   }
   
-  if (m_hSTMT) {
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+  if (m_hSTMT && m_lease) {
+    //the handle is reused by statements without a timeout
+    if (m_queryTimeout) {
+      ODBC::SetQueryTimeout(m_hSTMT, 0);
+    }
+
+    m_lease->cache->release(m_lease);
+
+    m_lease = NULL;
+    m_hSTMT = NULL;
+  }
+  else if (m_hSTMT) {
+    m_lock->lock();
     
     SQLFreeHandle(SQL_HANDLE_STMT, m_hSTMT);
     m_hSTMT = NULL;
     
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
-    
-    if (bufferLength > 0) {
-      free(buffer);
-    }
+    m_lock->unlock();
   }
 }
 
@@ -129,25 +156,226 @@ NAN_METHOD(ODBCStatement::New) {
   
   //create a new OBCResult object
   ODBCStatement* stmt = new ODBCStatement(hENV, hDBC, hSTMT);
-  
-  //specify the buffer length
-  stmt->bufferLength = ALIGN_SIZE(FIXED_BUFFER_SIZE);
-  
-  //initialze a buffer for this object
-  stmt->buffer = (uint8_t *) malloc(stmt->bufferLength);
-  //TODO: make sure the malloc succeeded
 
+  //take the lease of a recycled handle
+  stmt->m_lease = NULL;
+
+  if (info.Length() > 3 && info[3]->IsExternal()) {
+    stmt->m_lease = static_cast<StatementLease *>(info[3].As<External>()->Value());
+  }
+
+  //share the lock of the connection, or lock across the process
+  if (info.Length() > 4 && info[4]->IsExternal()) {
+    stmt->m_lock = static_cast<HandleLock *>(info[4].As<External>()->Value());
+  } else {
+    stmt->m_lock = new HandleLock(THREADING_PROCESS, NULL);
+  }
+
+  stmt->m_lock->ref();
+  
   //set the initial colCount to 0
   stmt->colCount = 0;
   
   //initialize the paramCount
   stmt->paramCount = 0;
+
+  //set option defaults
+  stmt->m_rowsetSize = ROWSET_SIZE_DEFAULT;
+  stmt->m_valueOptions.bigintMode = BIGINT_STRING;
+  stmt->m_valueOptions.decimalMode = DECIMAL_STRING;
+  stmt->m_valueOptions.dateMode = DATE_STRING;
+  stmt->m_valueOptions.dateFraction = false;
+  stmt->m_valueOptions.lobMode = LOB_VALUE;
+  stmt->m_asyncExecution = false;
+  stmt->m_asyncMode = -1;
+  stmt->m_queryTimeout = 0;
+  stmt->m_isExecuting = false;
+  ODBC::InitCancelState(&stmt->m_cancel);
   
   stmt->Wrap(info.Holder());
   
   info.GetReturnValue().Set(info.Holder());
 }
 
+NAN_GETTER(ODBCStatement::RowsetSizeGetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double)obj->m_rowsetSize));
+}
+
+NAN_SETTER(ODBCStatement::RowsetSizeSetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_rowsetSize = CLAMP_ROWSET_SIZE(value->NumberValue());
+  }
+}
+
+NAN_GETTER(ODBCStatement::BigIntModeGetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New(obj->m_valueOptions.bigintMode));
+}
+
+NAN_SETTER(ODBCStatement::BigIntModeSetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  if (value->IsInt32()) {
+    obj->m_valueOptions.bigintMode = value->Int32Value();
+  }
+}
+
+NAN_GETTER(ODBCStatement::DecimalModeGetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New(obj->m_valueOptions.decimalMode));
+}
+
+NAN_SETTER(ODBCStatement::DecimalModeSetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  if (value->IsInt32()) {
+    obj->m_valueOptions.decimalMode = value->Int32Value();
+  }
+}
+
+NAN_GETTER(ODBCStatement::DateModeGetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New(obj->m_valueOptions.dateMode));
+}
+
+NAN_SETTER(ODBCStatement::DateModeSetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  if (value->IsInt32()) {
+    obj->m_valueOptions.dateMode = value->Int32Value();
+  }
+}
+
+NAN_GETTER(ODBCStatement::DateFractionGetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New(obj->m_valueOptions.dateFraction));
+}
+
+NAN_SETTER(ODBCStatement::DateFractionSetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  if (value->IsBoolean()) {
+    obj->m_valueOptions.dateFraction = value->BooleanValue();
+  }
+}
+
+NAN_GETTER(ODBCStatement::LobModeGetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New(obj->m_valueOptions.lobMode));
+}
+
+NAN_SETTER(ODBCStatement::LobModeSetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  if (value->IsInt32()) {
+    obj->m_valueOptions.lobMode = value->Int32Value();
+  }
+}
+
+NAN_GETTER(ODBCStatement::MetadataCacheSizeGetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double) obj->m_metadataCache.capacity()));
+}
+
+NAN_SETTER(ODBCStatement::MetadataCacheSizeSetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_metadataCache.setCapacity(value->Uint32Value());
+  }
+}
+
+NAN_GETTER(ODBCStatement::AsyncExecutionGetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  info.GetReturnValue().Set(obj->m_asyncExecution ? Nan::True() : Nan::False());
+}
+
+NAN_SETTER(ODBCStatement::AsyncExecutionSetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  if (value->IsBoolean()) {
+    obj->m_asyncExecution = value->BooleanValue();
+  }
+}
+
+/*
+ * canExecuteAsync
+ *
+ * Whether executes run asynchronously: asyncExecution is set and the driver
+ * of the connection supports it.
+ */
+
+bool ODBCStatement::canExecuteAsync() {
+  if (!this->m_asyncExecution) {
+    return false;
+  }
+
+  if (this->m_asyncMode < 0) {
+    this->m_asyncMode = ODBC::CanExecuteAsync(this->m_hDBC) ? 1 : 0;
+  }
+
+  return this->m_asyncMode == 1;
+}
+
+NAN_GETTER(ODBCStatement::QueryTimeoutGetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  info.GetReturnValue().Set(Nan::New<Number>((double)obj->m_queryTimeout));
+}
+
+NAN_SETTER(ODBCStatement::QueryTimeoutSetter) {
+  ODBCStatement *obj = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  if (value->IsNumber()) {
+    obj->m_queryTimeout = value->Uint32Value();
+
+    ODBC::SetQueryTimeout(obj->m_hSTMT, obj->m_queryTimeout);
+  }
+}
+
+/*
+ * CallbackExecuteError
+ *
+ * Calls back with the error of a failed execute, or an ECANCELED error if
+ * it was cancelled. The diagnostics were read on the worker before async
+ * execution was turned off, since setting the attribute clears them.
+ */
+
+void ODBCStatement::CallbackExecuteError(Nan::Callback* cb, SQLDiagnostics* diagnostics) {
+  Nan::HandleScope scope;
+
+  Local<Value> info[1];
+
+  if (this->m_cancel.isCancelled) {
+    info[0] = ODBC::GetError(
+      "[node-odbc] Execute was cancelled",
+      "ECANCELED",
+      "[node-odbc] Error in ODBCStatement::CallbackExecuteError");
+  }
+  else if (diagnostics) {
+    info[0] = ODBC::GetSQLError(diagnostics, (char *) "[node-odbc] SQL_ERROR");
+  }
+  else {
+    info[0] = ODBC::GetSQLError(
+      SQL_HANDLE_STMT,
+      this->m_hSTMT,
+      (char *) "[node-odbc] SQL_ERROR");
+  }
+
+  cb->Call(1, info);
+}
+
 /*
  * Execute
  */
@@ -167,15 +395,31 @@ NAN_METHOD(ODBCStatement::Execute) {
     (execute_work_data *) calloc(1, sizeof(execute_work_data));
 
   data->cb = new Nan::Callback(cb);
+  data->cachedShape = stmt->m_metadataCache.get(stmt->m_preparedKey);
   
   data->stmt = stmt;
+  data->isAsync = stmt->canExecuteAsync();
   work_req->data = data;
+
+  stmt->m_cancel.isCancelled = false;
+  stmt->m_isExecuting = true;
   
-  uv_queue_work(
-    uv_default_loop(),
-    work_req,
-    UV_Execute,
-    (uv_after_work_cb)UV_AfterExecute);
+  if (data->isAsync) {
+    Executor::QueuePoll(
+      uv_default_loop(),
+      work_req,
+      UV_ExecutePoll,
+      (uv_after_work_cb)UV_AfterExecute,
+      data->stmt->m_lock);
+  }
+  else {
+    Executor::QueueWork(
+      uv_default_loop(),
+      work_req,
+      UV_Execute,
+      (uv_after_work_cb)UV_AfterExecute,
+      data->stmt->m_lock);
+  }
 
   stmt->Ref();
 
@@ -184,14 +428,60 @@ NAN_METHOD(ODBCStatement::Execute) {
 
 void ODBCStatement::UV_Execute(uv_work_t* req) {
   DEBUG_PRINTF("ODBCStatement::UV_Execute\n");
-  
+
+  UV_ExecutePoll(req);
+}
+
+/*
+ * UV_ExecutePoll
+ *
+ * With isAsync, SQLExecute runs with SQL_ATTR_ASYNC_ENABLE set and the work
+ * is called again while the driver is still executing.
+ */
+
+bool ODBCStatement::UV_ExecutePoll(uv_work_t* req) {
   execute_work_data* data = (execute_work_data *)(req->data);
 
   SQLRETURN ret;
+
+  if (!data->isExecuting) {
+    if (!ODBC::BeginExecute(&data->stmt->m_cancel, data->stmt->m_hSTMT)) {
+      data->result = SQL_ERROR;
+      return true;
+    }
+
+    if (data->isAsync) {
+      ODBC::SetAsyncEnable(data->stmt->m_hSTMT, true);
+    }
+
+    data->isExecuting = true;
+  }
   
   ret = SQLExecute(data->stmt->m_hSTMT); 
 
+  if (data->isAsync && ret == SQL_STILL_EXECUTING) {
+    return false;
+  }
+
+  ODBC::EndExecute(&data->stmt->m_cancel);
+
+  //setting the attribute clears the error, so it is read first
+  if (ret == SQL_ERROR) {
+    data->diagnostics = ODBC::ReadSQLDiagnostics(SQL_HANDLE_STMT, data->stmt->m_hSTMT);
+  }
+
+  if (data->isAsync) {
+    ODBC::SetAsyncEnable(data->stmt->m_hSTMT, false);
+  }
+
+  //describe the result set here rather than on the event loop
+  if (SQL_SUCCEEDED(ret)) {
+    data->shape = ResultShape::Describe(data->stmt->m_hSTMT, data->cachedShape);
+  }
+
   data->result = ret;
+
+  return true;
 }
 
 void ODBCStatement::UV_AfterExecute(uv_work_t* req, int status) {
@@ -205,22 +495,29 @@ void ODBCStatement::UV_AfterExecute(uv_work_t* req, int status) {
   ODBCStatement* self = data->stmt->self();
 
   //First thing, let's check if the execution of the query returned any errors 
+  self->m_isExecuting = false;
+
   if(data->result == SQL_ERROR) {
-    ODBC::CallbackSQLError(
-      SQL_HANDLE_STMT,
-      self->m_hSTMT,
-      data->cb);
+    self->m_metadataCache.update(self->m_preparedKey, data->cachedShape, NULL, true);
+
+    self->CallbackExecuteError(data->cb, data->diagnostics);
   }
   else {
-    Local<Value> info[4];
+    Local<Value> info[7];
     bool* canFreeHandle = new bool(false);
 
     info[0] = Nan::New<External>(self->m_hENV);
     info[1] = Nan::New<External>(self->m_hDBC);
     info[2] = Nan::New<External>(self->m_hSTMT);
     info[3] = Nan::New<External>(canFreeHandle);
+    info[4] = Nan::New<External>(data->shape);
+    info[5] = Nan::New<External>((void *) NULL);
+    info[6] = Nan::New<External>(self->m_lock);
     
-    Local<Value> js_result = Nan::New(ODBCResult::constructor)->NewInstance(4, info);
+    Local<Object> js_result = Nan::New(ODBCResult::constructor)->NewInstance(7, info);
+    self->m_metadataCache.update(self->m_preparedKey, data->cachedShape, data->shape, false);
+    js_result->Set(Nan::New(ODBCResult::OPTION_ROWSET_SIZE), Nan::New<Number>((double)self->m_rowsetSize));
+    ODBCResult::SetValueOptions(js_result, self->m_valueOptions);
 
     info[0] = Nan::Null();
     info[1] = js_result;
@@ -236,6 +533,7 @@ void ODBCStatement::UV_AfterExecute(uv_work_t* req, int status) {
 
   self->Unref();
   delete data->cb;
+  ODBC::FreeSQLDiagnostics(data->diagnostics);
   
   free(data);
   free(req);
@@ -256,6 +554,8 @@ NAN_METHOD(ODBCStatement::ExecuteSync) {
   SQLRETURN ret = SQLExecute(stmt->m_hSTMT); 
   
   if(ret == SQL_ERROR) {
+    stmt->m_metadataCache.remove(stmt->m_preparedKey);
+
     Local<Value> objError = ODBC::GetSQLError(
       SQL_HANDLE_STMT,
       stmt->m_hSTMT,
@@ -267,15 +567,23 @@ NAN_METHOD(ODBCStatement::ExecuteSync) {
     info.GetReturnValue().Set(Nan::Null());
   }
   else {
-    Local<Value> result[4];
+    Local<Value> result[7];
     bool* canFreeHandle = new bool(false);
+    ResultShape* cachedShape = stmt->m_metadataCache.get(stmt->m_preparedKey);
+    ResultShape* shape = ResultShape::Describe(stmt->m_hSTMT, cachedShape);
     
     result[0] = Nan::New<External>(stmt->m_hENV);
     result[1] = Nan::New<External>(stmt->m_hDBC);
     result[2] = Nan::New<External>(stmt->m_hSTMT);
     result[3] = Nan::New<External>(canFreeHandle);
+    result[4] = Nan::New<External>(shape);
+    result[5] = Nan::New<External>((void *) NULL);
+    result[6] = Nan::New<External>(stmt->m_lock);
     
-    Local<Object> js_result = Nan::New(ODBCResult::constructor)->NewInstance(4, result);
+    Local<Object> js_result = Nan::New(ODBCResult::constructor)->NewInstance(7, result);
+    stmt->m_metadataCache.update(stmt->m_preparedKey, cachedShape, shape, false);
+    js_result->Set(Nan::New(ODBCResult::OPTION_ROWSET_SIZE), Nan::New<Number>((double)stmt->m_rowsetSize));
+    ODBCResult::SetValueOptions(js_result, stmt->m_valueOptions);
 
     info.GetReturnValue().Set(js_result);
   }
@@ -302,13 +610,28 @@ NAN_METHOD(ODBCStatement::ExecuteNonQuery) {
   data->cb = new Nan::Callback(cb);
   
   data->stmt = stmt;
+  data->isAsync = stmt->canExecuteAsync();
   work_req->data = data;
+
+  stmt->m_cancel.isCancelled = false;
+  stmt->m_isExecuting = true;
   
-  uv_queue_work(
-    uv_default_loop(),
-    work_req,
-    UV_ExecuteNonQuery,
-    (uv_after_work_cb)UV_AfterExecuteNonQuery);
+  if (data->isAsync) {
+    Executor::QueuePoll(
+      uv_default_loop(),
+      work_req,
+      UV_ExecuteNonQueryPoll,
+      (uv_after_work_cb)UV_AfterExecuteNonQuery,
+      data->stmt->m_lock);
+  }
+  else {
+    Executor::QueueWork(
+      uv_default_loop(),
+      work_req,
+      UV_ExecuteNonQuery,
+      (uv_after_work_cb)UV_AfterExecuteNonQuery,
+      data->stmt->m_lock);
+  }
 
   stmt->Ref();
   
@@ -317,14 +640,48 @@ NAN_METHOD(ODBCStatement::ExecuteNonQuery) {
 
 void ODBCStatement::UV_ExecuteNonQuery(uv_work_t* req) {
   DEBUG_PRINTF("ODBCStatement::ExecuteNonQuery\n");
-  
+
+  UV_ExecuteNonQueryPoll(req);
+}
+
+bool ODBCStatement::UV_ExecuteNonQueryPoll(uv_work_t* req) {
   execute_work_data* data = (execute_work_data *)(req->data);
 
   SQLRETURN ret;
+
+  if (!data->isExecuting) {
+    if (!ODBC::BeginExecute(&data->stmt->m_cancel, data->stmt->m_hSTMT)) {
+      data->result = SQL_ERROR;
+      return true;
+    }
+
+    if (data->isAsync) {
+      ODBC::SetAsyncEnable(data->stmt->m_hSTMT, true);
+    }
+
+    data->isExecuting = true;
+  }
   
   ret = SQLExecute(data->stmt->m_hSTMT); 
 
+  if (data->isAsync && ret == SQL_STILL_EXECUTING) {
+    return false;
+  }
+
+  ODBC::EndExecute(&data->stmt->m_cancel);
+
+  //setting the attribute clears the error, so it is read first
+  if (ret == SQL_ERROR) {
+    data->diagnostics = ODBC::ReadSQLDiagnostics(SQL_HANDLE_STMT, data->stmt->m_hSTMT);
+  }
+
+  if (data->isAsync) {
+    ODBC::SetAsyncEnable(data->stmt->m_hSTMT, false);
+  }
+
   data->result = ret;
+
+  return true;
 }
 
 void ODBCStatement::UV_AfterExecuteNonQuery(uv_work_t* req, int status) {
@@ -338,11 +695,10 @@ void ODBCStatement::UV_AfterExecuteNonQuery(uv_work_t* req, int status) {
   ODBCStatement* self = data->stmt->self();
 
   //First thing, let's check if the execution of the query returned any errors 
+  self->m_isExecuting = false;
+
   if(data->result == SQL_ERROR) {
-    ODBC::CallbackSQLError(
-      SQL_HANDLE_STMT,
-      self->m_hSTMT,
-      data->cb);
+    self->CallbackExecuteError(data->cb, data->diagnostics);
   }
   else {
     SQLLEN rowCount = 0;
@@ -353,9 +709,9 @@ void ODBCStatement::UV_AfterExecuteNonQuery(uv_work_t* req, int status) {
       rowCount = 0;
     }
     
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+    self->m_lock->lock();
     SQLFreeStmt(self->m_hSTMT, SQL_CLOSE);
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    self->m_lock->unlock();
     
     Local<Value> info[2];
 
@@ -374,6 +730,7 @@ void ODBCStatement::UV_AfterExecuteNonQuery(uv_work_t* req, int status) {
 
   self->Unref();
   delete data->cb;
+  ODBC::FreeSQLDiagnostics(data->diagnostics);
   
   free(data);
   free(req);
@@ -413,9 +770,9 @@ NAN_METHOD(ODBCStatement::ExecuteNonQuerySync) {
       rowCount = 0;
     }
     
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+    stmt->m_lock->lock();
     SQLFreeStmt(stmt->m_hSTMT, SQL_CLOSE);
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    stmt->m_lock->unlock();
     
     info.GetReturnValue().Set(Nan::New<Number>(rowCount));
   }
@@ -453,14 +810,31 @@ NAN_METHOD(ODBCStatement::ExecuteDirect) {
   sql->WriteUtf8((char *) data->sql);
 #endif
 
+  data->cachedShape = stmt->m_metadataCache.get(MetadataCache::GetKey(data->sql, data->sqlLen));
+
   data->stmt = stmt;
+  data->isAsync = stmt->canExecuteAsync();
   work_req->data = data;
+
+  stmt->m_cancel.isCancelled = false;
+  stmt->m_isExecuting = true;
   
-  uv_queue_work(
-    uv_default_loop(),
-    work_req, 
-    UV_ExecuteDirect, 
-    (uv_after_work_cb)UV_AfterExecuteDirect);
+  if (data->isAsync) {
+    Executor::QueuePoll(
+      uv_default_loop(),
+      work_req,
+      UV_ExecuteDirectPoll,
+      (uv_after_work_cb)UV_AfterExecuteDirect,
+      data->stmt->m_lock);
+  }
+  else {
+    Executor::QueueWork(
+      uv_default_loop(),
+      work_req, 
+      UV_ExecuteDirect, 
+      (uv_after_work_cb)UV_AfterExecuteDirect,
+      data->stmt->m_lock);
+  }
 
   stmt->Ref();
 
@@ -469,17 +843,56 @@ NAN_METHOD(ODBCStatement::ExecuteDirect) {
 
 void ODBCStatement::UV_ExecuteDirect(uv_work_t* req) {
   DEBUG_PRINTF("ODBCStatement::UV_ExecuteDirect\n");
-  
+
+  UV_ExecuteDirectPoll(req);
+}
+
+bool ODBCStatement::UV_ExecuteDirectPoll(uv_work_t* req) {
   execute_direct_work_data* data = (execute_direct_work_data *)(req->data);
 
   SQLRETURN ret;
+
+  if (!data->isExecuting) {
+    if (!ODBC::BeginExecute(&data->stmt->m_cancel, data->stmt->m_hSTMT)) {
+      data->result = SQL_ERROR;
+      return true;
+    }
+
+    if (data->isAsync) {
+      ODBC::SetAsyncEnable(data->stmt->m_hSTMT, true);
+    }
+
+    data->isExecuting = true;
+  }
   
   ret = SQLExecDirect(
     data->stmt->m_hSTMT,
     (SQLTCHAR *) data->sql, 
     data->sqlLen);  
 
+  if (data->isAsync && ret == SQL_STILL_EXECUTING) {
+    return false;
+  }
+
+  ODBC::EndExecute(&data->stmt->m_cancel);
+
+  //setting the attribute clears the error, so it is read first
+  if (ret == SQL_ERROR) {
+    data->diagnostics = ODBC::ReadSQLDiagnostics(SQL_HANDLE_STMT, data->stmt->m_hSTMT);
+  }
+
+  if (data->isAsync) {
+    ODBC::SetAsyncEnable(data->stmt->m_hSTMT, false);
+  }
+
+  //describe the result set here rather than on the event loop
+  if (SQL_SUCCEEDED(ret)) {
+    data->shape = ResultShape::Describe(data->stmt->m_hSTMT, data->cachedShape);
+  }
+
   data->result = ret;
+
+  return true;
 }
 
 void ODBCStatement::UV_AfterExecuteDirect(uv_work_t* req, int status) {
@@ -493,22 +906,29 @@ void ODBCStatement::UV_AfterExecuteDirect(uv_work_t* req, int status) {
   ODBCStatement* self = data->stmt->self();
 
   //First thing, let's check if the execution of the query returned any errors 
+  self->m_isExecuting = false;
+
   if(data->result == SQL_ERROR) {
-    ODBC::CallbackSQLError(
-      SQL_HANDLE_STMT,
-      self->m_hSTMT,
-      data->cb);
+    self->m_metadataCache.update(MetadataCache::GetKey(data->sql, data->sqlLen), data->cachedShape, NULL, true);
+
+    self->CallbackExecuteError(data->cb, data->diagnostics);
   }
   else {
-    Local<Value> info[4];
+    Local<Value> info[7];
     bool* canFreeHandle = new bool(false);
     
     info[0] = Nan::New<External>(self->m_hENV);
     info[1] = Nan::New<External>(self->m_hDBC);
     info[2] = Nan::New<External>(self->m_hSTMT);
     info[3] = Nan::New<External>(canFreeHandle);
+    info[4] = Nan::New<External>(data->shape);
+    info[5] = Nan::New<External>((void *) NULL);
+    info[6] = Nan::New<External>(self->m_lock);
     
-    Local<Object> js_result =  Nan::New<Function>(ODBCResult::constructor)->NewInstance(4, info);
+    Local<Object> js_result =  Nan::New<Function>(ODBCResult::constructor)->NewInstance(7, info);
+    self->m_metadataCache.update(MetadataCache::GetKey(data->sql, data->sqlLen), data->cachedShape, data->shape, false);
+    js_result->Set(Nan::New(ODBCResult::OPTION_ROWSET_SIZE), Nan::New<Number>((double)self->m_rowsetSize));
+    ODBCResult::SetValueOptions(js_result, self->m_valueOptions);
 
     info[0] = Nan::Null();
     info[1] = js_result;
@@ -524,6 +944,7 @@ void ODBCStatement::UV_AfterExecuteDirect(uv_work_t* req, int status) {
 
   self->Unref();
   delete data->cb;
+  ODBC::FreeSQLDiagnostics(data->diagnostics);
   
   free(data->sql);
   free(data);
@@ -553,7 +974,11 @@ NAN_METHOD(ODBCStatement::ExecuteDirectSync) {
     (SQLTCHAR *) *sql, 
     sql.length());  
 
+  std::string key = MetadataCache::GetKey(*sql, sql.length());
+
   if(ret == SQL_ERROR) {
+    stmt->m_metadataCache.remove(key);
+
     Local<Value> objError = ODBC::GetSQLError(
       SQL_HANDLE_STMT,
       stmt->m_hSTMT,
@@ -565,15 +990,23 @@ NAN_METHOD(ODBCStatement::ExecuteDirectSync) {
     info.GetReturnValue().Set(Nan::Null());
   }
   else {
-    Local<Value> result[4];
+    Local<Value> result[7];
     bool* canFreeHandle = new bool(false);
+    ResultShape* cachedShape = stmt->m_metadataCache.get(key);
+    ResultShape* shape = ResultShape::Describe(stmt->m_hSTMT, cachedShape);
     
     result[0] = Nan::New<External>(stmt->m_hENV);
     result[1] = Nan::New<External>(stmt->m_hDBC);
     result[2] = Nan::New<External>(stmt->m_hSTMT);
     result[3] = Nan::New<External>(canFreeHandle);
+    result[4] = Nan::New<External>(shape);
+    result[5] = Nan::New<External>((void *) NULL);
+    result[6] = Nan::New<External>(stmt->m_lock);
     
-    Local<Object> js_result = Nan::New<Function>(ODBCResult::constructor)->NewInstance(4, result);
+    Local<Object> js_result = Nan::New<Function>(ODBCResult::constructor)->NewInstance(7, result);
+    stmt->m_metadataCache.update(key, cachedShape, shape, false);
+    js_result->Set(Nan::New(ODBCResult::OPTION_ROWSET_SIZE), Nan::New<Number>((double)stmt->m_rowsetSize));
+    ODBCResult::SetValueOptions(js_result, stmt->m_valueOptions);
     
     info.GetReturnValue().Set(js_result);
   }
@@ -611,6 +1044,7 @@ NAN_METHOD(ODBCStatement::PrepareSync) {
     sqlLen);
   
   if (SQL_SUCCEEDED(ret)) {
+    stmt->m_preparedKey = MetadataCache::GetKey(sql2, sqlLen - 1);
     info.GetReturnValue().Set(Nan::True());
   }
   else {
@@ -662,11 +1096,12 @@ NAN_METHOD(ODBCStatement::Prepare) {
   
   work_req->data = data;
   
-  uv_queue_work(
+  Executor::QueueWork(
     uv_default_loop(), 
     work_req, 
     UV_Prepare, 
-    (uv_after_work_cb)UV_AfterPrepare);
+    (uv_after_work_cb)UV_AfterPrepare,
+    data->stmt->m_lock);
 
   stmt->Ref();
 
@@ -719,6 +1154,8 @@ void ODBCStatement::UV_AfterPrepare(uv_work_t* req, int status) {
   else {
     Local<Value> info[2];
 
+    data->stmt->m_preparedKey = MetadataCache::GetKey(data->sql, data->sqlLen);
+
     info[0] = Nan::Null();
     info[1] = Nan::True();
 
@@ -900,11 +1337,12 @@ NAN_METHOD(ODBCStatement::Bind) {
   
   work_req->data = data;
   
-  uv_queue_work(
+  Executor::QueueWork(
     uv_default_loop(), 
     work_req, 
     UV_Bind, 
-    (uv_after_work_cb)UV_AfterBind);
+    (uv_after_work_cb)UV_AfterBind,
+    data->stmt->m_lock);
 
   stmt->Ref();
 
@@ -1015,12 +1453,58 @@ NAN_METHOD(ODBCStatement::CloseSync) {
     stmt->Free();
   }
   else {
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+    stmt->m_lock->lock();
     
     SQLFreeStmt(stmt->m_hSTMT, closeOption);
   
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    stmt->m_lock->unlock();
   }
 
   info.GetReturnValue().Set(Nan::True());
 }
+
+/*
+ * GetMetadataCacheStatsSync
+ */
+
+NAN_METHOD(ODBCStatement::GetMetadataCacheStatsSync) {
+  DEBUG_PRINTF("ODBCStatement::GetMetadataCacheStatsSync\n");
+  Nan::HandleScope scope;
+
+  ODBCStatement* stmt = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  info.GetReturnValue().Set(stmt->m_metadataCache.getStats());
+}
+
+/*
+ * ClearMetadataCacheSync
+ */
+
+NAN_METHOD(ODBCStatement::ClearMetadataCacheSync) {
+  DEBUG_PRINTF("ODBCStatement::ClearMetadataCacheSync\n");
+  Nan::HandleScope scope;
+
+  ODBCStatement* stmt = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  stmt->m_metadataCache.clear();
+
+  info.GetReturnValue().Set(Nan::True());
+}
+
+/*
+ * CancelSync
+ *
+ * Cancels the execute that has not called back yet. It calls back with an
+ * ECANCELED error. Returns whether there was anything to cancel.
+ */
+
+NAN_METHOD(ODBCStatement::CancelSync) {
+  DEBUG_PRINTF("ODBCStatement::CancelSync\n");
+  Nan::HandleScope scope;
+
+  ODBCStatement* stmt = Nan::ObjectWrap::Unwrap<ODBCStatement>(info.Holder());
+
+  bool cancelled = stmt->m_isExecuting && ODBC::CancelExecute(&stmt->m_cancel);
+
+  info.GetReturnValue().Set(cancelled ? Nan::True() : Nan::False());
+}
@@ -21,6 +21,9 @@
 
 #include <nan.h>
 
+#include "metadata_cache.h"
+#include "statement_cache.h"
+
 class ODBCStatement : public Nan::ObjectWrap {
   public:
    static Nan::Persistent<Function> constructor;
@@ -47,18 +50,21 @@ public:
     static NAN_METHOD(Execute);
 protected:
     static void UV_Execute(uv_work_t* work_req);
+    static bool UV_ExecutePoll(uv_work_t* work_req);
     static void UV_AfterExecute(uv_work_t* work_req, int status);
 
 public:
     static NAN_METHOD(ExecuteDirect);
 protected:
     static void UV_ExecuteDirect(uv_work_t* work_req);
+    static bool UV_ExecuteDirectPoll(uv_work_t* work_req);
     static void UV_AfterExecuteDirect(uv_work_t* work_req, int status);
 
 public:
     static NAN_METHOD(ExecuteNonQuery);
 protected:
     static void UV_ExecuteNonQuery(uv_work_t* work_req);
+    static bool UV_ExecuteNonQueryPoll(uv_work_t* work_req);
     static void UV_AfterExecuteNonQuery(uv_work_t* work_req, int status);
     
 public:
@@ -81,6 +87,29 @@ public:
     static NAN_METHOD(ExecuteNonQuerySync);
     static NAN_METHOD(PrepareSync);
     static NAN_METHOD(BindSync);
+    static NAN_METHOD(GetMetadataCacheStatsSync);
+    static NAN_METHOD(ClearMetadataCacheSync);
+    static NAN_METHOD(CancelSync);
+
+    //property getter/setters
+    static NAN_GETTER(RowsetSizeGetter);
+    static NAN_SETTER(RowsetSizeSetter);
+    static NAN_GETTER(BigIntModeGetter);
+    static NAN_SETTER(BigIntModeSetter);
+    static NAN_GETTER(DecimalModeGetter);
+    static NAN_SETTER(DecimalModeSetter);
+    static NAN_GETTER(DateModeGetter);
+    static NAN_SETTER(DateModeSetter);
+    static NAN_GETTER(DateFractionGetter);
+    static NAN_SETTER(DateFractionSetter);
+    static NAN_GETTER(LobModeGetter);
+    static NAN_SETTER(LobModeSetter);
+    static NAN_GETTER(MetadataCacheSizeGetter);
+    static NAN_SETTER(MetadataCacheSizeSetter);
+    static NAN_GETTER(AsyncExecutionGetter);
+    static NAN_SETTER(AsyncExecutionSetter);
+    static NAN_GETTER(QueryTimeoutGetter);
+    static NAN_SETTER(QueryTimeoutSetter);
 protected:
 
     struct Fetch_Request {
@@ -91,18 +120,41 @@ protected:
     
     ODBCStatement *self(void) { return this; }
 
+    bool canExecuteAsync();
+    void CallbackExecuteError(Nan::Callback* cb, SQLDiagnostics* diagnostics);
+
   protected:
     HENV m_hENV;
     HDBC m_hDBC;
     HSTMT m_hSTMT;
+    // Set when the handle is recycled by the connection on free
+    StatementLease *m_lease;
+    // Shared with the connection
+    HandleLock *m_lock;
     
     Parameter *params;
     int paramCount;
+
+    size_t m_rowsetSize;
+    ValueOptions m_valueOptions;
+
+    // Execute asynchronously where the driver supports it
+    bool m_asyncExecution;
+    // Whether the driver supports it, -1 until asked
+    int m_asyncMode;
+    // SQL_ATTR_QUERY_TIMEOUT in seconds, 0 for none
+    SQLULEN m_queryTimeout;
+
+    // Set from an execute until it calls back, for cancelSync
+    bool m_isExecuting;
+    CancelState m_cancel;
     
-    uint8_t *buffer;
-    int bufferLength;
     Column *columns;
     short colCount;
+
+    // Result shapes by SQL text, and the key of the prepared SQL
+    MetadataCache m_metadataCache;
+    std::string m_preparedKey;
 };
 
 struct execute_direct_work_data {
@@ -111,12 +163,30 @@ struct execute_direct_work_data {
   int result;
   void *sql;
   int sqlLen;
+  ResultShape *cachedShape;
+  ResultShape *shape;
+
+  // Polled until the driver is done executing, and whether it has started
+  bool isAsync;
+  bool isExecuting;
+
+  // Read on the worker before async execution is turned off
+  SQLDiagnostics *diagnostics;
 };
 
 struct execute_work_data {
   Nan::Callback* cb;
   ODBCStatement *stmt;
   int result;
+  ResultShape *cachedShape;
+  ResultShape *shape;
+
+  // Polled until the driver is done executing, and whether it has started
+  bool isAsync;
+  bool isExecuting;
+
+  // Read on the worker before async execution is turned off
+  SQLDiagnostics *diagnostics;
 };
 
 struct prepare_work_data {
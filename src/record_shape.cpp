@@ -0,0 +1,95 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "odbc.h"
+#include "record_shape.h"
+
+RecordShape::RecordShape() {
+  this->_names = NULL;
+  this->_colCount = 0;
+}
+
+RecordShape::~RecordShape() {
+  this->reset();
+}
+
+/*
+ * build
+ *
+ * Creates the internalized column names and a template with one property
+ * per column, in column order. Duplicate names share a property, as they
+ * did when rows were built one property at a time.
+ */
+
+void RecordShape::build(Column* columns, short colCount) {
+  Nan::HandleScope scope;
+
+  this->reset();
+
+  if (colCount <= 0) { return; }
+
+  Local<ObjectTemplate> recordTemplate = Nan::New<ObjectTemplate>();
+
+  this->_names = new Nan::Persistent<String>[colCount];
+  this->_colCount = colCount;
+
+  for (short i = 0; i < colCount; i++) {
+#ifdef UNICODE
+    Local<String> name = String::NewFromTwoByte(
+      v8::Isolate::GetCurrent(),
+      (const uint16_t *) columns[i].name,
+      v8::NewStringType::kInternalized).ToLocalChecked();
+#else
+    Local<String> name = String::NewFromUtf8(
+      v8::Isolate::GetCurrent(),
+      (const char *) columns[i].name,
+      v8::NewStringType::kInternalized).ToLocalChecked();
+#endif
+
+    this->_names[i].Reset(name);
+    recordTemplate->Set(name, Nan::Null());
+  }
+
+  this->_template.Reset(recordTemplate);
+}
+
+void RecordShape::reset() {
+  if (this->_names) {
+    for (short i = 0; i < this->_colCount; i++) {
+      this->_names[i].Reset();
+    }
+
+    delete [] this->_names;
+    this->_names = NULL;
+  }
+
+  this->_template.Reset();
+  this->_colCount = 0;
+}
+
+bool RecordShape::isEmpty() {
+  return this->_names == NULL;
+}
+
+Local<String> RecordShape::getName(short col) {
+  return Nan::New(this->_names[col]);
+}
+
+Local<Object> RecordShape::newRecord() {
+  return Nan::NewInstance(Nan::New(this->_template)).ToLocalChecked();
+}
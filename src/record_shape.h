@@ -0,0 +1,45 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SRC_RECORD_SHAPE_H
+#define _SRC_RECORD_SHAPE_H
+
+#include "odbc.h"
+
+// Column names and row template shared by the rows of a result set. The
+// names are internalized once, and every row object is instantiated from the
+// same template so that all rows share one map. Event loop only.
+class RecordShape {
+public:
+  RecordShape();
+  ~RecordShape();
+
+  void build(Column* columns, short colCount);
+  void reset();
+  bool isEmpty();
+
+  Local<String> getName(short col);
+  Local<Object> newRecord();
+
+private:
+  Nan::Persistent<ObjectTemplate> _template;
+  Nan::Persistent<String>* _names;
+  short _colCount;
+};
+
+#endif
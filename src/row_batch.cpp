@@ -0,0 +1,1624 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "odbc.h"
+#include "row_batch.h"
+#include "record_shape.h"
+
+#define BATCH_OFFSET_MAX UINT32_MAX
+// Strings of at least this many bytes are created as external strings
+#define EXTERNAL_STRING_MIN_SIZE 1048576
+
+#define MS_PER_HOUR 3600000LL
+#define MS_PER_DAY 86400000LL
+
+static const uint8_t zeroValue[sizeof(SQL_NUMERIC_STRUCT)] = { 0 };
+
+/*
+ * ExternalString
+ *
+ * String resource that owns a malloc'd value. The value is reported to V8
+ * as external memory until the string is collected.
+ */
+
+template <typename ResourceType, typename CharType>
+class ExternalString : public ResourceType {
+public:
+  ExternalString(CharType* data, size_t length) {
+    this->_data = data;
+    this->_length = length;
+
+    Nan::AdjustExternalMemory((int) (length * sizeof(CharType)));
+  }
+
+  ~ExternalString() {
+    free(this->_data);
+
+    Nan::AdjustExternalMemory(-(int) (this->_length * sizeof(CharType)));
+  }
+
+  const CharType* data() const { return this->_data; }
+  size_t length() const { return this->_length; }
+
+private:
+  CharType* _data;
+  size_t _length;
+};
+
+typedef ExternalString<String::ExternalOneByteStringResource, char> ExternalOneByteString;
+typedef ExternalString<String::ExternalStringResource, uint16_t> ExternalTwoByteString;
+
+static bool IsAscii(const uint8_t* value, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    if (value[i] & 0x80) { return false; }
+  }
+
+  return true;
+}
+
+/*
+ * DaysFromCivil
+ *
+ * Days since 1970-01-01 of a proleptic Gregorian date.
+ */
+
+static int64_t DaysFromCivil(int64_t year, int month, int day) {
+  year -= month <= 2;
+
+  int64_t era = (year >= 0 ? year : year - 399) / 400;
+  int64_t yearOfEra = year - era * 400;
+  int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+  return era * 146097 + dayOfEra - 719468;
+}
+
+/*
+ * CivilFromDays
+ */
+
+static void CivilFromDays(int64_t days, int* year, int* month, int* day) {
+  days += 719468;
+
+  int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  int64_t dayOfEra = days - era * 146097;
+  int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+  int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+
+  *day = (int) (dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+  *month = (int) (monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+  *year = (int) (yearOfEra + era * 400 + (*month <= 2));
+}
+
+static int64_t FloorDiv(int64_t value, int64_t divisor) {
+  return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+/*
+ * ComputeLocalOffset
+ *
+ * Returns the offset from UTC in milliseconds of a local time, given as
+ * milliseconds since 1970-01-01 in local time.
+ */
+
+static int64_t ComputeLocalOffset(int64_t localTime) {
+  int64_t days = FloorDiv(localTime, MS_PER_DAY);
+  int64_t timeOfDay = localTime - days * MS_PER_DAY;
+  struct tm local;
+
+  memset(&local, 0, sizeof(local));
+  CivilFromDays(days, &local.tm_year, &local.tm_mon, &local.tm_mday);
+
+  local.tm_year -= 1900;
+  local.tm_mon -= 1;
+  local.tm_hour = (int) (timeOfDay / MS_PER_HOUR);
+  local.tm_min = (int) (timeOfDay % MS_PER_HOUR / 60000);
+  local.tm_sec = (int) (timeOfDay % 60000 / 1000);
+  local.tm_isdst = -1;
+
+  time_t utc = mktime(&local);
+
+  if (utc == (time_t) -1) {
+    return 0;
+  }
+
+  return (days * MS_PER_DAY + (timeOfDay / 1000) * 1000) - (int64_t) utc * 1000;
+}
+
+/*
+ * BatchBuffer
+ */
+
+BatchBuffer::BatchBuffer() {
+  this->_data = NULL;
+  this->_size = 0;
+  this->_capacity = 0;
+}
+
+BatchBuffer::~BatchBuffer() {
+  this->clear();
+}
+
+void BatchBuffer::clear() {
+  if (this->_data) {
+    free(this->_data);
+    this->_data = NULL;
+  }
+  this->_size = 0;
+  this->_capacity = 0;
+}
+
+uint8_t* BatchBuffer::data() {
+  return this->_data;
+}
+
+size_t BatchBuffer::size() {
+  return this->_size;
+}
+
+size_t BatchBuffer::capacity() {
+  return this->_capacity;
+}
+
+bool BatchBuffer::reserve(size_t capacity, bool exact) {
+  if (capacity <= this->_capacity) { return true; }
+
+  size_t newCapacity = this->_capacity > 0 ? this->_capacity : 64;
+  while (newCapacity < capacity) {
+    newCapacity = newCapacity > SIZE_MAX / 2 ? capacity : newCapacity * 2;
+  }
+  if (exact) { newCapacity = capacity; }
+
+  uint8_t* data = (uint8_t*) realloc(this->_data, newCapacity);
+  if (!data) { return false; }
+
+  this->_data = data;
+  this->_capacity = newCapacity;
+
+  return true;
+}
+
+bool BatchBuffer::resize(size_t size) {
+  if (!this->reserve(size)) { return false; }
+
+  if (size > this->_size) {
+    memset(this->_data + this->_size, 0, size - this->_size);
+  }
+  this->_size = size;
+
+  return true;
+}
+
+bool BatchBuffer::append(const void* value, size_t length) {
+  if (length > SIZE_MAX - this->_size || !this->reserve(this->_size + length)) { return false; }
+
+  if (length > 0) {
+    memcpy(this->_data + this->_size, value, length);
+  }
+  this->_size += length;
+
+  return true;
+}
+
+/*
+ * claim
+ *
+ * Extends the buffer by length uninitialized bytes and returns a pointer to
+ * them. Claims at least as large as the buffer are allocated exactly.
+ */
+
+uint8_t* BatchBuffer::claim(size_t length) {
+  if (length > SIZE_MAX - this->_size || !this->reserve(this->_size + length, length >= this->_capacity)) {
+    return NULL;
+  }
+
+  uint8_t* data = this->_data + this->_size;
+  this->_size += length;
+
+  return data;
+}
+
+uint8_t* BatchBuffer::detach() {
+  uint8_t* data = this->_data;
+
+  this->_data = NULL;
+  this->clear();
+
+  return data;
+}
+
+/*
+ * RowBatch
+ */
+
+RowBatch::RowBatch(Column* columns, short colCount, size_t maxValueSize, size_t valueChunkSize, ValueOptions& valueOptions) {
+  if (valueChunkSize > MAX_VALUE_CHUNK_SIZE) { valueChunkSize = MAX_VALUE_CHUNK_SIZE; }
+  if (valueChunkSize > maxValueSize) { valueChunkSize = maxValueSize; }
+
+  this->_columns = columns;
+  this->_colCount = colCount;
+  this->_batchColumns = new BatchColumn[colCount > 0 ? colCount : 0];
+
+  this->_maxValueSize = maxValueSize;
+  this->_valueChunkSize = valueChunkSize;
+  this->_externalMemory = 0;
+  this->_streamCount = 0;
+  this->_fetchCount = 0;
+
+  this->_dateMode = valueOptions.dateMode;
+  this->_dateFraction = valueOptions.dateFraction;
+
+  this->_offset = 0;
+  this->_offsetStart = 0;
+  this->_offsetEnd = 0;
+
+  ValueOptions lobValueOptions = valueOptions;
+  lobValueOptions.lobMode = LOB_VALUE;
+
+  for (short i = 0; i < colCount; i++) {
+    BatchColumn& batchColumn = this->_batchColumns[i];
+
+    // Only the last column can be streamed, as reading a column with
+    // SQLGetData ends reading the columns before it
+    batchColumn.type = RowBatch::GetValueType(columns[i], i == colCount - 1 ? valueOptions : lobValueOptions);
+    batchColumn.width = sizeof(uint32_t);
+    batchColumn.cType = SQL_C_BINARY;
+    batchColumn.terminatorSize = 0;
+    batchColumn.chunkSize = SIZE_MAX;
+    batchColumn.isDescribed = false;
+    batchColumn.hasMore = false;
+    batchColumn.read = &RowBatch::readVariable;
+
+    switch (batchColumn.type) {
+      case RowBatch::TYPE_INTEGER:
+        batchColumn.width = sizeof(int32_t);
+        batchColumn.read = &RowBatch::readFixed<int32_t, SQL_C_SLONG>;
+        batchColumn.convert = &RowBatch::convertInteger;
+        break;
+      case RowBatch::TYPE_BIGINT:
+        batchColumn.width = sizeof(int64_t);
+        batchColumn.read = &RowBatch::readFixed<int64_t, SQL_C_SBIGINT>;
+
+        if (valueOptions.bigintMode == BIGINT_NUMBER) {
+          batchColumn.convert = &RowBatch::convertBigIntNumber;
+        }
+        else if (valueOptions.bigintMode == BIGINT_BIGINT) {
+          batchColumn.convert = &RowBatch::convertBigInt;
+        }
+        else {
+          batchColumn.convert = &RowBatch::convertBigIntString;
+        }
+        break;
+      case RowBatch::TYPE_NUMBER:
+        batchColumn.width = sizeof(double);
+        batchColumn.read = &RowBatch::readFixed<double, SQL_C_DOUBLE>;
+        batchColumn.convert = &RowBatch::convertNumber;
+        break;
+      case RowBatch::TYPE_BOOLEAN:
+        batchColumn.width = sizeof(uint8_t);
+        batchColumn.read = &RowBatch::readFixed<uint8_t, SQL_C_BIT>;
+        batchColumn.convert = &RowBatch::convertBoolean;
+        break;
+      case RowBatch::TYPE_DECIMAL:
+        batchColumn.width = sizeof(SQL_NUMERIC_STRUCT);
+        batchColumn.read = &RowBatch::readDecimal;
+        batchColumn.convert = &RowBatch::convertDecimal;
+        break;
+      case RowBatch::TYPE_DATE:
+        batchColumn.width = sizeof(double);
+        batchColumn.convert = &RowBatch::convertDate;
+
+        if (columns[i].type == SQL_TIME || columns[i].type == SQL_TYPE_TIME) {
+          batchColumn.read = &RowBatch::readTime;
+        }
+        else {
+          batchColumn.read = &RowBatch::readTimestamp;
+        }
+        break;
+      case RowBatch::TYPE_STRING:
+        batchColumn.cType = SQL_C_CHAR;
+        batchColumn.terminatorSize = sizeof(char);
+        batchColumn.convert = &RowBatch::convertString;
+        break;
+      case RowBatch::TYPE_WIDE_STRING:
+        batchColumn.cType = SQL_C_WCHAR;
+        batchColumn.terminatorSize = sizeof(uint16_t);
+        batchColumn.convert = &RowBatch::convertWideString;
+        break;
+      case RowBatch::TYPE_STREAM:
+        batchColumn.cType = RowBatch::GetStreamType(columns[i]);
+        batchColumn.terminatorSize = batchColumn.cType == SQL_C_WCHAR ? sizeof(uint16_t) : (batchColumn.cType == SQL_C_CHAR ? sizeof(char) : 0);
+        batchColumn.chunkSize = valueChunkSize;
+        batchColumn.read = &RowBatch::readStream;
+        batchColumn.convert = &RowBatch::convertStream;
+        this->_streamCount++;
+        break;
+      default:
+        batchColumn.chunkSize = valueChunkSize;
+        batchColumn.convert = &RowBatch::convertBinary;
+        break;
+    }
+  }
+
+  this->clear();
+}
+
+RowBatch::~RowBatch() {
+  this->_streamOwner.Reset();
+
+  if (this->_externalMemory > 0) {
+    Nan::AdjustExternalMemory(-(int) this->_externalMemory);
+  }
+
+  delete [] this->_batchColumns;
+}
+
+/*
+ * GetValueType
+ *
+ * Determines how values of a column are fetched and converted.
+ */
+
+RowBatch::Type RowBatch::GetValueType(Column& column, ValueOptions& valueOptions) {
+  if (valueOptions.lobMode == LOB_STREAM) {
+    switch (column.type) {
+      case SQL_LONGVARCHAR:
+      case SQL_WLONGVARCHAR:
+      case SQL_LONGVARBINARY:
+        return RowBatch::TYPE_STREAM;
+      case SQL_CHAR:
+      case SQL_VARCHAR:
+      case SQL_WCHAR:
+      case SQL_WVARCHAR:
+      case SQL_BINARY:
+      case SQL_VARBINARY:
+        if (column.octetLength == 0 || column.octetLength > LONG_DATA_THRESHOLD) {
+          return RowBatch::TYPE_STREAM;
+        }
+        break;
+    }
+  }
+
+  switch (column.type) {
+    case SQL_INTEGER:
+    case SQL_SMALLINT:
+    case SQL_TINYINT:
+      return RowBatch::TYPE_INTEGER;
+    case SQL_FLOAT:
+    case SQL_REAL:
+    case SQL_DOUBLE:
+      return RowBatch::TYPE_NUMBER;
+    case SQL_BIT:
+      return RowBatch::TYPE_BOOLEAN;
+    case SQL_BIGINT:
+      return RowBatch::TYPE_BIGINT;
+    case SQL_BINARY:
+    case SQL_VARBINARY:
+    case SQL_LONGVARBINARY:
+      return RowBatch::TYPE_BINARY;
+    case SQL_NUMERIC:
+    case SQL_DECIMAL:
+      if (valueOptions.decimalMode == DECIMAL_NUMBER) { return RowBatch::TYPE_NUMBER; }
+      if (valueOptions.decimalMode == DECIMAL_SCALED) { return RowBatch::TYPE_DECIMAL; }
+      return RowBatch::TYPE_STRING;
+    case SQL_DATE:
+    case SQL_TIME:
+    case SQL_TIMESTAMP:
+    case SQL_TYPE_DATE:
+    case SQL_TYPE_TIME:
+    case SQL_TYPE_TIMESTAMP:
+      if (valueOptions.dateMode != DATE_STRING) { return RowBatch::TYPE_DATE; }
+      return RowBatch::TYPE_STRING;
+    case SQL_GUID:
+      return RowBatch::TYPE_STRING;
+    case SQL_CHAR:
+    case SQL_VARCHAR:
+    case SQL_LONGVARCHAR:
+      // Long character data is read in parts and joined into one string
+      return RowBatch::TYPE_STRING;
+    case SQL_WCHAR:
+    case SQL_WVARCHAR:
+    case SQL_WLONGVARCHAR:
+      return RowBatch::TYPE_WIDE_STRING;
+    default:
+      // Determine how unknown type should be treated
+      if (column.radix != 0) { return RowBatch::TYPE_STRING; }
+
+      // (column.octetLength != column.length) suggests formatting, thus likely to be char data
+      if (column.octetLength == 0 || column.octetLength > LONG_DATA_THRESHOLD || column.octetLength == column.length) {
+        return RowBatch::TYPE_BINARY;
+      }
+      return RowBatch::TYPE_STRING;
+  }
+}
+
+/*
+ * GetStreamType
+ */
+
+SQLSMALLINT RowBatch::GetStreamType(Column& column) {
+  switch (column.type) {
+    case SQL_CHAR:
+    case SQL_VARCHAR:
+    case SQL_LONGVARCHAR:
+      return SQL_C_CHAR;
+    case SQL_WCHAR:
+    case SQL_WVARCHAR:
+    case SQL_WLONGVARCHAR:
+      return SQL_C_WCHAR;
+    default:
+      return SQL_C_BINARY;
+  }
+}
+
+/*
+ * DescribeNumeric
+ *
+ * SQL_C_NUMERIC values are fetched with the driver default precision and a
+ * scale of 0 unless they are set in the application row descriptor. Binds
+ * the column to data if it is not NULL.
+ */
+
+SQLRETURN RowBatch::DescribeNumeric(SQLHSTMT hStmt, Column& column, SQLPOINTER data) {
+  SQLHDESC hDesc = NULL;
+  SQLLEN precision = column.length > 0 && column.length < NUMERIC_PRECISION_MAX ? column.length : NUMERIC_PRECISION_MAX;
+
+  SQLRETURN ret = SQLGetStmtAttr(hStmt, SQL_ATTR_APP_ROW_DESC, &hDesc, 0, NULL);
+
+  if (SQL_SUCCEEDED(ret)) {
+    ret = SQLSetDescField(hDesc, column.index, SQL_DESC_TYPE, (SQLPOINTER) (SQLLEN) SQL_C_NUMERIC, 0);
+  }
+  if (SQL_SUCCEEDED(ret)) {
+    ret = SQLSetDescField(hDesc, column.index, SQL_DESC_PRECISION, (SQLPOINTER) precision, 0);
+  }
+  if (SQL_SUCCEEDED(ret)) {
+    ret = SQLSetDescField(hDesc, column.index, SQL_DESC_SCALE, (SQLPOINTER) column.scale, 0);
+  }
+  // Setting the data pointer last makes the driver validate the record
+  if (SQL_SUCCEEDED(ret) && data) {
+    ret = SQLSetDescField(hDesc, column.index, SQL_DESC_DATA_PTR, data, 0);
+  }
+
+  DEBUG_PRINTF("RowBatch::DescribeNumeric - index=%u precision=%zi scale=%zi ret=%i\n",
+               column.index, precision, column.scale, ret);
+
+  return ret;
+}
+
+void RowBatch::clear() {
+  this->_rowCount = 0;
+  this->_errorMessage = NULL;
+  this->_errorCode = NULL;
+
+  for (short i = 0; i < this->_colCount; i++) {
+    BatchColumn& batchColumn = this->_batchColumns[i];
+
+    batchColumn.values.resize(0);
+    batchColumn.data.resize(0);
+    batchColumn.nulls.resize(0);
+
+    switch (batchColumn.type) {
+      case RowBatch::TYPE_STRING:
+      case RowBatch::TYPE_WIDE_STRING:
+      case RowBatch::TYPE_BINARY:
+      case RowBatch::TYPE_STREAM:
+        // Variable length values start at offset 0
+        batchColumn.values.resize(sizeof(uint32_t));
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+size_t RowBatch::rowCount() {
+  return this->_rowCount;
+}
+
+short RowBatch::columnCount() {
+  return this->_colCount;
+}
+
+size_t RowBatch::byteSize() {
+  size_t size = 0;
+
+  for (short i = 0; i < this->_colCount; i++) {
+    BatchColumn& batchColumn = this->_batchColumns[i];
+    size += batchColumn.values.size() + batchColumn.data.size() + batchColumn.nulls.size();
+  }
+
+  return size;
+}
+
+/*
+ * updateExternalMemory
+ *
+ * Reports changes in the memory held by the column buffers to V8, so that
+ * large values read on the thread pool count towards GC pressure. Event
+ * loop only. Buffers handed over to typed arrays are accounted by V8.
+ */
+
+void RowBatch::updateExternalMemory() {
+  size_t size = 0;
+
+  for (short i = 0; i < this->_colCount; i++) {
+    BatchColumn& batchColumn = this->_batchColumns[i];
+    size += batchColumn.values.capacity() + batchColumn.data.capacity() + batchColumn.nulls.capacity();
+  }
+
+  if (size != this->_externalMemory) {
+    Nan::AdjustExternalMemory((int) ((int64_t) size - (int64_t) this->_externalMemory));
+    this->_externalMemory = size;
+  }
+}
+
+RowBatch::Type RowBatch::columnType(short col) {
+  return this->_batchColumns[col].type;
+}
+
+/*
+ * readRow
+ *
+ * Reads every column of the current row with SQLGetData.
+ */
+
+SQLRETURN RowBatch::readRow(SQLHSTMT hStmt, uint8_t* buffer, int bufferLength) {
+  for (short i = 0; i < this->_colCount; i++) {
+    SQLRETURN ret = this->readColumn(hStmt, i, buffer, bufferLength);
+
+    if (!SQL_SUCCEEDED(ret)) {
+      this->rollbackRow();
+      return ret;
+    }
+  }
+
+  this->commitRow();
+
+  return SQL_SUCCESS;
+}
+
+/*
+ * readColumn
+ */
+
+SQLRETURN RowBatch::readColumn(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength) {
+  return (this->*this->_batchColumns[col].read)(hStmt, col, buffer, bufferLength);
+}
+
+/*
+ * readFixed
+ *
+ * Reads a fixed width value directly into a value of the C type.
+ */
+
+template <typename T, SQLSMALLINT cType>
+SQLRETURN RowBatch::readFixed(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength) {
+  T value;
+  SQLLEN len = 0;
+
+  SQLRETURN ret = SQLGetData(
+    hStmt,
+    this->_columns[col].index,
+    cType,
+    &value,
+    sizeof(value),
+    &len);
+
+  DEBUG_PRINTF("RowBatch::readFixed - index=%u type=%zi cType=%i len=%zi ret=%i\n",
+               this->_columns[col].index, this->_columns[col].type, cType, len, ret);
+
+  if (!SQL_SUCCEEDED(ret)) { return ret; }
+
+  if (len == SQL_NULL_DATA) {
+    return this->appendNull(col) ? SQL_SUCCESS : SQL_ERROR;
+  }
+  return this->appendValue(col, &value, sizeof(value)) ? SQL_SUCCESS : SQL_ERROR;
+}
+
+/*
+ * readDecimal
+ */
+
+SQLRETURN RowBatch::readDecimal(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength) {
+  Column& column = this->_columns[col];
+  BatchColumn& batchColumn = this->_batchColumns[col];
+
+  SQL_NUMERIC_STRUCT value;
+  SQLLEN len = 0;
+  SQLRETURN ret;
+
+  if (!batchColumn.isDescribed) {
+    ret = RowBatch::DescribeNumeric(hStmt, column, NULL);
+
+    if (!SQL_SUCCEEDED(ret)) { return ret; }
+    batchColumn.isDescribed = true;
+  }
+
+  ret = SQLGetData(
+    hStmt,
+    column.index,
+    SQL_ARD_TYPE,
+    &value,
+    sizeof(value),
+    &len);
+
+  DEBUG_PRINTF("RowBatch::readDecimal - index=%u type=%zi len=%zi ret=%i\n",
+               column.index, column.type, len, ret);
+
+  if (!SQL_SUCCEEDED(ret)) { return ret; }
+
+  if (len == SQL_NULL_DATA) {
+    return this->appendNull(col) ? SQL_SUCCESS : SQL_ERROR;
+  }
+  return this->appendValue(col, &value, sizeof(value)) ? SQL_SUCCESS : SQL_ERROR;
+}
+
+/*
+ * readTimestamp
+ *
+ * Reads DATE and TIMESTAMP values as SQL_TIMESTAMP_STRUCT.
+ */
+
+SQLRETURN RowBatch::readTimestamp(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength) {
+  SQL_TIMESTAMP_STRUCT value;
+  SQLLEN len = 0;
+
+  SQLRETURN ret = SQLGetData(
+    hStmt,
+    this->_columns[col].index,
+    SQL_C_TYPE_TIMESTAMP,
+    &value,
+    sizeof(value),
+    &len);
+
+  DEBUG_PRINTF("RowBatch::readTimestamp - index=%u type=%zi len=%zi ret=%i\n",
+               this->_columns[col].index, this->_columns[col].type, len, ret);
+
+  if (!SQL_SUCCEEDED(ret)) { return ret; }
+
+  if (len == SQL_NULL_DATA) {
+    return this->appendTimestamp(col, NULL) ? SQL_SUCCESS : SQL_ERROR;
+  }
+  return this->appendTimestamp(col, &value) ? SQL_SUCCESS : SQL_ERROR;
+}
+
+/*
+ * readTime
+ *
+ * Reads TIME values as SQL_TIME_STRUCT. Converting to a timestamp would set
+ * the date to the current date.
+ */
+
+SQLRETURN RowBatch::readTime(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength) {
+  SQL_TIME_STRUCT value;
+  SQLLEN len = 0;
+
+  SQLRETURN ret = SQLGetData(
+    hStmt,
+    this->_columns[col].index,
+    SQL_C_TYPE_TIME,
+    &value,
+    sizeof(value),
+    &len);
+
+  DEBUG_PRINTF("RowBatch::readTime - index=%u type=%zi len=%zi ret=%i\n",
+               this->_columns[col].index, this->_columns[col].type, len, ret);
+
+  if (!SQL_SUCCEEDED(ret)) { return ret; }
+
+  if (len == SQL_NULL_DATA) {
+    return this->appendTime(col, NULL) ? SQL_SUCCESS : SQL_ERROR;
+  }
+  return this->appendTime(col, &value) ? SQL_SUCCESS : SQL_ERROR;
+}
+
+/*
+ * readVariable
+ *
+ * Variable length data is read in chunks until the whole value is fetched.
+ */
+
+SQLRETURN RowBatch::readVariable(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength) {
+  Column& column = this->_columns[col];
+  BatchColumn& batchColumn = this->_batchColumns[col];
+
+  SQLRETURN ret;
+  SQLLEN len = 0;
+
+  SQLSMALLINT cType = batchColumn.cType;
+  size_t terminatorSize = batchColumn.terminatorSize;
+  size_t chunkSize = (size_t) bufferLength < batchColumn.chunkSize ? (size_t) bufferLength : batchColumn.chunkSize;
+
+  size_t totalSize = 0;
+  bool isFirstChunk = true;
+
+  while (true) {
+    size_t requestSize = chunkSize;
+
+    // Values longer than maxValueSize are truncated
+    if (this->_maxValueSize - totalSize < requestSize - terminatorSize) {
+      requestSize = this->_maxValueSize - totalSize + terminatorSize;
+    }
+    if (requestSize < terminatorSize + (cType == SQL_C_WCHAR ? sizeof(uint16_t) : 1)) { break; }
+
+    ret = SQLGetData(
+      hStmt,
+      column.index,
+      cType,
+      buffer,
+      requestSize,
+      &len);
+
+    DEBUG_PRINTF("RowBatch::readVariable - index=%u type=%zi len=%zi ret=%i\n",
+                 column.index, column.type, len, ret);
+
+    if (ret == SQL_NO_DATA && !isFirstChunk) { break; }
+    if (!SQL_SUCCEEDED(ret)) { return ret; }
+
+    if (isFirstChunk && len == SQL_NULL_DATA) {
+      return this->appendNull(col) ? SQL_SUCCESS : SQL_ERROR;
+    }
+    isFirstChunk = false;
+
+    size_t availableSize = requestSize - terminatorSize;
+    if (cType == SQL_C_WCHAR) { availableSize -= availableSize % sizeof(uint16_t); }
+
+    bool isComplete = len != SQL_NO_TOTAL && (size_t) len <= availableSize;
+    size_t size = isComplete ? (size_t) len : availableSize;
+
+    if (!this->appendData(col, buffer, size)) { return SQL_ERROR; }
+    totalSize += size;
+
+    if (isComplete) { break; }
+
+    // The reported length is the number of bytes that were remaining before
+    // this read, so the rest of the value can be read at once into an
+    // exactly sized allocation instead of chunk by chunk. Drivers that
+    // convert character data may report less than there is, in which case
+    // reading continues in chunks.
+    if (len != SQL_NO_TOTAL) {
+      ret = this->readRemaining(hStmt, col, (size_t) len - size, &totalSize, &isComplete);
+      if (!SQL_SUCCEEDED(ret)) { return ret; }
+      if (isComplete) { break; }
+    }
+  }
+
+  return this->markRow(col, false) && this->endValue(col) ? SQL_SUCCESS : SQL_ERROR;
+}
+
+/*
+ * readStream
+ *
+ * Reads the first part of a streamed value, at most valueChunkSize bytes.
+ * The remaining parts are left to be read after the row is returned.
+ */
+
+SQLRETURN RowBatch::readStream(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength) {
+  Column& column = this->_columns[col];
+  BatchColumn& batchColumn = this->_batchColumns[col];
+
+  size_t requestSize = (size_t) bufferLength < batchColumn.chunkSize ? (size_t) bufferLength : batchColumn.chunkSize;
+  SQLLEN len = 0;
+
+  SQLRETURN ret = SQLGetData(
+    hStmt,
+    column.index,
+    batchColumn.cType,
+    buffer,
+    requestSize,
+    &len);
+
+  DEBUG_PRINTF("RowBatch::readStream - index=%u type=%zi len=%zi ret=%i\n",
+               column.index, column.type, len, ret);
+
+  if (!SQL_SUCCEEDED(ret)) { return ret; }
+
+  if (len == SQL_NULL_DATA) {
+    batchColumn.hasMore = false;
+    return this->appendNull(col) ? SQL_SUCCESS : SQL_ERROR;
+  }
+
+  size_t availableSize = requestSize - batchColumn.terminatorSize;
+  if (batchColumn.cType == SQL_C_WCHAR) { availableSize -= availableSize % sizeof(uint16_t); }
+
+  batchColumn.hasMore = len == SQL_NO_TOTAL || (size_t) len > availableSize;
+
+  return this->appendData(col, buffer, batchColumn.hasMore ? availableSize : (size_t) len) &&
+         this->markRow(col, false) && this->endValue(col) ? SQL_SUCCESS : SQL_ERROR;
+}
+
+/*
+ * readRemaining
+ *
+ * Reads the remaining length bytes of a value, up to maxValueSize in total,
+ * directly into the column data. Adds the bytes read to totalSize.
+ */
+
+SQLRETURN RowBatch::readRemaining(SQLHSTMT hStmt, short col, size_t length, size_t* totalSize, bool* isComplete) {
+  Column& column = this->_columns[col];
+  BatchColumn& batchColumn = this->_batchColumns[col];
+  BatchBuffer& data = batchColumn.data;
+  size_t terminatorSize = batchColumn.terminatorSize;
+  bool isTruncated = false;
+
+  if (length > this->_maxValueSize - *totalSize) {
+    length = this->_maxValueSize - *totalSize;
+    isTruncated = true;
+  }
+  if (batchColumn.cType == SQL_C_WCHAR) { length -= length % sizeof(uint16_t); }
+
+  *isComplete = true;
+  if (length == 0) { return SQL_SUCCESS; }
+
+  if (length + terminatorSize > BATCH_OFFSET_MAX - data.size()) {
+    this->setError("[node-odbc] Column data exceeds the maximum batch size", "ERANGE");
+    return SQL_ERROR;
+  }
+
+  size_t start = data.size();
+  uint8_t* target = data.claim(length + terminatorSize);
+
+  if (!target) {
+    this->setError("[node-odbc] Failed to allocate buffer for column data", "ENOMEM");
+    return SQL_ERROR;
+  }
+
+  SQLLEN len = 0;
+  SQLRETURN ret = SQLGetData(
+    hStmt,
+    column.index,
+    batchColumn.cType,
+    target,
+    length + terminatorSize,
+    &len);
+
+  DEBUG_PRINTF("RowBatch::readRemaining - index=%u length=%zu len=%zi ret=%i\n",
+               column.index, length, len, ret);
+
+  if (ret == SQL_NO_DATA) {
+    data.resize(start);
+    return SQL_SUCCESS;
+  }
+  if (!SQL_SUCCEEDED(ret)) { return ret; }
+
+  bool isRead = len != SQL_NO_TOTAL && (size_t) len <= length;
+  size_t size = isRead ? (size_t) len : length;
+
+  // Drop the terminator, and whatever the driver did not fill
+  data.resize(start + size);
+  *totalSize += size;
+  *isComplete = isRead || isTruncated;
+
+  return SQL_SUCCESS;
+}
+
+bool RowBatch::markRow(short col, bool isNull) {
+  BatchBuffer& nulls = this->_batchColumns[col].nulls;
+  size_t index = this->_rowCount / 8;
+
+  if (nulls.size() <= index && !nulls.resize(index + 1)) {
+    this->setError("[node-odbc] Failed to allocate buffer for column data", "ENOMEM");
+    return false;
+  }
+
+  if (isNull) {
+    nulls.data()[index] |= (uint8_t) (1 << (this->_rowCount % 8));
+  }
+
+  return true;
+}
+
+bool RowBatch::appendData(short col, const void* value, size_t length) {
+  BatchBuffer& data = this->_batchColumns[col].data;
+
+  if (length > BATCH_OFFSET_MAX - data.size()) {
+    this->setError("[node-odbc] Column data exceeds the maximum batch size", "ERANGE");
+    return false;
+  }
+
+  if (!data.append(value, length)) {
+    this->setError("[node-odbc] Failed to allocate buffer for column data", "ENOMEM");
+    return false;
+  }
+
+  return true;
+}
+
+bool RowBatch::endValue(short col) {
+  uint32_t offset = (uint32_t) this->_batchColumns[col].data.size();
+
+  if (!this->_batchColumns[col].values.append(&offset, sizeof(offset))) {
+    this->setError("[node-odbc] Failed to allocate buffer for column data", "ENOMEM");
+    return false;
+  }
+
+  return true;
+}
+
+bool RowBatch::appendNull(short col) {
+  BatchColumn& batchColumn = this->_batchColumns[col];
+
+  if (!this->markRow(col, true)) { return false; }
+
+  switch (batchColumn.type) {
+    case RowBatch::TYPE_STRING:
+    case RowBatch::TYPE_WIDE_STRING:
+    case RowBatch::TYPE_BINARY:
+    case RowBatch::TYPE_STREAM:
+      return this->endValue(col);
+    default:
+      if (!batchColumn.values.append(zeroValue, batchColumn.width)) {
+        this->setError("[node-odbc] Failed to allocate buffer for column data", "ENOMEM");
+        return false;
+      }
+      return true;
+  }
+}
+
+bool RowBatch::appendValue(short col, const void* value, size_t length) {
+  BatchColumn& batchColumn = this->_batchColumns[col];
+
+  if (!this->markRow(col, false)) { return false; }
+
+  switch (batchColumn.type) {
+    case RowBatch::TYPE_STRING:
+    case RowBatch::TYPE_WIDE_STRING:
+    case RowBatch::TYPE_BINARY:
+    case RowBatch::TYPE_STREAM:
+      return this->appendData(col, value, length) && this->endValue(col);
+    default:
+      if (!batchColumn.values.append(value, batchColumn.width)) {
+        this->setError("[node-odbc] Failed to allocate buffer for column data", "ENOMEM");
+        return false;
+      }
+      return true;
+  }
+}
+
+/*
+ * appendTimestamp
+ *
+ * Appends a timestamp as epoch milliseconds, or null if value is NULL.
+ */
+
+bool RowBatch::appendTimestamp(short col, SQL_TIMESTAMP_STRUCT* value) {
+  if (!value) {
+    return this->appendDate(col, NULL, 0);
+  }
+
+  int64_t days = DaysFromCivil(value->year, value->month, value->day);
+  int64_t seconds = value->hour * 3600 + value->minute * 60 + value->second;
+
+  // The fraction is in nanoseconds
+  int64_t localTime = days * MS_PER_DAY + seconds * 1000 + value->fraction / 1000000;
+
+  return this->appendDate(col, &localTime, value->fraction % 1000000);
+}
+
+/*
+ * appendTime
+ *
+ * Appends a time as epoch milliseconds on 1970-01-01, or null if value is
+ * NULL.
+ */
+
+bool RowBatch::appendTime(short col, SQL_TIME_STRUCT* value) {
+  if (!value) {
+    return this->appendDate(col, NULL, 0);
+  }
+
+  int64_t localTime = (value->hour * 3600 + value->minute * 60 + value->second) * 1000;
+
+  return this->appendDate(col, &localTime, 0);
+}
+
+/*
+ * appendDate
+ *
+ * Appends a local time given in milliseconds since 1970-01-01, interpreted
+ * as UTC or local time depending on the date mode, or null if localTime is
+ * NULL.
+ */
+
+bool RowBatch::appendDate(short col, const int64_t* localTime, uint32_t nanoseconds) {
+  BatchColumn& batchColumn = this->_batchColumns[col];
+
+  if (this->_dateFraction && !batchColumn.data.append(&nanoseconds, sizeof(nanoseconds))) {
+    this->setError("[node-odbc] Failed to allocate buffer for column data", "ENOMEM");
+    return false;
+  }
+
+  if (!localTime) {
+    return this->appendNull(col);
+  }
+
+  double value = (double) (this->_dateMode == DATE_LOCAL ? *localTime - this->getLocalOffset(*localTime) : *localTime);
+
+  return this->appendValue(col, &value, sizeof(value));
+}
+
+/*
+ * getLocalOffset
+ *
+ * Returns the local time offset, computing it at most a few times per day
+ * of values. The offset is cached for the whole day when it is the same at
+ * the start and end of the day, otherwise for the hour.
+ */
+
+int64_t RowBatch::getLocalOffset(int64_t localTime) {
+  if (localTime >= this->_offsetStart && localTime < this->_offsetEnd) {
+    return this->_offset;
+  }
+
+  int64_t dayStart = FloorDiv(localTime, MS_PER_DAY) * MS_PER_DAY;
+  int64_t hourStart = FloorDiv(localTime, MS_PER_HOUR) * MS_PER_HOUR;
+
+  this->_offset = ComputeLocalOffset(hourStart);
+
+  if (ComputeLocalOffset(dayStart) == this->_offset &&
+      ComputeLocalOffset(dayStart + MS_PER_DAY - MS_PER_HOUR) == this->_offset) {
+    this->_offsetStart = dayStart;
+    this->_offsetEnd = dayStart + MS_PER_DAY;
+  }
+  else {
+    this->_offsetStart = hourStart;
+    this->_offsetEnd = hourStart + MS_PER_HOUR;
+  }
+
+  return this->_offset;
+}
+
+void RowBatch::commitRow() {
+  this->_rowCount++;
+}
+
+void RowBatch::rollbackRow() {
+  size_t index = this->_rowCount / 8;
+  uint8_t mask = (uint8_t) (1 << (this->_rowCount % 8));
+
+  for (short i = 0; i < this->_colCount; i++) {
+    BatchColumn& batchColumn = this->_batchColumns[i];
+
+    switch (batchColumn.type) {
+      case RowBatch::TYPE_STRING:
+      case RowBatch::TYPE_WIDE_STRING:
+      case RowBatch::TYPE_BINARY:
+      case RowBatch::TYPE_STREAM:
+      {
+        uint32_t* offsets = (uint32_t*) batchColumn.values.data();
+        batchColumn.data.resize(offsets[this->_rowCount]);
+        batchColumn.values.resize((this->_rowCount + 1) * sizeof(uint32_t));
+        break;
+      }
+      default:
+        batchColumn.values.resize(this->_rowCount * batchColumn.width);
+
+        // Date fractions
+        if (batchColumn.data.size() > this->_rowCount * sizeof(uint32_t)) {
+          batchColumn.data.resize(this->_rowCount * sizeof(uint32_t));
+        }
+    }
+
+    if (batchColumn.nulls.size() > index) {
+      batchColumn.nulls.data()[index] &= (uint8_t) ~mask;
+    }
+  }
+}
+
+void RowBatch::setError(const char* message, const char* code) {
+  this->_errorMessage = message;
+  this->_errorCode = code;
+}
+
+bool RowBatch::isNull(size_t row, short col) {
+  BatchBuffer& nulls = this->_batchColumns[col].nulls;
+  size_t index = row / 8;
+
+  return nulls.size() > index && (nulls.data()[index] & (1 << (row % 8)));
+}
+
+#ifndef HAVE_BIGINT_WORDS
+/*
+ * FormatMagnitude
+ *
+ * Formats a signed 128-bit magnitude as a decimal string.
+ */
+
+static void FormatMagnitude(bool isNegative, uint64_t low, uint64_t high, char* value, size_t size) {
+  uint32_t limbs[4] = { (uint32_t) (high >> 32), (uint32_t) high, (uint32_t) (low >> 32), (uint32_t) low };
+  char digits[48];
+  size_t count = 0;
+  bool isZero;
+
+  do {
+    uint64_t remainder = 0;
+    isZero = true;
+
+    for (int i = 0; i < 4; i++) {
+      uint64_t current = (remainder << 32) | limbs[i];
+
+      limbs[i] = (uint32_t) (current / 10);
+      remainder = current % 10;
+
+      if (limbs[i]) { isZero = false; }
+    }
+
+    digits[count++] = (char) ('0' + remainder);
+  } while (!isZero && count < sizeof(digits));
+
+  size_t length = 0;
+
+  if (isNegative && size > 1) { value[length++] = '-'; }
+
+  while (count > 0 && length < size - 1) {
+    value[length++] = digits[--count];
+  }
+
+  value[length] = '\0';
+}
+#endif
+
+/*
+ * NewBigInt
+ *
+ * Returns a BigInt for a signed 128-bit magnitude, or a string if BigInt is
+ * not available or cannot be created from the value.
+ */
+
+static Local<Value> NewBigInt(bool isNegative, uint64_t low, uint64_t high) {
+#if defined(HAVE_BIGINT_WORDS)
+  uint64_t words[2] = { low, high };
+  return BigInt::NewFromWords(Nan::GetCurrentContext(), isNegative ? 1 : 0, high ? 2 : 1, words).ToLocalChecked();
+#else
+#if defined(HAVE_BIGINT)
+  if (high == 0 && low <= (uint64_t) INT64_MAX) {
+    return BigInt::New(v8::Isolate::GetCurrent(), isNegative ? -(int64_t) low : (int64_t) low);
+  }
+#endif
+  char value[48];
+  FormatMagnitude(isNegative, low, high, value, sizeof(value));
+  return Nan::New<String>(value).ToLocalChecked();
+#endif
+}
+
+/*
+ * getColumnValue
+ */
+
+Local<Value> RowBatch::getColumnValue(size_t row, short col) {
+  Nan::EscapableHandleScope scope;
+
+  if (this->isNull(row, col)) {
+    return scope.Escape(Nan::Null());
+  }
+
+  return scope.Escape((this->*this->_batchColumns[col].convert)(row, col));
+}
+
+Local<Value> RowBatch::convertInteger(size_t row, short col) {
+  return Nan::New<Integer>(((int32_t*) this->_batchColumns[col].values.data())[row]);
+}
+
+Local<Value> RowBatch::convertBigIntString(size_t row, short col) {
+  char value[32];
+  snprintf(value, sizeof(value), "%lld", (long long) ((int64_t*) this->_batchColumns[col].values.data())[row]);
+  return Nan::New<String>(value).ToLocalChecked();
+}
+
+Local<Value> RowBatch::convertBigIntNumber(size_t row, short col) {
+  int64_t value = ((int64_t*) this->_batchColumns[col].values.data())[row];
+
+  if (value >= -MAX_SAFE_INTEGER && value <= MAX_SAFE_INTEGER) {
+    return Nan::New<Number>((double) value);
+  }
+  return this->convertBigInt(row, col);
+}
+
+Local<Value> RowBatch::convertBigInt(size_t row, short col) {
+#ifdef HAVE_BIGINT
+  return BigInt::New(v8::Isolate::GetCurrent(), ((int64_t*) this->_batchColumns[col].values.data())[row]);
+#else
+  // Returned as a string when BigInt is not available
+  return this->convertBigIntString(row, col);
+#endif
+}
+
+Local<Value> RowBatch::convertNumber(size_t row, short col) {
+  return Nan::New<Number>(((double*) this->_batchColumns[col].values.data())[row]);
+}
+
+Local<Value> RowBatch::convertBoolean(size_t row, short col) {
+  return Nan::New<Boolean>(this->_batchColumns[col].values.data()[row] != 0);
+}
+
+Local<Value> RowBatch::convertDecimal(size_t row, short col) {
+  SQL_NUMERIC_STRUCT* value = ((SQL_NUMERIC_STRUCT*) this->_batchColumns[col].values.data()) + row;
+
+  // The magnitude is stored little endian
+  uint64_t low = 0;
+  uint64_t high = 0;
+
+  for (int i = 7; i >= 0; i--) {
+    low = (low << 8) | value->val[i];
+    high = (high << 8) | value->val[i + 8];
+  }
+
+  Local<Object> decimal = Nan::New<Object>();
+
+  decimal->Set(Nan::New("value").ToLocalChecked(), NewBigInt(value->sign == 0, low, high));
+  decimal->Set(Nan::New("scale").ToLocalChecked(), Nan::New<Integer>(value->scale));
+
+  return decimal;
+}
+
+Local<Value> RowBatch::convertDate(size_t row, short col) {
+  BatchColumn& batchColumn = this->_batchColumns[col];
+  Local<Date> date = Nan::New<Date>(((double*) batchColumn.values.data())[row]).ToLocalChecked();
+
+  if (this->_dateFraction) {
+    date->Set(Nan::New("nanoseconds").ToLocalChecked(), Nan::New<Number>(((uint32_t*) batchColumn.data.data())[row]));
+  }
+
+  return date;
+}
+
+Local<Value> RowBatch::convertString(size_t row, short col) {
+  BatchColumn& batchColumn = this->_batchColumns[col];
+  uint32_t* offsets = (uint32_t*) batchColumn.values.data();
+  size_t length = offsets[row + 1] - offsets[row];
+  const uint8_t* value = batchColumn.data.data() + offsets[row];
+
+  if (length == 0) { return Nan::EmptyString(); }
+
+  // Only ASCII can be used as one byte string data without decoding
+  if (length >= EXTERNAL_STRING_MIN_SIZE && IsAscii(value, length)) {
+    char* data = (char*) this->takeValue(row, col);
+
+    if (data) {
+      ExternalOneByteString* resource = new ExternalOneByteString(data, length);
+      Local<String> string;
+
+      if (!Nan::New<String>(resource).ToLocal(&string)) {
+        delete resource;
+        return Nan::Undefined();
+      }
+      return string;
+    }
+  }
+
+  return Nan::New<String>((const char*) value, (int) length).ToLocalChecked();
+}
+
+Local<Value> RowBatch::convertWideString(size_t row, short col) {
+  BatchColumn& batchColumn = this->_batchColumns[col];
+  uint32_t* offsets = (uint32_t*) batchColumn.values.data();
+  size_t length = offsets[row + 1] - offsets[row];
+
+  if (length == 0) { return Nan::EmptyString(); }
+
+  if (length >= EXTERNAL_STRING_MIN_SIZE) {
+    uint16_t* data = (uint16_t*) this->takeValue(row, col);
+
+    if (data) {
+      ExternalTwoByteString* resource = new ExternalTwoByteString(data, length / sizeof(uint16_t));
+      Local<String> string;
+
+      if (!Nan::New<String>(resource).ToLocal(&string)) {
+        delete resource;
+        return Nan::Undefined();
+      }
+      return string;
+    }
+  }
+
+  return Nan::New<String>((const uint16_t*) (batchColumn.data.data() + offsets[row]), (int) (length / sizeof(uint16_t))).ToLocalChecked();
+}
+
+/*
+ * takeValue
+ *
+ * Returns a malloc'd copy of a variable length value. A value that is the
+ * only one in the column data, such as a long value fetched on its own, is
+ * handed over without copying, after which the batch must be cleared
+ * before it is converted again.
+ */
+
+uint8_t* RowBatch::takeValue(size_t row, short col) {
+  BatchColumn& batchColumn = this->_batchColumns[col];
+  uint32_t* offsets = (uint32_t*) batchColumn.values.data();
+  size_t length = offsets[row + 1] - offsets[row];
+
+  if (this->_rowCount == 1 && offsets[row] == 0 && length == batchColumn.data.size()) {
+    return batchColumn.data.detach();
+  }
+
+  uint8_t* value = (uint8_t*) malloc(length);
+
+  if (value) {
+    memcpy(value, batchColumn.data.data() + offsets[row], length);
+  }
+
+  return value;
+}
+
+Local<Value> RowBatch::convertBinary(size_t row, short col) {
+  BatchColumn& batchColumn = this->_batchColumns[col];
+  uint32_t* offsets = (uint32_t*) batchColumn.values.data();
+  size_t length = offsets[row + 1] - offsets[row];
+  uint8_t* value = batchColumn.data.data() + offsets[row];
+
+  // Binary values are returned as a single Buffer, or as an array of Buffers
+  // of at most valueChunkSize bytes if they do not fit in one
+  size_t chunkSize = this->_valueChunkSize > 0 ? this->_valueChunkSize : length;
+
+  if (length <= chunkSize) {
+    return Nan::CopyBuffer((const char*) value, (uint32_t) length).ToLocalChecked();
+  }
+
+  Local<Array> buffers = Nan::New<Array>();
+  uint32_t count = 0;
+
+  for (size_t offset = 0; offset < length; offset += chunkSize) {
+    size_t size = length - offset < chunkSize ? length - offset : chunkSize;
+
+    buffers->Set(Nan::New(count++), Nan::CopyBuffer((const char*) value + offset, (uint32_t) size).ToLocalChecked());
+  }
+
+  return buffers;
+}
+
+/*
+ * convertStream
+ *
+ * Creates a stream of the value with the _createColumnStream method of the
+ * owning result, passing the column, the first part of the value, whether
+ * there is more to read, the text encoding and the fetch count.
+ */
+
+Local<Value> RowBatch::convertStream(size_t row, short col) {
+  BatchColumn& batchColumn = this->_batchColumns[col];
+  uint32_t* offsets = (uint32_t*) batchColumn.values.data();
+  Local<Value> chunk = Nan::CopyBuffer((const char*) batchColumn.data.data() + offsets[row], offsets[row + 1] - offsets[row]).ToLocalChecked();
+
+  if (this->_streamOwner.IsEmpty()) {
+    return chunk;
+  }
+
+  Local<Object> owner = Nan::New(this->_streamOwner);
+  Local<Value> factory = owner->Get(Nan::New("_createColumnStream").ToLocalChecked());
+
+  if (!factory->IsFunction()) {
+    return chunk;
+  }
+
+  Local<Value> encoding = Nan::Undefined();
+
+  if (batchColumn.cType == SQL_C_WCHAR) {
+    encoding = Nan::New("utf16le").ToLocalChecked();
+  }
+  else if (batchColumn.cType == SQL_C_CHAR) {
+    encoding = Nan::New("utf8").ToLocalChecked();
+  }
+
+  Local<Value> argv[] = {
+    Nan::New(col),
+    chunk,
+    Nan::New(batchColumn.hasMore),
+    encoding,
+    Nan::New<Number>((double) this->_fetchCount)
+  };
+
+  Local<Value> stream = Local<Function>::Cast(factory)->Call(owner, 5, argv);
+
+  return stream.IsEmpty() ? chunk : stream;
+}
+
+/*
+ * setStreamOwner
+ *
+ * Sets the result that streamed columns are created by.
+ */
+
+void RowBatch::setStreamOwner(Local<Object> owner, size_t fetchCount) {
+  if (this->_streamCount > 0) {
+    this->_streamOwner.Reset(owner);
+    this->_fetchCount = fetchCount;
+  }
+}
+
+/*
+ * getColumnValues
+ */
+
+Local<Array> RowBatch::getColumnValues(short col) {
+  Nan::EscapableHandleScope scope;
+
+  Local<Array> values = Nan::New<Array>((int) this->_rowCount);
+
+  for (size_t i = 0; i < this->_rowCount; i++) {
+    values->Set(Nan::New((uint32_t) i), this->getColumnValue(i, col));
+  }
+
+  return scope.Escape(values);
+}
+
+/*
+ * getRecordTuple
+ */
+
+Local<Object> RowBatch::getRecordTuple(size_t row, RecordShape* shape) {
+  Nan::EscapableHandleScope scope;
+
+  Local<Object> tuple = shape->newRecord();
+
+  for (short i = 0; i < this->_colCount; i++) {
+    tuple->Set( shape->getName(i),
+                this->getColumnValue(row, i));
+  }
+
+  return scope.Escape(tuple);
+}
+
+/*
+ * getRecordArray
+ */
+
+Local<Array> RowBatch::getRecordArray(size_t row) {
+  Nan::EscapableHandleScope scope;
+
+  Local<Array> array = Nan::New<Array>(this->_colCount);
+
+  for (short i = 0; i < this->_colCount; i++) {
+    array->Set( Nan::New(i),
+                this->getColumnValue(row, i));
+  }
+
+  return scope.Escape(array);
+}
+
+/*
+ * getColumnar
+ *
+ * Returns one object per column. Fixed width values are returned as a typed
+ * array, variable length values as offsets into a Buffer. Nulls are returned
+ * as a bitmap with one bit per row, least significant bit first. The typed
+ * arrays take ownership of the batch buffers so no values are copied.
+ */
+
+static Local<ArrayBuffer> DetachArrayBuffer(BatchBuffer& buffer, size_t length) {
+  if (length == 0 || buffer.size() < length) {
+    return ArrayBuffer::New(v8::Isolate::GetCurrent(), length);
+  }
+
+  return ArrayBuffer::New(v8::Isolate::GetCurrent(), buffer.detach(), length, ArrayBufferCreationMode::kInternalized);
+}
+
+Local<Array> RowBatch::getColumnar() {
+  Nan::EscapableHandleScope scope;
+
+  Local<String> nameKey = Nan::New("name").ToLocalChecked();
+  Local<String> typeKey = Nan::New("type").ToLocalChecked();
+  Local<String> valuesKey = Nan::New("values").ToLocalChecked();
+  Local<String> nullsKey = Nan::New("nulls").ToLocalChecked();
+  Local<String> offsetsKey = Nan::New("offsets").ToLocalChecked();
+  Local<String> dataKey = Nan::New("data").ToLocalChecked();
+  Local<String> encodingKey = Nan::New("encoding").ToLocalChecked();
+  Local<String> nanosecondsKey = Nan::New("nanoseconds").ToLocalChecked();
+
+  Local<Array> columns = Nan::New<Array>();
+  size_t rowCount = this->_rowCount;
+  size_t nullsLength = (rowCount + 7) / 8;
+
+  for (short i = 0; i < this->_colCount; i++) {
+    BatchColumn& batchColumn = this->_batchColumns[i];
+    Local<Object> column = Nan::New<Object>();
+
+#ifdef UNICODE
+    column->Set(nameKey, Nan::New((const uint16_t *) this->_columns[i].name).ToLocalChecked());
+#else
+    column->Set(nameKey, Nan::New((const char *) this->_columns[i].name).ToLocalChecked());
+#endif
+
+    switch (batchColumn.type) {
+      case RowBatch::TYPE_INTEGER:
+        column->Set(typeKey, Nan::New("int32").ToLocalChecked());
+        column->Set(valuesKey, Int32Array::New(DetachArrayBuffer(batchColumn.values, rowCount * batchColumn.width), 0, rowCount));
+        break;
+      case RowBatch::TYPE_BIGINT:
+        column->Set(typeKey, Nan::New("bigint").ToLocalChecked());
+#ifdef HAVE_BIGINT
+        column->Set(valuesKey, BigInt64Array::New(DetachArrayBuffer(batchColumn.values, rowCount * batchColumn.width), 0, rowCount));
+#else
+        column->Set(valuesKey, this->getColumnValues(i));
+#endif
+        break;
+      case RowBatch::TYPE_DATE:
+        column->Set(typeKey, Nan::New("date").ToLocalChecked());
+        column->Set(valuesKey, Float64Array::New(DetachArrayBuffer(batchColumn.values, rowCount * batchColumn.width), 0, rowCount));
+
+        if (this->_dateFraction) {
+          column->Set(nanosecondsKey, Uint32Array::New(DetachArrayBuffer(batchColumn.data, rowCount * sizeof(uint32_t)), 0, rowCount));
+        }
+        break;
+      case RowBatch::TYPE_DECIMAL:
+        // Decimal values have no typed array, so the converted values are returned
+        column->Set(typeKey, Nan::New("decimal").ToLocalChecked());
+        column->Set(valuesKey, this->getColumnValues(i));
+        break;
+      case RowBatch::TYPE_NUMBER:
+        column->Set(typeKey, Nan::New("float64").ToLocalChecked());
+        column->Set(valuesKey, Float64Array::New(DetachArrayBuffer(batchColumn.values, rowCount * batchColumn.width), 0, rowCount));
+        break;
+      case RowBatch::TYPE_BOOLEAN:
+        column->Set(typeKey, Nan::New("boolean").ToLocalChecked());
+        column->Set(valuesKey, Uint8Array::New(DetachArrayBuffer(batchColumn.values, rowCount * batchColumn.width), 0, rowCount));
+        break;
+      default:
+      {
+        size_t dataLength = batchColumn.data.size();
+
+        if (batchColumn.type == RowBatch::TYPE_BINARY) {
+          column->Set(typeKey, Nan::New("binary").ToLocalChecked());
+        }
+        else {
+          column->Set(typeKey, Nan::New("string").ToLocalChecked());
+          column->Set(encodingKey, Nan::New(batchColumn.type == RowBatch::TYPE_WIDE_STRING ? "utf16le" : "utf8").ToLocalChecked());
+        }
+
+        column->Set(offsetsKey, Uint32Array::New(DetachArrayBuffer(batchColumn.values, (rowCount + 1) * batchColumn.width), 0, rowCount + 1));
+
+        if (dataLength > 0) {
+          column->Set(dataKey, Nan::NewBuffer((char*) batchColumn.data.detach(), (uint32_t) dataLength).ToLocalChecked());
+        }
+        else {
+          column->Set(dataKey, Nan::NewBuffer(0).ToLocalChecked());
+        }
+      }
+    }
+
+    column->Set(nullsKey, Uint8Array::New(DetachArrayBuffer(batchColumn.nulls, nullsLength), 0, nullsLength));
+
+    columns->Set(Nan::New(i), column);
+  }
+
+  this->clear();
+
+  return scope.Escape(columns);
+}
+
+/*
+ * getError
+ *
+ * Returns the error that stopped reading, either one raised by the batch
+ * itself or the diagnostics of the statement.
+ */
+
+Local<Object> RowBatch::getError(SQLHSTMT hStmt, const char* message) {
+  Nan::EscapableHandleScope scope;
+
+  if (this->_errorMessage) {
+    return scope.Escape(ODBC::GetError(this->_errorMessage, this->_errorCode, message));
+  }
+
+  return scope.Escape(ODBC::GetSQLError(SQL_HANDLE_STMT, hStmt, message));
+}
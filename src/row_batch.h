@@ -0,0 +1,190 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SRC_ROW_BATCH_H
+#define _SRC_ROW_BATCH_H
+
+#include "odbc.h"
+
+class RecordShape;
+
+// Growable malloc'd byte buffer
+class BatchBuffer {
+public:
+  BatchBuffer();
+  ~BatchBuffer();
+
+  void clear();
+  uint8_t* data();
+  size_t size();
+  size_t capacity();
+
+  bool reserve(size_t capacity, bool exact = false);
+  bool resize(size_t size);
+  bool append(const void* value, size_t length);
+  uint8_t* claim(size_t length);
+  uint8_t* detach();
+
+private:
+  uint8_t* _data;
+  size_t _size;
+  size_t _capacity;
+};
+
+// Column-wise native store for fetched rows. Rows are read with SQLGetData
+// (or copied from a bound rowset) without touching V8, so reading can happen
+// on a worker thread. Values are converted to V8 values on the event loop.
+//
+// Fixed width values (integer, bigint, number, boolean, decimal, date) are
+// stored contiguously per column. Variable length values (string, binary) are stored as
+// row + 1 offsets into a per-column data buffer. Nulls are tracked in a
+// packed bitmap per column.
+//
+// A streamed column only stores the first part of its value. The rest is
+// read with ODBCResult::getData through a stream created by the owning
+// result, so streaming requires batches of a single row. Only the last
+// column of a row can be streamed.
+class RowBatch {
+public:
+  enum Type { TYPE_INTEGER, TYPE_BIGINT, TYPE_NUMBER, TYPE_BOOLEAN, TYPE_DECIMAL, TYPE_DATE, TYPE_STRING, TYPE_WIDE_STRING, TYPE_BINARY, TYPE_STREAM };
+
+  RowBatch(Column* columns, short colCount, size_t maxValueSize, size_t valueChunkSize, ValueOptions& valueOptions);
+  ~RowBatch();
+
+  static RowBatch::Type GetValueType(Column& column, ValueOptions& valueOptions);
+  // Sets the precision and scale used for SQL_C_NUMERIC in the row descriptor
+  static SQLRETURN DescribeNumeric(SQLHSTMT hStmt, Column& column, SQLPOINTER data);
+  // C type that parts of a streamed column are read as
+  static SQLSMALLINT GetStreamType(Column& column);
+
+  void clear();
+  size_t rowCount();
+  short columnCount();
+  size_t byteSize();
+  void updateExternalMemory();
+  RowBatch::Type columnType(short col);
+
+  // Reading, safe to call off the event loop
+  SQLRETURN readRow(SQLHSTMT hStmt, uint8_t* buffer, int bufferLength);
+  SQLRETURN readColumn(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength);
+
+  bool appendNull(short col);
+  bool appendValue(short col, const void* value, size_t length);
+  bool appendTimestamp(short col, SQL_TIMESTAMP_STRUCT* value);
+  bool appendTime(short col, SQL_TIME_STRUCT* value);
+  void commitRow();
+  void rollbackRow();
+
+  void setError(const char* message, const char* code);
+
+  // Conversion, event loop only
+  void setStreamOwner(Local<Object> owner, size_t fetchCount);
+  Local<Value> getColumnValue(size_t row, short col);
+  Local<Object> getRecordTuple(size_t row, RecordShape* shape);
+  Local<Array> getRecordArray(size_t row);
+  // Hands the column buffers over to typed arrays and clears the batch
+  Local<Array> getColumnar();
+  Local<Object> getError(SQLHSTMT hStmt, const char* message);
+
+private:
+  typedef SQLRETURN (RowBatch::*ReadFunction)(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength);
+  typedef Local<Value> (RowBatch::*ConvertFunction)(size_t row, short col);
+
+  // Decoders are resolved once per column when the batch is created
+  struct BatchColumn {
+    RowBatch::Type type;
+    size_t width;
+    ReadFunction read;
+    ConvertFunction convert;
+
+    // Variable length values only
+    SQLSMALLINT cType;
+    size_t terminatorSize;
+    size_t chunkSize;
+
+    // Decimal values only
+    bool isDescribed;
+
+    // Streamed values only
+    bool hasMore;
+
+    BatchBuffer values;
+    BatchBuffer data;
+    BatchBuffer nulls;
+  };
+
+  template <typename T, SQLSMALLINT cType>
+  SQLRETURN readFixed(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength);
+  SQLRETURN readVariable(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength);
+  SQLRETURN readRemaining(SQLHSTMT hStmt, short col, size_t length, size_t* totalSize, bool* isComplete);
+  SQLRETURN readStream(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength);
+  SQLRETURN readDecimal(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength);
+  SQLRETURN readTimestamp(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength);
+  SQLRETURN readTime(SQLHSTMT hStmt, short col, uint8_t* buffer, int bufferLength);
+
+  Local<Value> convertInteger(size_t row, short col);
+  Local<Value> convertBigIntString(size_t row, short col);
+  Local<Value> convertBigIntNumber(size_t row, short col);
+  Local<Value> convertBigInt(size_t row, short col);
+  Local<Value> convertNumber(size_t row, short col);
+  Local<Value> convertBoolean(size_t row, short col);
+  Local<Value> convertDecimal(size_t row, short col);
+  Local<Value> convertDate(size_t row, short col);
+  Local<Value> convertString(size_t row, short col);
+  Local<Value> convertWideString(size_t row, short col);
+  Local<Value> convertBinary(size_t row, short col);
+  Local<Value> convertStream(size_t row, short col);
+
+  bool markRow(short col, bool isNull);
+  bool appendData(short col, const void* value, size_t length);
+  bool endValue(short col);
+  bool isNull(size_t row, short col);
+  uint8_t* takeValue(size_t row, short col);
+  bool appendDate(short col, const int64_t* localTime, uint32_t nanoseconds);
+  int64_t getLocalOffset(int64_t localTime);
+  Local<Array> getColumnValues(short col);
+
+  Column* _columns;
+  short _colCount;
+  BatchColumn* _batchColumns;
+  size_t _rowCount;
+
+  size_t _maxValueSize;
+  size_t _valueChunkSize;
+  size_t _externalMemory;
+
+  // Dates are stored as epoch milliseconds. With dateFraction, the
+  // nanoseconds within the millisecond are stored in the data buffer.
+  int _dateMode;
+  bool _dateFraction;
+
+  // Local time offset, valid for local times in [_offsetStart, _offsetEnd)
+  int64_t _offset;
+  int64_t _offsetStart;
+  int64_t _offsetEnd;
+
+  // Result that streams are created by, and the fetch they belong to
+  short _streamCount;
+  Nan::Persistent<Object> _streamOwner;
+  size_t _fetchCount;
+
+  const char* _errorMessage;
+  const char* _errorCode;
+};
+
+#endif
@@ -0,0 +1,454 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "odbc.h"
+#include "rowset.h"
+#include "row_batch.h"
+
+#define ROWSET_NO_ROW ((SQLULEN) -1)
+
+// Variable length columns are only bound when the driver reports a size that
+// fits, including SQL_NO_TOTAL or 0 for an unknown size. Values longer than
+// the reported size are still read again with SQLGetData.
+static bool HasBindableSize(Column& column) {
+  return column.length > 0 && column.octetLength > 0 && column.octetLength <= LONG_DATA_THRESHOLD;
+}
+
+// Determines how a column is bound. Returns false if the column must be read
+// with SQLGetData instead.
+static bool GetBindType(Column& column, ValueOptions& valueOptions, SQLSMALLINT* cType, SQLLEN* width) {
+  SQLLEN length = column.length > column.octetLength ? column.length : column.octetLength;
+
+  switch (RowBatch::GetValueType(column, valueOptions)) {
+    case RowBatch::TYPE_INTEGER:
+      *cType = SQL_C_SLONG;
+      *width = sizeof(int32_t);
+      return true;
+    case RowBatch::TYPE_BIGINT:
+      *cType = SQL_C_SBIGINT;
+      *width = sizeof(int64_t);
+      return true;
+    case RowBatch::TYPE_NUMBER:
+      *cType = SQL_C_DOUBLE;
+      *width = sizeof(double);
+      return true;
+    case RowBatch::TYPE_BOOLEAN:
+      *cType = SQL_C_BIT;
+      *width = sizeof(SQLCHAR);
+      return true;
+    case RowBatch::TYPE_DECIMAL:
+      *cType = SQL_C_NUMERIC;
+      *width = sizeof(SQL_NUMERIC_STRUCT);
+      return true;
+    case RowBatch::TYPE_DATE:
+      if (column.type == SQL_TIME || column.type == SQL_TYPE_TIME) {
+        *cType = SQL_C_TYPE_TIME;
+        *width = sizeof(SQL_TIME_STRUCT);
+      }
+      else {
+        *cType = SQL_C_TYPE_TIMESTAMP;
+        *width = sizeof(SQL_TIMESTAMP_STRUCT);
+      }
+      return true;
+    case RowBatch::TYPE_WIDE_STRING:
+      if (!HasBindableSize(column)) { return false; }
+
+      // Allow for surrogate pairs
+      *cType = SQL_C_WCHAR;
+      *width = (length * 2 + 1) * sizeof(uint16_t);
+      return true;
+    case RowBatch::TYPE_STRING:
+      break;
+    default:
+      return false;
+  }
+
+  switch (column.type) {
+    case SQL_CHAR:
+    case SQL_VARCHAR:
+    case SQL_LONGVARCHAR:
+      if (!HasBindableSize(column)) { return false; }
+
+      // Allow for multi-byte characters
+      *cType = SQL_C_CHAR;
+      *width = length * 4 + sizeof(char);
+      return true;
+    case SQL_NUMERIC:
+    case SQL_DECIMAL:
+    case SQL_DATE:
+    case SQL_TIME:
+    case SQL_TIMESTAMP:
+    case SQL_TYPE_DATE:
+    case SQL_TYPE_TIME:
+    case SQL_TYPE_TIMESTAMP:
+    case SQL_GUID:
+      if (length > LONG_DATA_THRESHOLD) { return false; }
+
+      // Allow for sign, decimal point and formatting
+      *cType = SQL_C_CHAR;
+      *width = length + 32;
+      return true;
+    default:
+      // Unknown types are read with SQLGetData
+      return false;
+  }
+}
+
+Rowset::Rowset(SQLHDBC hDbc, SQLHSTMT hStmt, Column* columns, short colCount, ValueOptions& valueOptions) {
+  this->_hDbc = hDbc;
+  this->_hStmt = hStmt;
+  this->_columns = columns;
+  this->_colCount = colCount;
+  this->_valueOptions = valueOptions;
+
+  this->_bound = NULL;
+  this->_isBound = false;
+  this->_rowStatus = NULL;
+  this->_canGetBound = false;
+
+  this->_rowsetSize = 1;
+  this->_rowsFetched = 0;
+  this->_positionedRow = ROWSET_NO_ROW;
+}
+
+Rowset::~Rowset() {
+  this->unbind();
+}
+
+bool Rowset::bind(size_t rowsetSize) {
+  SQLRETURN ret;
+
+  this->unbind();
+
+  if (rowsetSize <= 1 || this->_colCount <= 0) {
+    return false;
+  }
+
+  this->_bound = new BoundColumn[this->_colCount];
+
+  size_t rowWidth = 0;
+  short firstUnbound = -1;
+  short lastBound = -1;
+
+  for (short i = 0; i < this->_colCount; i++) {
+    BoundColumn& bound = this->_bound[i];
+
+    bound.data = NULL;
+    bound.indicators = NULL;
+
+    if (GetBindType(this->_columns[i], this->_valueOptions, &bound.cType, &bound.width)) {
+      rowWidth += bound.width + sizeof(SQLLEN);
+      lastBound = i;
+    } else {
+      bound.cType = SQL_UNKNOWN_TYPE;
+      bound.width = 0;
+
+      if (firstUnbound < 0) { firstUnbound = i; }
+    }
+  }
+
+  if (lastBound < 0) {
+    this->freeBuffers();
+    return false;
+  }
+
+  // Unbound columns are read with SQLGetData after positioning within the rowset
+  SQLUINTEGER extensions = 0;
+
+  ret = SQLGetInfo(this->_hDbc, SQL_GETDATA_EXTENSIONS, &extensions, sizeof(extensions), NULL);
+
+  if (!SQL_SUCCEEDED(ret)) {
+    extensions = 0;
+  }
+
+  if (firstUnbound >= 0) {
+    if (!(extensions & SQL_GD_BLOCK) ||
+        (firstUnbound < lastBound && !(extensions & SQL_GD_ANY_COLUMN))) {
+      DEBUG_PRINTF("Rowset::bind - SQLGetData not supported for block cursors\n");
+      this->freeBuffers();
+      return false;
+    }
+  }
+
+  this->_canGetBound = (extensions & SQL_GD_BLOCK) && (extensions & SQL_GD_BOUND) && (extensions & SQL_GD_ANY_COLUMN);
+
+  if (rowWidth * rowsetSize > ROWSET_BUFFER_SIZE_MAX) {
+    rowsetSize = ROWSET_BUFFER_SIZE_MAX / rowWidth;
+  }
+
+  if (rowsetSize <= 1) {
+    this->freeBuffers();
+    return false;
+  }
+
+  for (short i = 0; i < this->_colCount; i++) {
+    BoundColumn& bound = this->_bound[i];
+
+    if (bound.cType == SQL_UNKNOWN_TYPE) { continue; }
+
+    bound.data = (uint8_t*) malloc(bound.width * rowsetSize);
+    bound.indicators = (SQLLEN*) malloc(sizeof(SQLLEN) * rowsetSize);
+
+    if (!bound.data || !bound.indicators) {
+      this->freeBuffers();
+      return false;
+    }
+  }
+
+  this->_rowStatus = (SQLUSMALLINT*) malloc(sizeof(SQLUSMALLINT) * rowsetSize);
+
+  if (!this->_rowStatus) {
+    this->freeBuffers();
+    return false;
+  }
+
+  ret = SQLSetStmtAttr(this->_hStmt, SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER) SQL_BIND_BY_COLUMN, 0);
+
+  if (SQL_SUCCEEDED(ret)) {
+    ret = SQLSetStmtAttr(this->_hStmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) rowsetSize, 0);
+  }
+
+  if (!SQL_SUCCEEDED(ret)) {
+    DEBUG_PRINTF("Rowset::bind - Failed to set rowset size\n");
+    SQLSetStmtAttr(this->_hStmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 1, 0);
+    this->freeBuffers();
+    return false;
+  }
+
+  this->_isBound = true;
+
+  // The driver may substitute a different rowset size
+  SQLULEN actualSize = rowsetSize;
+  ret = SQLGetStmtAttr(this->_hStmt, SQL_ATTR_ROW_ARRAY_SIZE, &actualSize, 0, NULL);
+
+  if (!SQL_SUCCEEDED(ret) || actualSize <= 1 || actualSize > rowsetSize) {
+    this->unbind();
+    return false;
+  }
+
+  this->_rowsetSize = actualSize;
+
+  ret = SQLSetStmtAttr(this->_hStmt, SQL_ATTR_ROWS_FETCHED_PTR, &this->_rowsFetched, 0);
+
+  if (SQL_SUCCEEDED(ret)) {
+    ret = SQLSetStmtAttr(this->_hStmt, SQL_ATTR_ROW_STATUS_PTR, this->_rowStatus, 0);
+  }
+
+  for (short i = 0; i < this->_colCount && SQL_SUCCEEDED(ret); i++) {
+    BoundColumn& bound = this->_bound[i];
+
+    if (bound.cType == SQL_UNKNOWN_TYPE) { continue; }
+
+    ret = SQLBindCol(
+      this->_hStmt,
+      this->_columns[i].index,
+      bound.cType,
+      bound.data,
+      bound.width,
+      bound.indicators);
+
+    if (SQL_SUCCEEDED(ret) && bound.cType == SQL_C_NUMERIC) {
+      ret = RowBatch::DescribeNumeric(this->_hStmt, this->_columns[i], bound.data);
+    }
+  }
+
+  if (!SQL_SUCCEEDED(ret)) {
+    DEBUG_PRINTF("Rowset::bind - Failed to bind columns\n");
+    this->unbind();
+    return false;
+  }
+
+  DEBUG_PRINTF("Rowset::bind - rowsetSize=%zu rowWidth=%zu\n", (size_t) this->_rowsetSize, rowWidth);
+
+  return true;
+}
+
+void Rowset::unbind() {
+  if (this->_isBound) {
+    SQLFreeStmt(this->_hStmt, SQL_UNBIND);
+    SQLSetStmtAttr(this->_hStmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0);
+    SQLSetStmtAttr(this->_hStmt, SQL_ATTR_ROW_STATUS_PTR, NULL, 0);
+    SQLSetStmtAttr(this->_hStmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 1, 0);
+
+    this->_isBound = false;
+  }
+
+  this->freeBuffers();
+
+  this->_rowsetSize = 1;
+  this->_rowsFetched = 0;
+  this->_positionedRow = ROWSET_NO_ROW;
+}
+
+void Rowset::freeBuffers() {
+  free(this->_rowStatus);
+  this->_rowStatus = NULL;
+
+  if (!this->_bound) { return; }
+
+  for (short i = 0; i < this->_colCount; i++) {
+    free(this->_bound[i].data);
+    free(this->_bound[i].indicators);
+  }
+
+  delete [] this->_bound;
+  this->_bound = NULL;
+}
+
+SQLRETURN Rowset::fetch() {
+  this->_rowsFetched = 0;
+  this->_positionedRow = ROWSET_NO_ROW;
+
+  return SQLFetch(this->_hStmt);
+}
+
+SQLULEN Rowset::rowsetSize() {
+  return this->_rowsetSize;
+}
+
+SQLULEN Rowset::rowsFetched() {
+  return this->_rowsFetched;
+}
+
+bool Rowset::position(SQLULEN row) {
+  if (this->_positionedRow == row) { return true; }
+
+  SQLRETURN ret = SQLSetPos(this->_hStmt, row + 1, SQL_POSITION, SQL_LOCK_NO_CHANGE);
+
+  if (!SQL_SUCCEEDED(ret)) { return false; }
+
+  this->_positionedRow = row;
+  return true;
+}
+
+// Whether a bound character value is longer than its binding
+bool Rowset::isTruncated(BoundColumn& bound, SQLULEN row) {
+  if (bound.cType != SQL_C_CHAR && bound.cType != SQL_C_WCHAR) { return false; }
+
+  SQLLEN len = bound.indicators[row];
+  size_t terminatorSize = bound.cType == SQL_C_WCHAR ? sizeof(uint16_t) : sizeof(char);
+
+  return len == SQL_NO_TOTAL || (len != SQL_NULL_DATA && len > (SQLLEN) (bound.width - terminatorSize));
+}
+
+// Reads a value of the row with SQLGetData
+SQLRETURN Rowset::readColumn(RowBatch* batch, SQLULEN row, short col, uint8_t* buffer, int bufferLength) {
+  if (!this->position(row)) { return SQL_ERROR; }
+
+  return batch->readColumn(this->_hStmt, col, buffer, bufferLength);
+}
+
+/*
+ * readRows
+ *
+ * Copies the fetched rowset into the batch. Bound columns are taken from the
+ * bound buffers and the remaining columns are read with SQLGetData. Rows the
+ * driver failed to fetch, and values longer than their binding, are read
+ * again with SQLGetData so that the driver either returns them in full or
+ * reports the error for the row.
+ */
+
+SQLRETURN Rowset::readRows(RowBatch* batch, uint8_t* buffer, int bufferLength) {
+  for (SQLULEN row = 0; row < this->_rowsFetched; row++) {
+    SQLUSMALLINT status = this->_rowStatus[row];
+
+    if (status == SQL_ROW_NOROW) { continue; }
+
+    bool isRowError = status == SQL_ROW_ERROR;
+
+    if (isRowError && !this->_canGetBound) {
+      batch->setError("[node-odbc] Error fetching a row in rowset fetch", NULL);
+      return SQL_ERROR;
+    }
+
+    for (short col = 0; col < this->_colCount; col++) {
+      BoundColumn& bound = this->_bound[col];
+
+      if (bound.cType == SQL_UNKNOWN_TYPE || isRowError || (this->_canGetBound && this->isTruncated(bound, row))) {
+        SQLRETURN ret = this->readColumn(batch, row, col, buffer, bufferLength);
+
+        if (!SQL_SUCCEEDED(ret)) {
+          batch->rollbackRow();
+          return SQL_ERROR;
+        }
+
+        continue;
+      }
+
+      SQLLEN len = bound.indicators[row];
+      uint8_t* value = bound.data + row * bound.width;
+      bool isStored;
+
+      switch (bound.cType) {
+        case SQL_C_SLONG:
+        case SQL_C_SBIGINT:
+        case SQL_C_DOUBLE:
+        case SQL_C_BIT:
+        case SQL_C_NUMERIC:
+          isStored = len == SQL_NULL_DATA ? batch->appendNull(col) : batch->appendValue(col, value, bound.width);
+          break;
+        case SQL_C_TYPE_TIMESTAMP:
+        {
+          SQL_TIMESTAMP_STRUCT timestamp;
+
+          memcpy(&timestamp, value, sizeof(timestamp));
+          isStored = batch->appendTimestamp(col, len == SQL_NULL_DATA ? NULL : &timestamp);
+          break;
+        }
+        case SQL_C_TYPE_TIME:
+        {
+          SQL_TIME_STRUCT time;
+
+          memcpy(&time, value, sizeof(time));
+          isStored = batch->appendTime(col, len == SQL_NULL_DATA ? NULL : &time);
+          break;
+        }
+        case SQL_C_WCHAR:
+        case SQL_C_CHAR:
+        default:
+          if (len == SQL_NULL_DATA) {
+            isStored = batch->appendNull(col);
+            break;
+          }
+
+          //only when the driver cannot read the value again
+          if (this->isTruncated(bound, row)) {
+            DEBUG_PRINTF("Rowset::readRows - Truncated: index=%u len=%zi width=%zi\n",
+                         this->_columns[col].index, len, bound.width);
+
+            batch->setError("[node-odbc] Column data was truncated in rowset fetch", "01004");
+            isStored = false;
+            break;
+          }
+
+          isStored = batch->appendValue(col, value, len);
+      }
+
+      if (!isStored) {
+        batch->rollbackRow();
+        return SQL_ERROR;
+      }
+    }
+
+    batch->commitRow();
+  }
+
+  return SQL_SUCCESS;
+}
@@ -0,0 +1,85 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SRC_ROWSET_H
+#define _SRC_ROWSET_H
+
+#include "odbc.h"
+
+class RowBatch;
+
+// Upper bound on the memory bound to a single rowset; the rowset size is
+// reduced for wide rows so that all bound columns fit within this limit.
+#define ROWSET_BUFFER_SIZE_MAX 16777216
+
+// Block cursor over a result set. Bindable columns are bound column-wise
+// with SQLBindCol so that each SQLFetch returns up to rowsetSize rows.
+// Columns that cannot be bound (long data, unknown types, sizes the driver
+// does not report) are read per row with SQLSetPos and SQLGetData, as are
+// values that did not fit their binding and rows the driver failed to fetch,
+// where the driver allows it.
+class Rowset {
+public:
+  Rowset(SQLHDBC hDbc, SQLHSTMT hStmt, Column* columns, short colCount, ValueOptions& valueOptions);
+  ~Rowset();
+
+  // Returns false if a block cursor cannot be used for the result set, in
+  // which case the statement is left unbound.
+  bool bind(size_t rowsetSize);
+  void unbind();
+
+  SQLRETURN fetch();
+
+  SQLULEN rowsetSize();
+  SQLULEN rowsFetched();
+
+  // Appends the rows of the current rowset to the batch
+  SQLRETURN readRows(RowBatch* batch, uint8_t* buffer, int bufferLength);
+
+private:
+  struct BoundColumn {
+    SQLSMALLINT cType;
+    SQLLEN width;
+    uint8_t* data;
+    SQLLEN* indicators;
+  };
+
+  bool position(SQLULEN row);
+  bool isTruncated(BoundColumn& bound, SQLULEN row);
+  SQLRETURN readColumn(RowBatch* batch, SQLULEN row, short col, uint8_t* buffer, int bufferLength);
+  void freeBuffers();
+
+  SQLHDBC _hDbc;
+  SQLHSTMT _hStmt;
+  Column* _columns;
+  short _colCount;
+  ValueOptions _valueOptions;
+
+  BoundColumn* _bound;
+  bool _isBound;
+  // SQL_ROW_* status of each row of the rowset
+  SQLUSMALLINT* _rowStatus;
+  // Whether SQLGetData can read bound columns again
+  bool _canGetBound;
+
+  SQLULEN _rowsetSize;
+  SQLULEN _rowsFetched;
+  SQLULEN _positionedRow;
+};
+
+#endif
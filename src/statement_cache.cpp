@@ -0,0 +1,292 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "odbc.h"
+#include "statement_cache.h"
+
+StatementCache::StatementCache(HandleLock* lock) {
+  this->_capacity = 0;
+  this->_generation = 0;
+  this->_hits = 0;
+  this->_misses = 0;
+  this->_evictions = 0;
+  this->_freeListSize = STATEMENT_FREE_LIST_SIZE_DEFAULT;
+  this->_recycled = 0;
+  this->_refCount = 0;
+
+  this->_lock = lock;
+  this->_lock->ref();
+}
+
+StatementCache::~StatementCache() {
+  this->clear();
+  this->_lock->unref();
+}
+
+void StatementCache::ref() {
+  this->_refCount++;
+}
+
+void StatementCache::unref() {
+  if (--this->_refCount <= 0) {
+    delete this;
+  }
+}
+
+size_t StatementCache::capacity() {
+  return this->_capacity;
+}
+
+void StatementCache::setCapacity(size_t capacity) {
+  this->_capacity = capacity;
+  this->trim();
+}
+
+size_t StatementCache::size() {
+  return this->_entries.size();
+}
+
+size_t StatementCache::hits() {
+  return this->_hits;
+}
+
+size_t StatementCache::misses() {
+  return this->_misses;
+}
+
+size_t StatementCache::evictions() {
+  return this->_evictions;
+}
+
+size_t StatementCache::freeListSize() {
+  return this->_freeListSize;
+}
+
+void StatementCache::setFreeListSize(size_t freeListSize) {
+  this->_freeListSize = freeListSize;
+
+  while (this->_freeHandles.size() > this->_freeListSize) {
+    this->freeHandle(this->_freeHandles.back());
+    this->_freeHandles.pop_back();
+  }
+}
+
+/*
+ * acquire
+ *
+ * Takes the idle prepared handle for key out of the cache, or a reset
+ * handle from the free list. If neither is available, the lease is still
+ * returned so that the handle allocated by the execution can be kept on
+ * release.
+ */
+
+StatementLease* StatementCache::acquire(const std::string& key) {
+  bool isCached = this->_capacity > 0 && !key.empty();
+
+  if (!isCached && this->_freeListSize == 0) { return NULL; }
+
+  StatementLease* lease = new StatementLease();
+
+  lease->cache = this;
+  lease->generation = this->_generation;
+  lease->hStmt = NULL;
+  lease->isCached = isCached;
+  lease->isPrepared = false;
+  lease->isReusable = true;
+
+  if (isCached) {
+    lease->key = key;
+
+    std::unordered_map<std::string, EntryList::iterator>::iterator it = this->_index.find(key);
+
+    if (it == this->_index.end()) {
+      this->_misses++;
+    } else {
+      lease->hStmt = it->second->second;
+      lease->isPrepared = true;
+
+      this->_entries.erase(it->second);
+      this->_index.erase(it);
+      this->_hits++;
+    }
+  }
+
+  if (!lease->hStmt && !this->_freeHandles.empty()) {
+    lease->hStmt = this->_freeHandles.back();
+    this->_freeHandles.pop_back();
+    this->_recycled++;
+  }
+
+  this->ref();
+  return lease;
+}
+
+/*
+ * release
+ *
+ * The handle is reset, since the bound buffers belong to the execution.
+ * Only one idle prepared handle is kept per key, so a handle prepared by a
+ * concurrent execution of the same SQL goes to the free list.
+ */
+
+void StatementCache::release(StatementLease* lease) {
+  HSTMT hStmt = lease->hStmt;
+
+  if (hStmt) {
+    bool canReuse = lease->isReusable
+      && lease->generation == this->_generation
+      && ResetHandle(hStmt);
+
+    if (!canReuse) {
+      this->freeHandle(hStmt);
+    } else if (lease->isCached && this->_capacity > 0 && this->_index.find(lease->key) == this->_index.end()) {
+      this->_entries.push_front(std::make_pair(lease->key, hStmt));
+      this->_index[lease->key] = this->_entries.begin();
+
+      this->trim();
+    } else {
+      this->recycle(hStmt);
+    }
+  }
+
+  delete lease;
+  this->unref();
+}
+
+void StatementCache::trim() {
+  while (this->_entries.size() > this->_capacity) {
+    this->recycle(this->_entries.back().second);
+
+    this->_index.erase(this->_entries.back().first);
+    this->_entries.pop_back();
+    this->_evictions++;
+  }
+}
+
+void StatementCache::recycle(HSTMT hStmt) {
+  if (this->_freeHandles.size() < this->_freeListSize) {
+    this->_freeHandles.push_back(hStmt);
+  } else {
+    this->freeHandle(hStmt);
+  }
+}
+
+void StatementCache::clear() {
+  for (EntryList::iterator it = this->_entries.begin(); it != this->_entries.end(); it++) {
+    this->freeHandle(it->second);
+  }
+
+  for (size_t i = 0; i < this->_freeHandles.size(); i++) {
+    this->freeHandle(this->_freeHandles[i]);
+  }
+
+  this->_entries.clear();
+  this->_index.clear();
+  this->_freeHandles.clear();
+  this->_generation++;
+}
+
+void StatementCache::add(const std::string& key, HSTMT hStmt) {
+  if (this->_capacity > 0 && !key.empty() && this->_index.find(key) == this->_index.end()) {
+    this->_entries.push_front(std::make_pair(key, hStmt));
+    this->_index[key] = this->_entries.begin();
+
+    this->trim();
+  } else {
+    this->recycle(hStmt);
+  }
+}
+
+bool StatementCache::hasHandles() {
+  return !this->_entries.empty() || !this->_freeHandles.empty();
+}
+
+/*
+ * allocHandle
+ *
+ * Only allocation takes the lock. Reused handles skip it.
+ */
+
+SQLRETURN StatementCache::allocHandle(HDBC hDBC, StatementLease* lease, HSTMT* hStmt) {
+  if (lease && lease->hStmt) {
+    *hStmt = lease->hStmt;
+    return SQL_SUCCESS;
+  }
+
+  this->_lock->lock();
+
+  SQLRETURN ret = SQLAllocHandle(SQL_HANDLE_STMT, hDBC, hStmt);
+
+  this->_lock->unlock();
+
+  if (lease && SQL_SUCCEEDED(ret)) {
+    lease->hStmt = *hStmt;
+  }
+
+  return ret;
+}
+
+/*
+ * ResetHandle
+ *
+ * Closes the cursor and drops the column and parameter bindings. These are
+ * statement level calls, so they do not take the lock.
+ */
+
+bool StatementCache::ResetHandle(HSTMT hStmt) {
+  SQLRETURN ret = SQLFreeStmt(hStmt, SQL_CLOSE);
+
+  if (SQL_SUCCEEDED(ret)) {
+    ret = SQLFreeStmt(hStmt, SQL_UNBIND);
+  }
+
+  if (SQL_SUCCEEDED(ret)) {
+    ret = SQLFreeStmt(hStmt, SQL_RESET_PARAMS);
+  }
+
+  return SQL_SUCCEEDED(ret);
+}
+
+void StatementCache::freeHandle(HSTMT hStmt) {
+  this->_lock->lock();
+
+  SQLFreeHandle(SQL_HANDLE_STMT, hStmt);
+
+  this->_lock->unlock();
+}
+
+/*
+ * getStats
+ */
+
+Local<Object> StatementCache::getStats() {
+  Nan::EscapableHandleScope scope;
+
+  Local<Object> stats = Nan::New<Object>();
+
+  stats->Set(Nan::New("size").ToLocalChecked(), Nan::New<Number>((double) this->_entries.size()));
+  stats->Set(Nan::New("capacity").ToLocalChecked(), Nan::New<Number>((double) this->_capacity));
+  stats->Set(Nan::New("hits").ToLocalChecked(), Nan::New<Number>((double) this->_hits));
+  stats->Set(Nan::New("misses").ToLocalChecked(), Nan::New<Number>((double) this->_misses));
+  stats->Set(Nan::New("evictions").ToLocalChecked(), Nan::New<Number>((double) this->_evictions));
+  stats->Set(Nan::New("freeHandles").ToLocalChecked(), Nan::New<Number>((double) this->_freeHandles.size()));
+  stats->Set(Nan::New("freeListSize").ToLocalChecked(), Nan::New<Number>((double) this->_freeListSize));
+  stats->Set(Nan::New("recycled").ToLocalChecked(), Nan::New<Number>((double) this->_recycled));
+
+  return scope.Escape(stats);
+}
@@ -0,0 +1,123 @@
+/*
+  ISC License
+
+  Copyright (c) 2017, Ratanak Lun <ratanakvlun@gmail.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SRC_STATEMENT_CACHE_H
+#define _SRC_STATEMENT_CACHE_H
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "odbc.h"
+#include "handle_lock.h"
+
+// Default number of idle statement handles kept for reuse per connection
+#define STATEMENT_FREE_LIST_SIZE_DEFAULT 4
+
+class StatementCache;
+
+// Statement handle checked out of a StatementCache for one execution, or
+// for the lifetime of an ODBCStatement. A lease without a handle is a miss,
+// and the execution allocates the handle itself. The result or statement
+// owns the lease and returns the handle to the cache when it is freed.
+struct StatementLease {
+  StatementCache* cache;
+  std::string key;
+  size_t generation;
+  HSTMT hStmt;
+  // The handle is prepared for key and cached again on release
+  bool isCached;
+  // The handle was taken from the cache and is already prepared
+  bool isPrepared;
+  // Cleared when the execution fails, so that the handle is freed on release
+  bool isReusable;
+};
+
+// Least recently used cache of prepared statement handles keyed by SQL
+// text, and a free list of reset handles for any statement. Only idle
+// handles are held. A handle in use is leased out, so that it is never
+// shared by two executions. A capacity of 0 disables the prepared cache,
+// and a free list size of 0 disables recycling. Event loop only, except for
+// allocHandle. Leases hold a reference, so the cache outlives the
+// connection until the last result using it is freed. Handles are
+// allocated and freed under the lock of the connection.
+class StatementCache {
+public:
+  explicit StatementCache(HandleLock* lock);
+
+  void ref();
+  void unref();
+
+  size_t capacity();
+  void setCapacity(size_t capacity);
+  size_t size();
+  size_t hits();
+  size_t misses();
+  size_t evictions();
+  size_t freeListSize();
+  void setFreeListSize(size_t freeListSize);
+
+  // Returns NULL if both caching and recycling are disabled. An empty key
+  // leases a handle that is only recycled.
+  StatementLease* acquire(const std::string& key);
+  // Returns the handle to the cache or the free list, or frees it. Deletes
+  // the lease.
+  void release(StatementLease* lease);
+  // Frees the idle handles. Must be called before the connection is
+  // disconnected. Handles leased out before are freed on release.
+  void clear();
+  // Caches a handle already prepared for key, such as one prepared when a
+  // pooled connection is made
+  void add(const std::string& key, HSTMT hStmt);
+  // True if any idle handle is held
+  bool hasHandles();
+
+  Local<Object> getStats();
+
+  // Sets *hStmt to the leased handle, or allocates one for the lease. Safe
+  // to call from the thread pool. The lease may be NULL.
+  SQLRETURN allocHandle(HDBC hDBC, StatementLease* lease, HSTMT* hStmt);
+
+private:
+  typedef std::list<std::pair<std::string, HSTMT> > EntryList;
+
+  ~StatementCache();
+
+  void trim();
+  void recycle(HSTMT hStmt);
+  static bool ResetHandle(HSTMT hStmt);
+  void freeHandle(HSTMT hStmt);
+
+  EntryList _entries;
+  std::unordered_map<std::string, EntryList::iterator> _index;
+  size_t _capacity;
+  size_t _generation;
+  size_t _hits;
+  size_t _misses;
+  size_t _evictions;
+
+  std::vector<HSTMT> _freeHandles;
+  size_t _freeListSize;
+  size_t _recycled;
+
+  HandleLock* _lock;
+  int _refCount;
+};
+
+#endif
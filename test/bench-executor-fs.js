@@ -0,0 +1,94 @@
+var common = require('./common')
+  , odbc = require('../')
+  , fs = require('fs')
+  , fork = require('child_process').fork
+  , queryCount = 4
+  , readCount = 200
+  , sql = 'with recursive c(x) as (select 1 union all select x + 1 from c where x < 2000000) select count(*) as C from c';
+
+//the executor can only be configured once per process, so each mode runs
+//in a child process
+if (!process.env.BENCH_EXECUTOR_THREADS) {
+  run('0', function () {
+    run(String(odbc.getExecutorStatsSync().threads));
+  });
+}
+else {
+  bench(Number(process.env.BENCH_EXECUTOR_THREADS));
+}
+
+function run(threads, done) {
+  var env = Object.assign({}, process.env, { BENCH_EXECUTOR_THREADS: threads });
+
+  fork(__filename, process.argv.slice(2), { env: env }).on('exit', function () {
+    done && done();
+  });
+}
+
+//reads files while long queries are running and reports read latency
+function bench(threads) {
+  var latencies = []
+    , finished = 0
+    , queriesDone = false;
+
+  odbc.configureExecutor({ threads: threads });
+
+  for (var i = 0; i < queryCount; i++) {
+    var db = new odbc.Database();
+
+    db.openSync(common.connectionString);
+    db.query(sql, queryDone(db));
+  }
+
+  function queryDone(db) {
+    return function (err) {
+      if (err) {
+        console.error(err);
+        process.exit(1);
+      }
+
+      db.closeSync();
+
+      if (++finished === queryCount) {
+        queriesDone = true;
+      }
+    };
+  }
+
+  read();
+
+  function read() {
+    var start = process.hrtime();
+
+    fs.readFile(__filename, function (err) {
+      var elapsed = process.hrtime(start);
+
+      latencies.push(elapsed[0] * 1e3 + elapsed[1] / 1e6);
+
+      if (latencies.length < readCount && !queriesDone) {
+        return read();
+      }
+
+      report();
+    });
+  }
+
+  function report() {
+    latencies.sort(function (a, b) { return a - b; });
+
+    var stats = odbc.getExecutorStatsSync();
+
+    console.log('%s: fs.readFile p50 %sms, p99 %sms, max %sms over %d reads, %d completions in %d wakeups',
+      threads ? threads + ' executor threads' : 'libuv thread pool',
+      percentile(0.5).toFixed(2),
+      percentile(0.99).toFixed(2),
+      latencies[latencies.length - 1].toFixed(2),
+      latencies.length,
+      stats.completed,
+      stats.wakeups);
+  }
+
+  function percentile(p) {
+    return latencies[Math.max(0, Math.ceil(p * latencies.length) - 1)];
+  }
+}
@@ -0,0 +1,46 @@
+var common = require('./common')
+  , odbc = require('../')
+  , connectionCount = 32
+  , levels = [
+      ['THREADING_PROCESS', odbc.THREADING_PROCESS]
+    , ['THREADING_ENVIRONMENT', odbc.THREADING_ENVIRONMENT]
+    , ['THREADING_CONNECTION', odbc.THREADING_CONNECTION]
+    ];
+
+openAll(levels.shift());
+
+function openAll(level) {
+  var dbs = []
+    , opened = 0
+    , time = new Date().getTime();
+
+  for (var i = 0; i < connectionCount; i++) {
+    var db = new odbc.Database({ threading: level[1] });
+
+    dbs.push(db);
+    db.open(common.connectionString, cb);
+  }
+
+  function cb (err) {
+    if (err) {
+      console.error(err);
+      process.exit(1);
+    }
+
+    if (++opened < connectionCount) {
+      return;
+    }
+
+    var elapsed = new Date().getTime() - time;
+
+    console.log('%s: %d connections opened in %d seconds', level[0], connectionCount, elapsed / 1000);
+
+    dbs.forEach(function (db) {
+      db.closeSync();
+    });
+
+    if (levels.length) {
+      openAll(levels.shift());
+    }
+  }
+}
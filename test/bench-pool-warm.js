@@ -0,0 +1,60 @@
+var common = require('./common')
+  , odbc = require('../')
+  , connectionCount = 16;
+
+openEach(function () {
+  warm(function () {});
+});
+
+//connections made one at a time as callers ask for them
+function openEach(done) {
+  var pool = new odbc.Pool()
+    , dbs = []
+    , time = new Date().getTime();
+
+  next();
+
+  function next() {
+    pool.open(common.connectionString, function (err, db) {
+      if (err) {
+        console.error(err);
+        process.exit(1);
+      }
+
+      dbs.push(db);
+
+      if (dbs.length < connectionCount) {
+        return next();
+      }
+
+      var elapsed = new Date().getTime() - time;
+
+      console.log('open: %d connections ready in %d seconds', connectionCount, elapsed / 1000);
+
+      dbs.forEach(function (db) {
+        db.closeSync();
+      });
+
+      pool.close(done);
+    });
+  }
+}
+
+//connections made all at once before they are needed
+function warm(done) {
+  var pool = new odbc.Pool({ warmConcurrency: connectionCount })
+    , time = new Date().getTime();
+
+  pool.warm(common.connectionString, connectionCount, function (err) {
+    if (err) {
+      console.error(err);
+      process.exit(1);
+    }
+
+    var elapsed = new Date().getTime() - time;
+
+    console.log('warm: %d connections ready in %d seconds', connectionCount, elapsed / 1000);
+
+    pool.close(done);
+  });
+}
@@ -0,0 +1,73 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  //1 KB to 1 GB, the largest value SQLite returns by default
+  , sizes = [1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9]
+  //bytes read for each size, at least one value
+  , bytesPerSize = 1e9
+  , cases = [];
+
+//large values are read by RowBatch::readVariable and readRemaining
+sizes.forEach(function (size) {
+  cases.push({ name: 'binary', size: size, sql: 'select zeroblob(' + size + ') as COLBINARY' });
+});
+
+sizes.forEach(function (size) {
+  cases.push({ name: 'text', size: size, sql: 'select hex(zeroblob(' + (size / 2) + ')) as COLTEXT' });
+});
+
+db.open(common.connectionString, function(err){
+  if (err) {
+    console.error(err);
+    process.exit(1);
+  }
+
+  issueQuery(cases.shift());
+});
+
+function issueQuery(test) {
+  var count = 0
+    , iterations = Math.max(1, Math.min(1000, Math.floor(bytesPerSize / test.size)))
+    , time = new Date().getTime();
+
+  function iteration() {
+    db.queryResult(test.sql, cb);
+  }
+
+  iteration();
+
+  function cb (err, result) {
+    if (err) {
+      console.error(err);
+      return next();
+    }
+
+    result.fetchAll(function (err, data) {
+      result.closeSync();
+
+      //values beyond the limits of the driver or V8 are reported and skipped
+      if (err) {
+        console.log('%s %d bytes: %s', test.name, test.size, err.message);
+        return next();
+      }
+
+      if (++count === iterations) {
+        var elapsed = new Date().getTime() - time;
+
+        console.log('%s %d bytes: %d values in %d seconds, %d MB/sec', test.name, test.size, count, elapsed / 1000, Math.floor(count * test.size / 1e6 / (elapsed / 1000)));
+
+        return next();
+      }
+
+      iteration();
+    });
+  }
+}
+
+function next() {
+  if (cases.length) {
+    return issueQuery(cases.shift());
+  }
+
+  db.close(function () {});
+}
@@ -0,0 +1,86 @@
+var common = require('./common')
+  , odbc = require('../')
+  , fs = require('fs')
+  , db = new odbc.Database()
+  , rowCount = 100000
+  , batchSizes = [1, 100, 1000, 10000]
+  , sql = "with recursive cnt(x) as (select 1 union all select x + 1 from cnt limit " + rowCount + ") "
+    + "select x as COLINT, 'some test ' || x as COLTEXT, x * 0.5 as COLREAL from cnt";
+
+db.open(common.connectionString, function(err){
+  if (err) {
+    console.error(err);
+    process.exit(1);
+  }
+
+  issueQuery(batchSizes.shift());
+});
+
+//Fetch all rows while file reads compete for the same libuv thread pool
+function issueQuery(batchSize) {
+  var done = false
+    , fsCount = 0
+    , fsLatency = 0
+    , fsLatencyMax = 0
+    , time = new Date().getTime();
+
+  function readFile() {
+    var start = process.hrtime();
+
+    fs.readFile(__filename, function (err) {
+      if (err) {
+        console.error(err);
+        return;
+      }
+
+      var diff = process.hrtime(start)
+        , latency = diff[0] * 1e3 + diff[1] / 1e6;
+
+      fsCount++;
+      fsLatency += latency;
+      fsLatencyMax = Math.max(fsLatencyMax, latency);
+
+      if (!done) {
+        readFile();
+      }
+    });
+  }
+
+  for (var i = 0; i < 4; i++) {
+    readFile();
+  }
+
+  db.queryResult(sql, function (err, result) {
+    if (err) {
+      console.error(err);
+      return finish();
+    }
+
+    result.fetchAll({ batchSize: batchSize }, function (err, data) {
+      done = true;
+
+      if (err) {
+        console.error(err);
+        return finish();
+      }
+
+      result.closeSync();
+
+      var elapsed = new Date().getTime() - time;
+
+      console.log('batchSize %d: %d rows fetched in %d seconds, %d rows/sec; %d file reads, %d ms avg latency, %d ms max latency',
+        batchSize, data.length, elapsed / 1000, Math.floor(data.length / (elapsed / 1000)),
+        fsCount, (fsLatency / (fsCount || 1)).toFixed(3), fsLatencyMax.toFixed(3));
+
+      if (batchSizes.length) {
+        return issueQuery(batchSizes.shift());
+      }
+
+      return finish();
+    });
+  });
+
+  function finish() {
+    db.close(function () {});
+  }
+}
@@ -0,0 +1,78 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , rowCount = 10000
+  , iterations = 5
+  , columnCounts = [10, 50, 200];
+
+db.open(common.connectionString, function(err){
+  if (err) {
+    console.error(err);
+    process.exit(1);
+  }
+
+  issueQuery(columnCounts.shift());
+});
+
+function buildQuery(columnCount) {
+  var columns = [];
+
+  for (var i = 0; i < columnCount; i++) {
+    switch (i % 3) {
+      case 0: columns.push("x + " + i + " as COL" + i); break;
+      case 1: columns.push("'text ' || x as COL" + i); break;
+      default: columns.push("x * 0.5 + " + i + " as COL" + i); break;
+    }
+  }
+
+  return "with recursive cnt(x) as (select 1 union all select x + 1 from cnt limit " + rowCount + ") "
+    + "select " + columns.join(', ') + " from cnt";
+}
+
+function issueQuery(columnCount) {
+  var count = 0
+    , rows = 0
+    , sql = buildQuery(columnCount)
+    , time = new Date().getTime();
+
+  function iteration() {
+    db.queryResult(sql, cb);
+  }
+
+  iteration();
+
+  function cb (err, result) {
+    if (err) {
+      console.error(err);
+      return finish();
+    }
+
+    result.fetchAll(function (err, data) {
+      if (err) {
+        console.error(err);
+        return finish();
+      }
+
+      result.closeSync();
+      rows += data.length;
+
+      if (++count === iterations) {
+        var elapsed = new Date().getTime() - time;
+
+        console.log('%d columns: %d rows fetched in %d seconds, %d rows/sec', columnCount, rows, elapsed / 1000, Math.floor(rows / (elapsed / 1000)));
+
+        if (columnCounts.length) {
+          return issueQuery(columnCounts.shift());
+        }
+
+        return finish();
+      } else {
+        iteration();
+      }
+    });
+  }
+
+  function finish() {
+    db.close(function () {});
+  }
+}
@@ -0,0 +1,64 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , rowCount = 50000
+  , iterations = 5
+  , rowsetSizes = [1, 100, 1000]
+  , sql = "with recursive cnt(x) as (select 1 union all select x + 1 from cnt limit " + rowCount + ") "
+    + "select x as COLINT, 'some test ' || x as COLTEXT, x * 0.5 as COLREAL from cnt";
+
+db.open(common.connectionString, function(err){
+  if (err) {
+    console.error(err);
+    process.exit(1);
+  }
+
+  issueQuery(rowsetSizes.shift());
+});
+
+function issueQuery(rowsetSize) {
+  var count = 0
+    , rows = 0
+    , time = new Date().getTime();
+
+  function iteration() {
+    db.queryResult(sql, cb);
+  }
+
+  iteration();
+
+  function cb (err, result) {
+    if (err) {
+      console.error(err);
+      return finish();
+    }
+
+    result.fetchAll({ rowsetSize: rowsetSize }, function (err, data) {
+      if (err) {
+        console.error(err);
+        return finish();
+      }
+
+      result.closeSync();
+      rows += data.length;
+
+      if (++count === iterations) {
+        var elapsed = new Date().getTime() - time;
+
+        console.log('rowsetSize %d: %d rows fetched in %d seconds, %d rows/sec', rowsetSize, rows, elapsed / 1000, Math.floor(rows / (elapsed / 1000)));
+
+        if (rowsetSizes.length) {
+          return issueQuery(rowsetSizes.shift());
+        }
+
+        return finish();
+      } else {
+        iteration();
+      }
+    });
+  }
+
+  function finish() {
+    db.close(function () {});
+  }
+}
@@ -0,0 +1,33 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database();
+
+db.open(common.connectionString, function(err){
+  if (err) {
+    console.error(err);
+    process.exit(1);
+  }
+
+  issueQuery();
+});
+
+function issueQuery() {
+  var count = 0
+    , iterations = 10000
+    , rss = process.memoryUsage().rss
+    , time = new Date().getTime();
+
+  for (var x = 0; x < iterations; x++) {
+    var result = db.queryResultSync('select 1 + 1 as test');
+    result.fetchAllSync();
+    result.closeSync();
+    count += 1;
+  }
+
+  var elapsed = new Date().getTime() - time;
+
+  console.log('%d queries issued in %d seconds, %d/sec', count, elapsed / 1000, Math.floor(count / (elapsed / 1000)));
+  console.log('rss grew by %d KB', Math.floor((process.memoryUsage().rss - rss) / 1024));
+
+  db.close(function () { });
+}
@@ -1,17 +1,23 @@
 var common = require('./common')
   , odbc = require('../')
-  , db = new odbc.Database();
+  , statementCacheSizes = [0, 16];
 
-db.open(common.connectionString, function(err){
-  if (err) {
-    console.error(err);
-    process.exit(1);
-  }
+issueQueries(statementCacheSizes.shift());
+
+function issueQueries(statementCacheSize) {
+  var db = new odbc.Database({ statementCacheSize: statementCacheSize });
 
-  issueQuery();
-});
+  db.open(common.connectionString, function(err){
+    if (err) {
+      console.error(err);
+      process.exit(1);
+    }
+
+    issueQuery(db, statementCacheSize);
+  });
+}
 
-function issueQuery() {
+function issueQuery(db, statementCacheSize) {
   var iterations = 10000
     , time = new Date().getTime();
 
@@ -20,7 +26,11 @@ function issueQuery() {
   }
 
   var elapsed = new Date().getTime() - time;
-  console.log('%d queries issued in %d seconds, %d/sec', iterations, elapsed / 1000, Math.floor(iterations / (elapsed / 1000)));
+  console.log('statementCacheSize %d: %d queries issued in %d seconds, %d/sec', statementCacheSize, iterations, elapsed / 1000, Math.floor(iterations / (elapsed / 1000)));
 
-  db.close(function () {});
+  db.close(function () {
+    if (statementCacheSizes.length) {
+      issueQueries(statementCacheSizes.shift());
+    }
+  });
 }
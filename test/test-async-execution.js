@@ -0,0 +1,108 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database({ asyncExecution: true })
+  , assert = require('assert')
+  , queryCount = 8
+  , received = 0;
+
+db.openSync(common.connectionString);
+
+assert.equal(db.connected, true);
+assert.equal(db.conn.asyncExecution, true);
+
+//runs asynchronously or as before, depending on the driver
+for (var i = 0; i < queryCount; i++) {
+  db.query('select ' + i + ' as COLINT', checkQuery(i));
+}
+
+function checkQuery(i) {
+  return function (err, data) {
+    assert.equal(err, null);
+    assert.deepEqual(data, [{ COLINT: i }]);
+
+    if (++received === queryCount) {
+      testStatement();
+    }
+  };
+}
+
+function testStatement() {
+  db.prepare('select ? as col1', function (err, stmt) {
+    assert.equal(err, null);
+    assert.equal(stmt.asyncExecution, true);
+
+    stmt.execute(['hello world'], function (err, result) {
+      assert.equal(err, null);
+
+      result.fetchAll(function (err, data) {
+        assert.equal(err, null);
+        assert.deepEqual(data, [{ col1: 'hello world' }]);
+
+        result.closeSync();
+        stmt.closeSync();
+
+        testStillExecuting();
+      });
+    });
+  });
+}
+
+//the test hook answers polls with SQL_STILL_EXECUTING before the driver is
+//called, so the polling path runs even where the driver executes synchronously
+function testStillExecuting() {
+  var polled = 0;
+
+  db.conn._stillExecutingPolls = 5;
+  assert.equal(db.conn._stillExecutingPolls, 5);
+
+  for (var i = 0; i < queryCount; i++) {
+    db.query('select ' + i + ' as COLINT', checkPolled(i));
+  }
+
+  function checkPolled(i) {
+    return function (err, data) {
+      assert.equal(err, null);
+      assert.deepEqual(data, [{ COLINT: i }]);
+
+      if (++polled === queryCount) {
+        testStillExecutingError();
+      }
+    };
+  }
+}
+
+//the diagnostics survive the attributes being reset after the error
+function testStillExecutingError() {
+  db.query('select * from async_execution_missing', function (err, data) {
+    assert.ok(err);
+    assert.ok(/async_execution_missing/.test(err.message));
+    assert.ok(err.state);
+
+    testStillExecutingCancel();
+  });
+}
+
+function testStillExecutingCancel() {
+  //polls long enough to still be executing when it is cancelled
+  db.conn._stillExecutingPolls = 100000;
+
+  var id = db.conn.query('select 1 as COLINT', function (err, result) {
+    assert.equal(err.code, 'ECANCELED');
+    result.closeSync();
+
+    db.conn._stillExecutingPolls = 0;
+
+    //the statement is usable again without async execution left on
+    db.query('select 2 as COLINT', function (err, data) {
+      assert.equal(err, null);
+      assert.deepEqual(data, [{ COLINT: 2 }]);
+
+      db.closeSync();
+      assert.equal(db.connected, false);
+    });
+  });
+
+  setTimeout(function () {
+    assert.equal(db.conn.cancelSync(id), true);
+  }, 50);
+}
@@ -0,0 +1,43 @@
+var common = require('./common')
+  , odbc = require('../')
+  , pool = new odbc.Pool({ maxSize: 1, maxWaiters: 1, acquireTimeout: 200 })
+  , connectionString = common.connectionString
+  , assert = require('assert');
+
+pool.open(connectionString, function (err, db) {
+  assert.equal(err, null);
+  assert.equal(db.connected, true);
+  assert.deepEqual(db.querySync('select 1 as COLINT'), [{ COLINT: 1 }]);
+
+  //the pool is full, so the second caller waits and the third is turned away
+  pool.open(connectionString, function (err) {
+    assert.equal(err.code, 'ETIMEDOUT');
+
+    //the connection stays connected when it is closed
+    db.close(function (err) {
+      assert.equal(err, null);
+      assert.equal(db.connected, false);
+
+      pool.open(connectionString, function (err, db2) {
+        assert.equal(err, null);
+        assert.deepEqual(db2.querySync('select 1 as COLINT'), [{ COLINT: 1 }]);
+        db2.closeSync();
+
+        var stats = pool.getStatsSync(connectionString);
+
+        //the same connection was handed out again instead of reconnecting
+        assert.equal(stats.created, 1);
+        assert.equal(stats.acquired, 2);
+        assert.equal(stats.timeouts, 1);
+        assert.equal(stats.rejected, 1);
+        assert.equal(stats.waiters, 0);
+
+        pool.close(function () {});
+      });
+    });
+  });
+
+  pool.open(connectionString, function (err) {
+    assert.equal(err.code, 'EPOOLFULL');
+  });
+});
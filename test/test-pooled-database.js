@@ -0,0 +1,62 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.PooledDatabase({ maxSize: 4 })
+  , assert = require('assert')
+  , queryCount = 8
+  , received = 0;
+
+db.open(common.connectionString, function (err) {
+  assert.equal(err, null);
+  assert.equal(db.connected, true);
+
+  //independent queries are spread over the pool
+  for (var i = 0; i < queryCount; i++) {
+    db.query('select ' + i + ' as COLINT', checkQuery(i));
+  }
+});
+
+function checkQuery(i) {
+  return function (err, data) {
+    assert.equal(err, null);
+    assert.deepEqual(data, [{ COLINT: i }]);
+
+    if (++received === queryCount) {
+      var stats = db.getStatsSync();
+
+      assert.ok(stats.created > 1);
+      assert.ok(stats.created <= 4);
+
+      testTransaction();
+    }
+  };
+}
+
+function testTransaction() {
+  db.beginTransaction(function (err) {
+    assert.equal(err, null);
+  });
+
+  //a temporary table is only visible to the connection that created it, so
+  //these only succeed on the connection the transaction began on
+  db.query('create temp table POOLED_TEMP (COLINT int)', function (err) {
+    assert.equal(err, null);
+  });
+
+  db.query('insert into POOLED_TEMP (COLINT) values (42)', function (err) {
+    assert.equal(err, null);
+  });
+
+  db.query('select COLINT from POOLED_TEMP', function (err, data) {
+    assert.equal(err, null);
+    assert.deepEqual(data, [{ COLINT: 42 }]);
+  });
+
+  db.rollbackTransaction(function (err) {
+    assert.equal(err, null);
+    assert.equal(db.transaction, null);
+
+    db.close(function () {
+      assert.equal(db.connected, false);
+    });
+  });
+}
@@ -0,0 +1,150 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , assert = require('assert');
+
+//counts long enough to still be running when it is cancelled
+var slowSql = 'with recursive c(x) as (select 1 union all select x + 1 from c where x < 100000000) select count(*) as COLINT from c';
+
+//stands in for an AbortSignal on versions of node without one
+function Signal() {
+  this.aborted = false;
+  this.listeners = [];
+}
+
+Signal.prototype.addEventListener = function (type, listener) {
+  this.listeners.push(listener);
+};
+
+Signal.prototype.removeEventListener = function (type, listener) {
+  this.listeners.splice(this.listeners.indexOf(listener), 1);
+};
+
+Signal.prototype.abort = function () {
+  this.aborted = true;
+  this.listeners.slice().forEach(function (listener) { listener(); });
+};
+
+db.openSync(common.connectionString);
+
+assert.equal(db.connected, true);
+
+testQueryId();
+
+function testQueryId() {
+  var slowId, otherId, received = 0;
+
+  //cancels only the query with the id
+  slowId = db.conn.query(slowSql, function (err, result) {
+    assert.equal(err.code, 'ECANCELED');
+    result.closeSync();
+    done();
+  });
+
+  otherId = db.conn.query('select 1 as COLINT', function (err, result) {
+    assert.equal(err, null);
+    result.closeSync();
+    done();
+  });
+
+  assert.notEqual(slowId, otherId);
+  assert.equal(db.conn.cancelSync(slowId), true);
+  assert.equal(db.conn.cancelSync(slowId), false);
+
+  function done() {
+    if (++received === 2) {
+      //nothing to cancel
+      assert.equal(db.conn.cancelSync(otherId), false);
+
+      testAborted();
+    }
+  }
+}
+
+function testAborted() {
+  var aborted = new Signal();
+  aborted.abort();
+
+  db.query({ sql: 'select 1 as COLINT', signal: aborted }, function (err, data) {
+    assert.equal(err.code, 'ECANCELED');
+    assert.deepEqual(data, []);
+
+    testAbort();
+  });
+}
+
+function testAbort() {
+  var signal = new Signal();
+
+  db.query({ sql: slowSql, signal: signal }, function (err) {
+    assert.equal(err.code, 'ECANCELED');
+    assert.equal(signal.listeners.length, 0);
+
+    //the connection is usable again
+    db.query('select 1 as COLINT', function (err, data) {
+      assert.equal(err, null);
+      assert.deepEqual(data, [{ COLINT: 1 }]);
+
+      testResult();
+    });
+  });
+
+  setTimeout(function () {
+    signal.abort();
+  }, 100);
+}
+
+function testResult() {
+  db.queryResult('select 1 as COLINT', function (err, result) {
+    assert.equal(err, null);
+
+    //nothing is fetching yet
+    assert.equal(result.cancelSync(), false);
+
+    result.fetchAll(function (err, data) {
+      //a cancel after the rows were read keeps them
+      if (err) {
+        assert.equal(err.code, 'ECANCELED');
+      }
+      else {
+        assert.deepEqual(data, [{ COLINT: 1 }]);
+      }
+
+      assert.equal(result.cancelSync(), false);
+
+      result.closeSync();
+
+      testStatement();
+    });
+
+    assert.equal(result.cancelSync(), true);
+    assert.equal(result.cancelSync(), false);
+  });
+}
+
+function testStatement() {
+  db.prepare('select 1 as COLINT', function (err, stmt) {
+    assert.equal(err, null);
+
+    stmt.queryTimeout = 30;
+    assert.equal(stmt.queryTimeout, 30);
+
+    //cancels only an execute that is running
+    assert.equal(stmt.cancelSync(), false);
+
+    stmt.execute(function (err, result) {
+      assert.equal(err, null);
+
+      result.fetchAll(function (err, data) {
+        assert.equal(err, null);
+        assert.deepEqual(data, [{ COLINT: 1 }]);
+
+        result.closeSync();
+        stmt.closeSync();
+
+        db.closeSync();
+        assert.equal(db.connected, false);
+      });
+    });
+  });
+}
@@ -0,0 +1,77 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database({ metadataCacheSize: 2 })
+  , assert = require('assert');
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+assert.equal(db.conn.metadataCacheSize, 2);
+
+db.querySync("create temp table metadata_cache (id integer, name text)");
+db.querySync("insert into metadata_cache values (1, 'one')");
+
+var sql = "select * from metadata_cache";
+
+assert.deepEqual(db.querySync(sql), [{ id: 1, name: 'one' }]);
+assert.deepEqual(db.querySync(sql), [{ id: 1, name: 'one' }]);
+
+var stats = db.getMetadataCacheStatsSync();
+assert.equal(stats.size, 1);
+assert.equal(stats.capacity, 2);
+assert.equal(stats.hits, 1);
+
+// A changed column count describes the result set again
+db.querySync("alter table metadata_cache add column value real");
+assert.deepEqual(db.querySync(sql), [{ id: 1, name: 'one', value: null }]);
+assert.equal(db.getMetadataCacheStatsSync().hits, 1);
+
+// So does a renamed column, with the same column count
+db.querySync("alter table metadata_cache rename column value to amount");
+assert.deepEqual(db.querySync(sql), [{ id: 1, name: 'one', amount: null }]);
+assert.equal(db.getMetadataCacheStatsSync().hits, 1);
+
+// Least recently used shapes are evicted
+db.querySync("select 1 as a");
+db.querySync("select 2 as b");
+assert.equal(db.getMetadataCacheStatsSync().size, 2);
+
+db.clearMetadataCacheSync();
+assert.equal(db.getMetadataCacheStatsSync().size, 0);
+
+var stmt = db.prepareSync("select id, name from metadata_cache where id = ?");
+assert.equal(stmt.metadataCacheSize, 2);
+
+stmt.bindSync([1]);
+var result = stmt.executeSync();
+assert.deepEqual(result.fetchAllSync(), [{ id: 1, name: 'one' }]);
+result.closeSync();
+
+var hits = db.getMetadataCacheStatsSync().hits;
+
+db.query(sql, function (err, data) {
+  assert.equal(err, null);
+  assert.deepEqual(data, [{ id: 1, name: 'one', amount: null }]);
+
+  db.query(sql, function (err, data) {
+    assert.equal(err, null);
+    assert.deepEqual(data, [{ id: 1, name: 'one', amount: null }]);
+    assert.equal(db.getMetadataCacheStatsSync().hits, hits + 1);
+
+    stmt.execute(function (err, result) {
+      assert.equal(err, null);
+
+      result.fetchAll(function (err, data) {
+        assert.equal(err, null);
+        assert.deepEqual(data, [{ id: 1, name: 'one' }]);
+        result.closeSync();
+
+        assert.equal(stmt.getMetadataCacheStatsSync().hits, 1);
+        stmt.closeSync();
+      });
+    });
+  });
+});
@@ -0,0 +1,65 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , assert = require('assert')
+  , hasBigInt = typeof BigInt === 'function';
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+
+db.querySync("create temp table numeric_test (COLBIGINT bigint, COLDECIMAL decimal(12, 2))");
+db.querySync("insert into numeric_test values (42, 1234.56), (9007199254740993, -0.05), (null, null)");
+
+var sql = "select COLBIGINT, COLDECIMAL from numeric_test order by rowid";
+
+function select(options) {
+  var result = db.queryResultSync(sql);
+  var rows = result.fetchAllSync(options);
+
+  result.closeSync();
+  assert.equal(rows.length, 3);
+  assert.equal(rows[2].COLBIGINT, null);
+  assert.equal(rows[2].COLDECIMAL, null);
+
+  return rows;
+}
+
+function scaled(decimal) {
+  return Number(decimal.value) / Math.pow(10, decimal.scale);
+}
+
+//existing behavior
+var rows = select({});
+assert.strictEqual(rows[0].COLBIGINT, '42');
+assert.strictEqual(rows[1].COLBIGINT, '9007199254740993');
+assert.strictEqual(Number(rows[0].COLDECIMAL), 1234.56);
+
+//numbers when safe
+rows = select({ bigintMode: odbc.BIGINT_NUMBER, decimalMode: odbc.DECIMAL_NUMBER });
+assert.strictEqual(rows[0].COLBIGINT, 42);
+assert.strictEqual(String(rows[1].COLBIGINT), '9007199254740993');
+assert.strictEqual(rows[0].COLDECIMAL, 1234.56);
+assert.strictEqual(rows[1].COLDECIMAL, -0.05);
+
+//BigInt and scaled decimals
+rows = select({ bigintMode: odbc.BIGINT_BIGINT, decimalMode: odbc.DECIMAL_SCALED });
+assert.strictEqual(typeof rows[0].COLBIGINT, hasBigInt ? 'bigint' : 'string');
+assert.strictEqual(String(rows[1].COLBIGINT), '9007199254740993');
+assert.strictEqual(scaled(rows[0].COLDECIMAL), 1234.56);
+assert.strictEqual(scaled(rows[1].COLDECIMAL), -0.05);
+
+//block cursor fetches bind the same types
+rows = select({ bigintMode: odbc.BIGINT_BIGINT, decimalMode: odbc.DECIMAL_SCALED, rowsetSize: 10 });
+assert.strictEqual(String(rows[1].COLBIGINT), '9007199254740993');
+assert.strictEqual(scaled(rows[0].COLDECIMAL), 1234.56);
+
+//options set on the result
+var result = db.queryResultSync(sql);
+result.bigintMode = odbc.BIGINT_NUMBER;
+assert.equal(result.bigintMode, odbc.BIGINT_NUMBER);
+assert.strictEqual(result.fetchSync().COLBIGINT, 42);
+result.closeSync();
@@ -0,0 +1,46 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , assert = require('assert');
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+
+db.querySync("create temp table binary_test (COLBLOB blob)");
+db.querySync("insert into binary_test values (x'00ff10'), (zeroblob(200)), (zeroblob(3000000)), (null)");
+
+var sql = "select COLBLOB from binary_test order by rowid";
+
+function check(rows) {
+  assert.equal(rows.length, 4);
+
+  //values are read into a single Buffer
+  assert.ok(Buffer.isBuffer(rows[0].COLBLOB));
+  assert.deepEqual(Array.from(rows[0].COLBLOB), [0x00, 0xff, 0x10]);
+  assert.equal(rows[1].COLBLOB.length, 200);
+  assert.ok(Buffer.isBuffer(rows[2].COLBLOB));
+  assert.equal(rows[2].COLBLOB.length, 3000000);
+  assert.equal(rows[3].COLBLOB, null);
+}
+
+var result = db.queryResultSync(sql);
+check(result.fetchAllSync());
+result.closeSync();
+
+//values longer than valueChunkSize are split
+result = db.queryResultSync(sql);
+var rows = result.fetchAllSync({ valueChunkSize: 1000000 });
+result.closeSync();
+
+assert.ok(Array.isArray(rows[2].COLBLOB));
+assert.equal(rows[2].COLBLOB.length, 3);
+assert.ok(Buffer.isBuffer(rows[1].COLBLOB));
+
+db.query(sql, function (err, rows) {
+  assert.equal(err, null);
+  check(rows);
+});
@@ -0,0 +1,61 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , assert = require('assert');
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+
+db.querySync("create temp table date_test (COLDATE date, COLTIMESTAMP timestamp, COLTIME time)");
+db.querySync("insert into date_test values ('2017-03-12', '2017-03-12 10:20:30.123', '10:20:30'), "
+  + "('1969-12-31', '1969-12-31 23:59:59.999', '23:59:59'), (null, null, null)");
+
+var sql = "select COLDATE, COLTIMESTAMP, COLTIME from date_test order by rowid";
+
+function select(options) {
+  var result = db.queryResultSync(sql);
+  var rows = result.fetchAllSync(options);
+
+  result.closeSync();
+  assert.equal(rows.length, 3);
+  assert.equal(rows[2].COLDATE, null);
+  assert.equal(rows[2].COLTIMESTAMP, null);
+  assert.equal(rows[2].COLTIME, null);
+
+  return rows;
+}
+
+//existing behavior
+var rows = select({});
+assert.strictEqual(typeof rows[0].COLDATE, 'string');
+
+//UTC dates
+rows = select({ dateMode: odbc.DATE_UTC });
+assert.ok(rows[0].COLDATE instanceof Date);
+assert.strictEqual(rows[0].COLDATE.getTime(), Date.UTC(2017, 2, 12));
+assert.strictEqual(rows[0].COLTIMESTAMP.getTime(), Date.UTC(2017, 2, 12, 10, 20, 30, 123));
+assert.strictEqual(rows[0].COLTIME.getTime(), Date.UTC(1970, 0, 1, 10, 20, 30));
+assert.strictEqual(rows[1].COLTIMESTAMP.getTime(), Date.UTC(1969, 11, 31, 23, 59, 59, 999));
+
+//local dates
+rows = select({ dateMode: odbc.DATE_LOCAL });
+assert.strictEqual(rows[0].COLTIMESTAMP.getTime(), new Date(2017, 2, 12, 10, 20, 30, 123).getTime());
+assert.strictEqual(rows[1].COLDATE.getTime(), new Date(1969, 11, 31).getTime());
+
+//block cursor fetches bind the same types
+rows = select({ dateMode: odbc.DATE_UTC, dateFraction: true, rowsetSize: 10 });
+assert.strictEqual(rows[0].COLTIMESTAMP.getTime(), Date.UTC(2017, 2, 12, 10, 20, 30, 123));
+assert.strictEqual(rows[0].COLTIMESTAMP.nanoseconds, 0);
+
+//columnar epoch values
+var result = db.queryResultSync(sql);
+var columns = result.fetchAllSync({ fetchMode: odbc.FETCH_COLUMNAR, dateMode: odbc.DATE_UTC });
+result.closeSync();
+
+assert.equal(columns[1].type, 'date');
+assert.ok(columns[1].values instanceof Float64Array);
+assert.strictEqual(columns[1].values[0], Date.UTC(2017, 2, 12, 10, 20, 30, 123));
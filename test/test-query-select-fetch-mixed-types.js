@@ -0,0 +1,66 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , assert = require('assert');
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+
+var longText = new Array(100001).join('x');
+
+var sql = "with recursive cnt(x) as (select 1 union all select x + 1 from cnt limit 20) "
+  + "select x as COLINT, "
+  + "case when x % 3 = 0 then null else 'row ' || x end as COLTEXT, "
+  + "case when x % 2 = 0 then null else x * 0.25 end as COLREAL, "
+  + "'é中文' as COLUNICODE, "
+  + "replace(hex(zeroblob(50000)), '0', 'x') as COLLONGTEXT "
+  + "from cnt";
+
+var result = db.queryResultSync(sql);
+var expected = result.fetchAllSync();
+result.closeSync();
+
+assert.equal(expected.length, 20);
+assert.equal(expected[2].COLTEXT, null);
+assert.equal(expected[1].COLREAL, null);
+assert.equal(expected[0].COLUNICODE, 'é中文');
+assert.equal(expected[19].COLLONGTEXT, longText);
+
+result = db.queryResultSync(sql);
+
+var rows = [];
+var row;
+
+while ((row = result.fetchSync())) {
+  rows.push(row);
+}
+
+result.closeSync();
+assert.deepEqual(rows, expected);
+
+db.queryResult(sql, function (err, result) {
+  assert.equal(err, null);
+
+  var rows = [];
+
+  result.fetch(function next(err, row) {
+    assert.equal(err, null);
+
+    if (row) {
+      rows.push(row);
+      return result.fetch(next);
+    }
+
+    result.closeSync();
+    assert.deepEqual(rows, expected);
+
+    db.query(sql, function (err, data) {
+      assert.equal(err, null);
+      assert.deepEqual(data, expected);
+    });
+  });
+});
@@ -0,0 +1,60 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , assert = require('assert');
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+
+db.querySync("create temp table columnar_test (COLINT integer, COLREAL real, COLTEXT varchar(20))");
+db.querySync("insert into columnar_test values (1, 0.5, 'one'), (null, 1.5, null), (3, null, 'three')");
+
+var sql = "select COLINT, COLREAL, COLTEXT from columnar_test order by rowid";
+
+function isNull(column, row) {
+  return (column.nulls[row >> 3] & (1 << (row & 7))) !== 0;
+}
+
+function textValue(column, row) {
+  return column.data.toString(column.encoding, column.offsets[row], column.offsets[row + 1]);
+}
+
+function check(columns) {
+  assert.equal(columns.length, 3);
+  assert.deepEqual(columns.map(function (c) { return c.name; }), ['COLINT', 'COLREAL', 'COLTEXT']);
+
+  assert.equal(columns[0].type, 'int32');
+  assert.ok(columns[0].values instanceof Int32Array);
+  assert.equal(columns[0].values.length, 3);
+  assert.equal(columns[0].values[0], 1);
+  assert.equal(columns[0].values[2], 3);
+  assert.deepEqual([0, 1, 2].map(isNull.bind(null, columns[0])), [false, true, false]);
+
+  assert.equal(columns[1].type, 'float64');
+  assert.ok(columns[1].values instanceof Float64Array);
+  assert.equal(columns[1].values[1], 1.5);
+  assert.deepEqual([0, 1, 2].map(isNull.bind(null, columns[1])), [false, false, true]);
+
+  assert.equal(columns[2].type, 'string');
+  assert.equal(columns[2].offsets.length, 4);
+  assert.equal(textValue(columns[2], 0), 'one');
+  assert.equal(isNull(columns[2], 1), true);
+  assert.equal(textValue(columns[2], 2), 'three');
+}
+
+var result = db.queryResultSync(sql);
+check(result.fetchAllSync({ fetchMode: odbc.FETCH_COLUMNAR, batchSize: 2 }));
+result.closeSync();
+
+result = db.queryResultSync(sql);
+assert.deepEqual(result.fetchAllSync({ fetchMode: odbc.FETCH_FLAT }), [1, 0.5, 'one', null, 1.5, null, 3, null, 'three']);
+result.closeSync();
+
+db.query({ sql: sql, fetchMode: odbc.FETCH_COLUMNAR, batchSize: 1 }, function (err, columns) {
+  assert.equal(err, null);
+  check(columns);
+});
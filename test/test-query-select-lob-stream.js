@@ -0,0 +1,107 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , assert = require('assert')
+  , Readable = require('stream').Readable;
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+
+db.querySync("create temp table lob_test (COLINT integer, COLTEXT text, COLBLOB blob)");
+db.querySync("insert into lob_test values (1, 'short', x'0102'), "
+  + "(2, replace(hex(zeroblob(500000)), '0', 'y'), zeroblob(3000000)), (3, null, null)");
+
+var options = { lobMode: odbc.LOB_STREAM, valueChunkSize: 65536 };
+
+function collect(stream, cb) {
+  var parts = [];
+
+  stream.on('data', function (part) {
+    parts.push(part);
+  });
+  stream.on('error', cb);
+  stream.on('end', function () {
+    cb(null, typeof parts[0] === 'string' ? parts.join('') : Buffer.concat(parts));
+  });
+}
+
+//only the last column is streamed
+db.queryResult("select COLINT, COLTEXT, COLBLOB from lob_test order by rowid", function (err, result) {
+  assert.equal(err, null);
+
+  result.fetch(options, function (err, row) {
+    assert.equal(err, null);
+    assert.equal(row.COLINT, 1);
+    assert.ok(row.COLBLOB instanceof Readable);
+    assert.ok(!(row.COLTEXT instanceof Readable));
+
+    collect(row.COLBLOB, function (err, data) {
+      assert.equal(err, null);
+      assert.deepEqual(Array.from(data), [1, 2]);
+
+      result.fetch(options, function (err, row) {
+        assert.equal(err, null);
+
+        //long values are read part by part as the stream is consumed
+        collect(row.COLBLOB, function (err, data) {
+          assert.equal(err, null);
+          assert.equal(data.length, 3000000);
+
+          result.fetch(options, function (err, row) {
+            assert.equal(err, null);
+            assert.equal(row.COLBLOB, null);
+
+            result.closeSync();
+            streamText();
+          });
+        });
+      });
+    });
+  });
+});
+
+function streamText() {
+  db.queryResult("select COLINT, COLTEXT from lob_test where COLINT = 2", function (err, result) {
+    assert.equal(err, null);
+
+    result.fetch(options, function (err, row) {
+      assert.equal(err, null);
+
+      collect(row.COLTEXT, function (err, text) {
+        assert.equal(err, null);
+        assert.equal(text, new Array(1000001).join('y'));
+
+        result.closeSync();
+        streamStale();
+      });
+    });
+  });
+}
+
+//a stream left unread fails once the result is fetched from again
+function streamStale() {
+  db.queryResult("select COLINT, COLBLOB from lob_test order by rowid", function (err, result) {
+    assert.equal(err, null);
+
+    result.fetch(options, function (err, first) {
+      assert.equal(err, null);
+
+      result.fetch(options, function (err, second) {
+        assert.equal(err, null);
+
+        result.fetch(options, function (err) {
+          assert.equal(err, null);
+
+          collect(second.COLBLOB, function (err) {
+            assert.ok(err);
+            result.closeSync();
+          });
+        });
+      });
+    });
+  });
+}
@@ -0,0 +1,59 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , assert = require('assert');
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+
+// Long enough to be fetched in parts, and long enough to be an external string
+var text = new Array(10001).join('abc中文');
+var largeText = new Array(1024 * 1024 + 1).join('xy');
+
+db.querySync("create temp table long_text (id integer, value text)");
+db.querySync("insert into long_text values (1, ?)", [text]);
+db.querySync("insert into long_text values (2, ?)", [largeText]);
+db.querySync("insert into long_text values (3, null)");
+
+var sql = "select id, value from long_text order by id";
+
+var result = db.queryResultSync(sql);
+var data = result.fetchAllSync();
+result.closeSync();
+
+assert.equal(data.length, 3);
+assert.equal(typeof data[0].value, 'string');
+assert.equal(data[0].value, text);
+assert.equal(data[1].value, largeText);
+assert.equal(data[2].value, null);
+
+result = db.queryResultSync(sql);
+
+var rows = [];
+var row;
+
+while ((row = result.fetchSync())) {
+  rows.push(row);
+}
+
+result.closeSync();
+assert.deepEqual(rows, data);
+
+db.query(sql, function (err, rows) {
+  assert.equal(err, null);
+  assert.deepEqual(rows, data);
+
+  db.queryResult(sql, function (err, result) {
+    assert.equal(err, null);
+
+    result.fetch(function (err, row) {
+      assert.equal(err, null);
+      assert.equal(row.value, text);
+      result.closeSync();
+    });
+  });
+});
@@ -0,0 +1,58 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = odbc({ rowsetSize : 16 })
+  , assert = require('assert');
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+
+var sql = "with recursive cnt(x) as (select 1 union all select x + 1 from cnt limit 100) "
+  + "select x as COLINT, 'row ' || x as COLTEXT, x * 0.5 as COLREAL, null as COLNULL from cnt";
+
+var result = db.queryResultSync({ sql: sql, rowsetSize: 1 });
+assert.equal(result.rowsetSize, 1);
+
+var expected = result.fetchAllSync();
+result.closeSync();
+
+assert.equal(expected.length, 100);
+assert.equal(expected[99].COLINT, 100);
+
+result = db.queryResultSync(sql);
+assert.equal(result.rowsetSize, 16);
+assert.deepEqual(result.fetchAllSync(), expected);
+result.closeSync();
+
+result = db.queryResultSync(sql);
+assert.deepEqual(result.fetchAllSync({ rowsetSize: 7 }), expected);
+result.closeSync();
+
+// Values longer than the declared length are read in full, with the rows after them
+var longText = new Array(101).join('x');
+
+db.querySync("create temp table rowset_declared (id integer, name varchar(4))");
+db.querySync("insert into rowset_declared values (1, 'one'), (2, '" + longText + "'), (3, 'three')");
+
+result = db.queryResultSync("select id, name from rowset_declared order by id");
+assert.equal(result.rowsetSize, 16);
+assert.deepEqual(result.fetchAllSync(), [
+  { id: 1, name: 'one' },
+  { id: 2, name: longText },
+  { id: 3, name: 'three' }
+]);
+result.closeSync();
+
+db.query({ sql: sql, rowsetSize: 7, fetchMode: odbc.FETCH_ARRAY }, function (err, data) {
+  assert.equal(err, null);
+  assert.equal(data.length, 100);
+  assert.deepEqual(data[0], [expected[0].COLINT, expected[0].COLTEXT, expected[0].COLREAL, null]);
+});
+
+db.query(sql, function (err, data) {
+  assert.equal(err, null);
+  assert.deepEqual(data, expected);
+});
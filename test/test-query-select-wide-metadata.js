@@ -0,0 +1,46 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , assert = require('assert');
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+
+// Column names longer than the initial name buffer are read again in full
+var longName = 'COL_' + new Array(201).join('N');
+var columnCount = 300;
+var names = [];
+var select = [];
+
+for (var i = 0; i < columnCount; i++) {
+  names.push('COL' + i);
+  select.push(i + ' as COL' + i);
+}
+
+names.push(longName);
+select.push("'text' as " + longName);
+
+var sql = 'select ' + select.join(', ');
+
+db.queryResult(sql, function (err, result) {
+  assert.equal(err, null);
+
+  var metadata = result.getColumnMetadataSync();
+
+  assert.equal(metadata.length, names.length);
+  assert.deepEqual(metadata.map(function (column) { return column.COLUMN_NAME; }), names);
+  assert.equal(metadata[columnCount].INDEX, columnCount + 1);
+
+  result.fetch(function (err, row) {
+    assert.equal(err, null);
+    assert.deepEqual(Object.keys(row), names);
+    assert.equal(row.COL299, 299);
+    assert.equal(row[longName], 'text');
+
+    result.closeSync();
+  });
+});
@@ -0,0 +1,69 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database({ statementCacheSize: 2 })
+  , assert = require('assert');
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+assert.equal(db.conn.statementCacheSize, 2);
+
+db.querySync("create temp table statement_cache (id integer, name text)");
+db.querySync("insert into statement_cache values (1, 'one'), (2, 'two')");
+db.clearStatementCacheSync();
+
+var sql = "select name from statement_cache where id = ?";
+var start = db.getStatementCacheStatsSync();
+
+assert.equal(start.size, 0);
+assert.equal(start.capacity, 2);
+
+// Prepared once, then only bound and executed
+assert.deepEqual(db.querySync(sql, [1]), [{ name: 'one' }]);
+assert.deepEqual(db.querySync(sql, [2]), [{ name: 'two' }]);
+assert.deepEqual(db.querySync(sql, [1]), [{ name: 'one' }]);
+
+var stats = db.getStatementCacheStatsSync();
+assert.equal(stats.size, 1);
+assert.equal(stats.hits, start.hits + 2);
+assert.equal(stats.misses, start.misses + 1);
+
+// A statement in use by an open result is not shared
+var result = db.queryResultSync(sql, [2]);
+assert.deepEqual(db.querySync(sql, [1]), [{ name: 'one' }]);
+assert.deepEqual(result.fetchAllSync(), [{ name: 'two' }]);
+result.closeSync();
+assert.equal(db.getStatementCacheStatsSync().size, 1);
+
+// Statements that fail are not cached
+assert.throws(function () {
+  db.querySync("select * from missing_table");
+});
+assert.equal(db.getStatementCacheStatsSync().size, 1);
+
+// Least recently used statements are evicted
+db.querySync("select 1 as a");
+db.querySync("select 2 as b");
+
+stats = db.getStatementCacheStatsSync();
+assert.equal(stats.size, 2);
+assert.equal(stats.evictions, start.evictions + 1);
+
+db.query(sql, [2], function (err, data) {
+  assert.equal(err, null);
+  assert.deepEqual(data, [{ name: 'two' }]);
+
+  db.query(sql, [1], function (err, data) {
+    assert.equal(err, null);
+    assert.deepEqual(data, [{ name: 'one' }]);
+
+    var hits = db.getStatementCacheStatsSync().hits;
+    assert.equal(hits, stats.hits + 1);
+
+    db.clearStatementCacheSync();
+    assert.equal(db.getStatementCacheStatsSync().size, 0);
+  });
+});
@@ -0,0 +1,62 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database({ statementFreeListSize: 2 })
+  , assert = require('assert');
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+assert.equal(db.conn.statementFreeListSize, 2);
+
+var start = db.getStatementCacheStatsSync();
+
+assert.equal(start.freeListSize, 2);
+
+// Handles are reset and reused by the next query
+assert.deepEqual(db.querySync("select ? as a", [1]), [{ a: 1 }]);
+assert.deepEqual(db.querySync("select ? + ? as b", [1, 2]), [{ b: 3 }]);
+assert.deepEqual(db.querySync("select 'c' as c"), [{ c: 'c' }]);
+
+var stats = db.getStatementCacheStatsSync();
+assert.equal(stats.freeHandles, 1);
+assert.equal(stats.recycled, start.recycled + 2);
+
+// Only freeListSize idle handles are kept
+var results = [
+  db.queryResultSync("select 1 as a"),
+  db.queryResultSync("select 2 as a"),
+  db.queryResultSync("select 3 as a")
+];
+
+results.forEach(function (result, i) {
+  assert.deepEqual(result.fetchAllSync(), [{ a: i + 1 }]);
+  result.closeSync();
+});
+
+assert.equal(db.getStatementCacheStatsSync().freeHandles, 2);
+
+// Statements recycle their handles too
+var stmt = db.prepareSync("select ? as d");
+stmt.bindSync(['d']);
+
+var result = stmt.executeSync();
+assert.deepEqual(result.fetchAllSync(), [{ d: 'd' }]);
+result.closeSync();
+
+assert.equal(db.getStatementCacheStatsSync().freeHandles, 1);
+stmt.closeSync();
+assert.equal(db.getStatementCacheStatsSync().freeHandles, 2);
+
+db.tables(null, null, null, 'TABLE', function (err, data) {
+  assert.equal(err, null);
+  assert.ok(Array.isArray(data));
+
+  stats = db.getStatementCacheStatsSync();
+  assert.equal(stats.freeHandles, 2);
+
+  db.conn.statementFreeListSize = 0;
+  assert.equal(db.getStatementCacheStatsSync().freeHandles, 0);
+});
@@ -0,0 +1,48 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , assert = require('assert');
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+
+var sql = "with recursive cnt(x) as (select 1 union all select x + 1 from cnt limit 25) "
+  + "select x as COLINT, 'row ' || x as COLTEXT from cnt";
+
+var result = db.queryResultSync(sql);
+var expected = result.fetchAllSync({ batchSize: 3 });
+result.closeSync();
+
+assert.equal(expected.length, 25);
+
+result = db.queryResultSync(sql);
+assert.deepEqual(result.fetchManySync(10), expected.slice(0, 10));
+assert.deepEqual(result.fetchManySync(10, { batchSize: 4 }), expected.slice(10, 20));
+assert.deepEqual(result.fetchManySync(10), expected.slice(20));
+assert.deepEqual(result.fetchManySync(10), []);
+result.closeSync();
+
+db.queryResult(sql, function (err, result) {
+  assert.equal(err, null);
+
+  result.fetchMany(10, { batchSize: 3 }, function (err, data) {
+    assert.equal(err, null);
+    assert.deepEqual(data, expected.slice(0, 10));
+
+    result.fetchMany(100, { maxBatchBytes: 1 }, function (err, data) {
+      assert.equal(err, null);
+      assert.deepEqual(data, expected.slice(10));
+
+      result.closeSync();
+
+      db.query({ sql: sql, batchSize: 7 }, function (err, data) {
+        assert.equal(err, null);
+        assert.deepEqual(data, expected);
+      });
+    });
+  });
+});
@@ -0,0 +1,76 @@
+var common = require('./common')
+  , odbc = require('../')
+  , db = new odbc.Database()
+  , assert = require('assert');
+
+process.on('exit', () => {
+  if (db.connected) db.closeSync();
+});
+
+db.openSync(common.connectionString);
+assert.equal(db.connected, true);
+
+var sql = "with recursive cnt(x) as (select 1 union all select x + 1 from cnt limit 100) "
+  + "select x as COLINT, 'row ' || x as COLTEXT from cnt";
+
+var result = db.queryResultSync(sql);
+var expected = result.fetchAllSync();
+result.closeSync();
+
+assert.equal(expected.length, 100);
+
+result = db.queryResultSync(sql);
+
+//only fetch modes with one element per row can be streamed
+assert.throws(function () {
+  result.stream({ fetchMode: odbc.FETCH_COLUMNAR });
+}, TypeError);
+
+var rows = [];
+var stream = result.stream({ batchSize: 7, highWaterMark: 3 });
+
+stream.on('data', function (row) {
+  rows.push(row);
+
+  //no rows are fetched while the stream is paused
+  if (rows.length === 50) {
+    stream.pause();
+
+    setTimeout(function () {
+      assert.ok(stream._readableState.length <= 7);
+      stream.resume();
+    }, 50);
+  }
+});
+
+stream.on('error', function (err) {
+  assert.ifError(err);
+});
+
+stream.on('end', function () {
+  result.closeSync();
+  assert.deepEqual(rows, expected);
+
+  if (typeof Symbol !== 'function' || !Symbol.asyncIterator || !stream[Symbol.asyncIterator]) {
+    return;
+  }
+
+  var iterated = [];
+  var iterResult = db.queryResultSync(sql);
+  var iterator = iterResult[Symbol.asyncIterator]();
+
+  (function next() {
+    iterator.next().then(function (item) {
+      if (item.done) {
+        iterResult.closeSync();
+        assert.deepEqual(iterated, expected);
+        return;
+      }
+
+      iterated.push(item.value);
+      next();
+    }, function (err) {
+      assert.ifError(err);
+    });
+  })();
+});